@@ -46,6 +46,11 @@ void assetsys_destroy( assetsys_t* sys );
 assetsys_error_t assetsys_mount( assetsys_t* sys, char const* path, const char *zip_mem, size_t zip_mem_size, char const* mount_as );
 assetsys_error_t assetsys_dismount( assetsys_t* sys, char const* path, char const* mounted_as );
 
+// Add or remove a single file in a mounted directory without rescanning it. file_path is the mounted path, like
+// "/data/levels/level-1.level". Removing a file invalidates assetsys_file_t handles from the same mount.
+assetsys_error_t assetsys_mount_add_file( assetsys_t* sys, char const* path, char const* mounted_as, char const* file_path );
+assetsys_error_t assetsys_mount_remove_file( assetsys_t* sys, char const* path, char const* mounted_as, char const* file_path );
+
 typedef struct assetsys_file_t { ASSETSYS_U64 mount; ASSETSYS_U64 path; int index; } assetsys_file_t;
 
 assetsys_error_t assetsys_file( assetsys_t* sys, char const* path, assetsys_file_t* file );
@@ -6194,6 +6199,139 @@ int assetsys_file_size( assetsys_t* sys, assetsys_file_t file )
     }
 
 
+static int assetsys_internal_find_dir_mount( assetsys_t* sys, char const* path, char const* mounted_as )
+    {
+    ASSETSYS_U64 path_handle = strpool_inject( &sys->strpool, path, (int) strlen( path ) );
+    ASSETSYS_U64 mount_handle = strpool_inject( &sys->strpool, mounted_as, (int) strlen( mounted_as ) );
+    int mount_index = assetsys_internal_find_mount_index( sys, mount_handle, path_handle );
+    strpool_discard( &sys->strpool, mount_handle );
+    strpool_discard( &sys->strpool, path_handle );
+
+    if( mount_index < 0 || sys->mounts[ mount_index ].type != ASSETSYS_INTERNAL_MOUNT_TYPE_DIR ) return -1;
+    return mount_index;
+    }
+
+
+static int assetsys_internal_find_mount_file( assetsys_t* sys, struct assetsys_internal_mount_t* const mount, 
+    char const* const file_path )
+    {
+    ASSETSYS_U64 handle = strpool_inject( &sys->strpool, file_path, (int) strlen( file_path ) );
+    for( int i = 0; i < mount->files_count; ++i )
+        {
+        if( sys->collated[ mount->files[ i ].collated_index ].path == handle ) return i;
+        }
+
+    strpool_discard( &sys->strpool, handle );
+    return -1;
+    }
+
+
+static int assetsys_internal_add_mount_dir( assetsys_t* sys, struct assetsys_internal_mount_t* const mount, 
+    char const* const dir_path )
+    {
+    ASSETSYS_U64 handle = strpool_inject( &sys->strpool, dir_path, (int) strlen( dir_path ) );
+    for( int i = 0; i < mount->dirs_count; ++i )
+        {
+        if( sys->collated[ mount->dirs[ i ].collated_index ].path == handle ) return mount->dirs[ i ].collated_index;
+        }
+    strpool_discard( &sys->strpool, handle );
+
+    // The mount root is always in dirs, so this stops there at the latest
+    char parent_path[ 260 ];
+    strcpy( parent_path, assetsys_internal_dirname( dir_path ) );
+    int parent_len = (int) strlen( parent_path );
+    if( parent_len <= mount->mount_len ) return -1;
+    parent_path[ parent_len - 1 ] = '\0';
+    int parent = assetsys_internal_add_mount_dir( sys, mount, parent_path );
+
+    if( mount->dirs_count >= mount->dirs_capacity )
+        {
+        mount->dirs_capacity *= 2;
+        struct assetsys_internal_folder_t* new_dirs = (struct assetsys_internal_folder_t*) ASSETSYS_MALLOC( 
+            sys->memctx, sizeof( *(mount->dirs) ) * mount->dirs_capacity );
+        memcpy( new_dirs, mount->dirs, sizeof( *(mount->dirs) ) * mount->dirs_count );
+        ASSETSYS_FREE( sys->memctx, mount->dirs );
+        mount->dirs = new_dirs;
+        }
+    struct assetsys_internal_folder_t* as_dir = &mount->dirs[ mount->dirs_count++ ];
+    as_dir->collated_index = assetsys_internal_register_collated( sys, dir_path, 0 );
+    sys->collated[ as_dir->collated_index ].parent = parent;
+    return as_dir->collated_index;
+    }
+
+
+assetsys_error_t assetsys_mount_add_file( assetsys_t* sys, char const* path, char const* mounted_as, char const* file_path )
+    {
+    if( !path || !file_path ) return ASSETSYS_ERROR_INVALID_PARAMETER;
+    if( !mounted_as ) return ASSETSYS_ERROR_INVALID_MOUNT;
+
+    int mount_index = assetsys_internal_find_dir_mount( sys, path, mounted_as );
+    if( mount_index < 0 ) return ASSETSYS_ERROR_INVALID_MOUNT;
+    struct assetsys_internal_mount_t* mount = &sys->mounts[ mount_index ];
+    if( strncmp( file_path, mounted_as, (size_t) mount->mount_len ) != 0 || file_path[ mount->mount_len ] != '/' ) 
+        return ASSETSYS_ERROR_INVALID_PATH;
+    if( strlen( file_path ) >= sizeof( sys->temp ) ) return ASSETSYS_ERROR_INVALID_PATH;
+
+    strcpy( sys->temp, assetsys_internal_get_string( sys, mount->path ) );
+    strcat( sys->temp, *sys->temp == '\0' ? "" : "/" );
+    strcat( sys->temp, file_path + mount->mount_len + 1 );
+    struct stat s;
+    if( stat( sys->temp, &s ) != 0 || !( s.st_mode & S_IFREG ) ) return ASSETSYS_ERROR_FILE_NOT_FOUND;
+
+    int file_index = assetsys_internal_find_mount_file( sys, mount, file_path );
+    if( file_index >= 0 )
+        {
+        mount->files[ file_index ].size = (int) s.st_size;
+        return ASSETSYS_SUCCESS;
+        }
+
+    char dir_path[ 260 ];
+    strcpy( dir_path, assetsys_internal_dirname( file_path ) );
+    dir_path[ strlen( dir_path ) - 1 ] = '\0';
+    int parent = assetsys_internal_add_mount_dir( sys, mount, dir_path );
+
+    if( mount->files_count >= mount->files_capacity )
+        {
+        mount->files_capacity *= 2;
+        struct assetsys_internal_file_t* new_files = (struct assetsys_internal_file_t*) ASSETSYS_MALLOC( 
+            sys->memctx, sizeof( *(mount->files) ) * mount->files_capacity );
+        memcpy( new_files, mount->files, sizeof( *(mount->files) ) * mount->files_count );
+        ASSETSYS_FREE( sys->memctx, mount->files );
+        mount->files = new_files;
+        }
+
+    struct assetsys_internal_file_t* file = &mount->files[ mount->files_count++ ];
+    file->size = (int) s.st_size;
+    file->zip_index = -1;
+    file->collated_index = assetsys_internal_register_collated( sys, file_path, 1 );
+    sys->collated[ file->collated_index ].parent = parent;
+    return ASSETSYS_SUCCESS;
+    }
+
+
+assetsys_error_t assetsys_mount_remove_file( assetsys_t* sys, char const* path, char const* mounted_as, char const* file_path )
+    {
+    if( !path || !file_path ) return ASSETSYS_ERROR_INVALID_PARAMETER;
+    if( !mounted_as ) return ASSETSYS_ERROR_INVALID_MOUNT;
+
+    int mount_index = assetsys_internal_find_dir_mount( sys, path, mounted_as );
+    if( mount_index < 0 ) return ASSETSYS_ERROR_INVALID_MOUNT;
+    struct assetsys_internal_mount_t* mount = &sys->mounts[ mount_index ];
+
+    int file_index = assetsys_internal_find_mount_file( sys, mount, file_path );
+    if( file_index < 0 ) return ASSETSYS_ERROR_FILE_NOT_FOUND;
+
+    int collated_index = mount->files[ file_index ].collated_index;
+    assetsys_internal_remove_collated( sys, collated_index );
+    if( sys->collated[ collated_index ].ref_count == 0 ) sys->collated[ collated_index ].parent = -1;
+
+    int count = mount->files_count - file_index - 1;
+    if( count > 0 ) memmove( &mount->files[ file_index ], &mount->files[ file_index + 1 ], sizeof( *mount->files ) * count );
+    --mount->files_count;
+    return ASSETSYS_SUCCESS;
+    }
+
+
 static int assetsys_internal_find_collated( assetsys_t* sys, char const* const path )
     {
     ASSETSYS_U64 handle = strpool_inject( &sys->strpool, path, (int) strlen( path ) );
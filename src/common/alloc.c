@@ -16,6 +16,7 @@ typedef struct _golf_alloc_info {
 
 static golf_mutex_t _alloc_lock;
 static _golf_alloc_info_t *head;
+static size_t _total_size, _peak_size;
 
 void golf_alloc_init(void) {
     golf_mutex_init(&_alloc_lock);
@@ -35,6 +36,10 @@ void *golf_alloc_tracked(size_t size, const char *category) {
     mem->next = head->next;
     mem->next->prev = mem;
     head->next = mem;
+    _total_size += size;
+    if (_total_size > _peak_size) {
+        _peak_size = _total_size;
+    }
     golf_mutex_unlock(&_alloc_lock);
     return mem + 1;
 }
@@ -72,18 +77,21 @@ void golf_free_tracked(void *mem) {
     _golf_alloc_info_t *info = (_golf_alloc_info_t*)mem - 1;
     info->prev->next = info->next;
     info->next->prev = info->prev;
+    _total_size -= info->size;
     free(info);
     golf_mutex_unlock(&_alloc_lock);
 }
 
-void golf_alloc_get_debug_info(size_t *total_size) {
+void golf_alloc_get_debug_info(size_t *total_size, size_t *peak_size) {
     golf_mutex_lock(&_alloc_lock);
-    *total_size = 0;
-    _golf_alloc_info_t *info = head;
-    while (info->next != head) {
-        info = info->next;
-        *total_size += info->size;
-    }
+    *total_size = _total_size;
+    *peak_size = _peak_size;
+    golf_mutex_unlock(&_alloc_lock);
+}
+
+void golf_alloc_reset_peak(void) {
+    golf_mutex_lock(&_alloc_lock);
+    _peak_size = _total_size;
     golf_mutex_unlock(&_alloc_lock);
 }
 
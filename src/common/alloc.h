@@ -13,7 +13,9 @@ void golf_alloc_init(void);
 void *golf_alloc_tracked(size_t size, const char *category);
 void *golf_realloc_tracked(void *mem, size_t size, const char *category);
 void golf_free_tracked(void *mem);
-void golf_alloc_get_debug_info(size_t *total_size);
+// peak_size is the most that was allocated at once since init or the last golf_alloc_reset_peak
+void golf_alloc_get_debug_info(size_t *total_size, size_t *peak_size);
+void golf_alloc_reset_peak(void);
 void golf_debug_print_allocations(void);
 
 #endif
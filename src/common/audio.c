@@ -3,6 +3,7 @@
 #include "3rd_party/stb/stb_vorbis.h"
 #include "sokol/sokol_audio.h"
 
+#include "common/common.h"
 #include "common/data.h"
 #include "common/map.h"
 
@@ -19,12 +20,14 @@ typedef map_t(_sound_t) _map_sound_t;
 static _map_sound_t _sounds;
 
 void golf_audio_init(void) {
+#if !GOLF_HEADLESS
     saudio_setup(&(saudio_desc){
             .sample_rate = 44100,
             .buffer_frames = 1024,
             .packet_frames = 64,
             .num_packets = 32, 
             });
+#endif
 
     golf_data_load("data/audio/confirmation_002.ogg", false);
     golf_data_load("data/audio/drop_001.ogg", false);
@@ -75,6 +78,10 @@ void golf_audio_stop_sound(const char *name, float t) {
 }
 
 void golf_audio_update(float dt) {
+#if GOLF_HEADLESS
+    // There's no device to push samples to
+    GOLF_UNUSED(dt);
+#else
     int num_samples = saudio_expect();
     if (num_samples <= 0) {
         return;
@@ -127,4 +134,5 @@ void golf_audio_update(float dt) {
     saudio_push(buffer, num_samples);
     golf_free(buffer2);
     golf_free(buffer);
+#endif
 }
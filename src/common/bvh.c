@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <float.h>
 
+#include "common/common.h"
 #include "common/log.h"
 
 static void _update_aabb(golf_bvh_aabb_t *aabb, vec3 p) {
@@ -14,31 +15,42 @@ static void _update_aabb(golf_bvh_aabb_t *aabb, vec3 p) {
     if (p.z > aabb->max.z) aabb->max.z = p.z;
 }
 
-golf_bvh_node_info_t golf_bvh_node_info(golf_bvh_t *bvh, int idx, golf_level_t *level, golf_entity_t *entity, float t) {
-    golf_model_t *model = golf_entity_get_model(entity);
+static uint32_t _fnv_hash(uint32_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static golf_transform_t _get_moved_transform(golf_level_t *level, golf_entity_t *entity, float t) {
     golf_transform_t transform = golf_entity_get_world_transform(level, entity);
     golf_movement_t *movement = golf_entity_get_movement(entity);
+    if (movement) {
+        transform = golf_transform_apply_movement(transform, *movement, t);
+    }
+    return transform;
+}
 
+static golf_bvh_node_info_t _golf_bvh_node_info(golf_bvh_t *bvh, int idx, golf_level_t *level, golf_entity_t *entity, golf_model_t *model, float t, mat4 model_mat) {
     golf_bvh_node_info_t info;
     info.idx = idx;
     info.face_start = bvh->faces.length;
     info.face_count = model->positions.length / 3;
     info.pos = V3(0, 0, 0);
     info.aabb.min = V3(FLT_MAX, FLT_MAX, FLT_MAX);
-    info.aabb.max = V3(FLT_MIN, FLT_MIN, FLT_MIN);
-
-    golf_transform_t moved_transform = transform;
-    if (movement) {
-        moved_transform = golf_transform_apply_movement(moved_transform, *movement, t);
-    }
-    mat4 model_mat = golf_transform_get_model_mat(moved_transform);
+    info.aabb.max = V3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
 
     for (int i = 0; i < model->groups.length; i++) {
         golf_model_group_t group = model->groups.data[i];
 
+        // Faces without a material get the fallback material's values, which are all 0
         golf_material_t material;
         if (!golf_level_get_material(level, group.material_name, &material)) {
-            material = golf_material_texture("", 0, 0, 0, "data/textures/fallback.png");
+            material.restitution = 0;
+            material.friction = 0;
+            material.vel_scale = 0;
         }
 
         for (int j = 0; j < group.vertex_count; j += 3) {
@@ -52,6 +64,7 @@ golf_bvh_node_info_t golf_bvh_node_info(golf_bvh_t *bvh, int idx, golf_level_t *
             info.pos = vec3_add(info.pos, c);
 
             golf_bvh_face_t face;
+            face.idx = idx;
             face.a = a;
             face.b = b;
             face.c = c;
@@ -80,6 +93,11 @@ golf_bvh_node_info_t golf_bvh_node_info(golf_bvh_t *bvh, int idx, golf_level_t *
     return info;
 }
 
+golf_bvh_node_info_t golf_bvh_node_info(golf_bvh_t *bvh, int idx, golf_level_t *level, golf_entity_t *entity, float t) {
+    mat4 model_mat = golf_transform_get_model_mat(_get_moved_transform(level, entity, t));
+    return _golf_bvh_node_info(bvh, idx, level, entity, golf_entity_get_model(entity), t, model_mat);
+}
+
 static golf_bvh_aabb_t _aabb_combine(golf_bvh_aabb_t a, golf_bvh_aabb_t b) {
     golf_bvh_aabb_t c;
     c.min = V3(fminf(a.min.x, b.min.x), fminf(a.min.y, b.min.y), fminf(a.min.z, b.min.z));
@@ -87,38 +105,6 @@ static golf_bvh_aabb_t _aabb_combine(golf_bvh_aabb_t a, golf_bvh_aabb_t b) {
     return c;
 }
 
-static int _alloc_node(golf_bvh_t *bvh) {
-    golf_bvh_node_t node;
-    memset(&node, 0, sizeof(node));
-    vec_push(&bvh->nodes, node);
-    return bvh->nodes.length - 1;
-}
-
-static golf_bvh_node_t *_get_node(golf_bvh_t *bvh, int idx) {
-    return &bvh->nodes.data[idx];
-}
-
-static int _alloc_leaf_node(golf_bvh_t *bvh, golf_bvh_node_info_t info) {
-    int idx = _alloc_node(bvh);
-    golf_bvh_node_t *node = _get_node(bvh, idx);
-    node->is_leaf = true;
-    node->leaf_node_info = info;
-    node->aabb = info.aabb;
-    node->left = -1;
-    node->right = -1;
-    return idx;
-}
-
-static int _alloc_inner_node(golf_bvh_t *bvh, int left, int right) {
-    int idx = _alloc_node(bvh);
-    golf_bvh_node_t *node = _get_node(bvh, idx);
-    node->is_leaf = false;
-    node->aabb = _aabb_combine(_get_node(bvh, left)->aabb, _get_node(bvh, right)->aabb);
-    node->left = left;
-    node->right = right;
-    return idx;
-}
-
 golf_ball_contact_t golf_ball_contact(vec3 a, vec3 b, vec3 c, vec3 vel, vec3 bp, float br, vec3 cp, float dist, float restitution, float friction, float vel_scale, triangle_contact_type_t type, bool is_water, vec3 water_dir, bool is_out_of_bounds) {
     golf_ball_contact_t contact;
     contact.is_water = is_water;
@@ -154,190 +140,1194 @@ golf_ball_contact_t golf_ball_contact(vec3 a, vec3 b, vec3 c, vec3 vel, vec3 bp,
 
 void golf_bvh_init(golf_bvh_t *bvh) {
     vec_init(&bvh->faces, "bvh");
+    vec_init(&bvh->ax, "bvh");
+    vec_init(&bvh->ay, "bvh");
+    vec_init(&bvh->az, "bvh");
+    vec_init(&bvh->bx, "bvh");
+    vec_init(&bvh->by, "bvh");
+    vec_init(&bvh->bz, "bvh");
+    vec_init(&bvh->cx, "bvh");
+    vec_init(&bvh->cy, "bvh");
+    vec_init(&bvh->cz, "bvh");
+    vec_init(&bvh->face_infos, "bvh");
+    vec_init(&bvh->owners, "bvh");
     vec_init(&bvh->node_infos, "bvh");
     vec_init(&bvh->nodes, "bvh");
     bvh->parent = -1;
 }
 
-static vec3 _cmp_axis;
+void golf_bvh_deinit(golf_bvh_t *bvh) {
+    vec_deinit(&bvh->faces);
+    vec_deinit(&bvh->ax);
+    vec_deinit(&bvh->ay);
+    vec_deinit(&bvh->az);
+    vec_deinit(&bvh->bx);
+    vec_deinit(&bvh->by);
+    vec_deinit(&bvh->bz);
+    vec_deinit(&bvh->cx);
+    vec_deinit(&bvh->cy);
+    vec_deinit(&bvh->cz);
+    vec_deinit(&bvh->face_infos);
+    vec_deinit(&bvh->owners);
+    vec_deinit(&bvh->node_infos);
+    vec_deinit(&bvh->nodes);
+}
 
-static int _bvh_node_cmp(const void *a, const void *b) {
-    golf_bvh_node_info_t *node_a = (golf_bvh_node_info_t*)a;
-    golf_bvh_node_info_t *node_b = (golf_bvh_node_info_t*)b;
-    float dot_a = vec3_dot(_cmp_axis, node_a->pos);
-    float dot_b = vec3_dot(_cmp_axis, node_b->pos);
-    if (dot_a > dot_b) {
-        return 1;
-    }
-    else if (dot_a == dot_b) {
+golf_bvh_face_t golf_bvh_get_face(golf_bvh_t *bvh, int face_idx) {
+    golf_bvh_face_info_t *info = &bvh->face_infos.data[face_idx];
+    golf_bvh_owner_t *owner = &bvh->owners.data[info->owner];
+
+    golf_bvh_face_t face;
+    face.idx = owner->idx;
+    face.t = owner->t;
+    face.level = owner->level;
+    face.entity = owner->entity;
+    face.a = V3(bvh->ax.data[face_idx], bvh->ay.data[face_idx], bvh->az.data[face_idx]);
+    face.b = V3(bvh->bx.data[face_idx], bvh->by.data[face_idx], bvh->bz.data[face_idx]);
+    face.c = V3(bvh->cx.data[face_idx], bvh->cy.data[face_idx], bvh->cz.data[face_idx]);
+    face.water_dir = info->water_dir;
+    face.restitution = info->restitution;
+    face.friction = info->friction;
+    face.vel_scale = info->vel_scale;
+    return face;
+}
+
+static void _push_face(golf_bvh_t *bvh, golf_bvh_face_t face, int owner) {
+    vec_push(&bvh->ax, face.a.x);
+    vec_push(&bvh->ay, face.a.y);
+    vec_push(&bvh->az, face.a.z);
+    vec_push(&bvh->bx, face.b.x);
+    vec_push(&bvh->by, face.b.y);
+    vec_push(&bvh->bz, face.b.z);
+    vec_push(&bvh->cx, face.c.x);
+    vec_push(&bvh->cy, face.c.y);
+    vec_push(&bvh->cz, face.c.z);
+
+    golf_bvh_face_info_t info;
+    info.water_dir = face.water_dir;
+    info.restitution = face.restitution;
+    info.friction = face.friction;
+    info.vel_scale = face.vel_scale;
+    info.owner = owner;
+    vec_push(&bvh->face_infos, info);
+}
+
+static void _clear_faces(golf_bvh_t *bvh) {
+    bvh->ax.length = 0;
+    bvh->ay.length = 0;
+    bvh->az.length = 0;
+    bvh->bx.length = 0;
+    bvh->by.length = 0;
+    bvh->bz.length = 0;
+    bvh->cx.length = 0;
+    bvh->cy.length = 0;
+    bvh->cz.length = 0;
+    bvh->face_infos.length = 0;
+    bvh->owners.length = 0;
+}
+
+static void _reserve_faces(golf_bvh_t *bvh, int n) {
+    vec_reserve(&bvh->ax, n);
+    vec_reserve(&bvh->ay, n);
+    vec_reserve(&bvh->az, n);
+    vec_reserve(&bvh->bx, n);
+    vec_reserve(&bvh->by, n);
+    vec_reserve(&bvh->bz, n);
+    vec_reserve(&bvh->cx, n);
+    vec_reserve(&bvh->cy, n);
+    vec_reserve(&bvh->cz, n);
+    vec_reserve(&bvh->face_infos, n);
+}
+
+// Builds nodes over a set of primitives, which are faces for a golf_bvh_t and
+// instances for a golf_tlas_t. Leaves index into prim_idxs.
+typedef struct _golf_bvh_builder {
+    vec_golf_bvh_node_t *nodes;
+    int *prim_idxs;
+    golf_bvh_aabb_t *prim_aabbs;
+    vec3 *prim_centroids;
+} _golf_bvh_builder_t;
+
+typedef struct _golf_bvh_bin {
+    golf_bvh_aabb_t aabb;
+    int count;
+} _golf_bvh_bin_t;
+
+static golf_bvh_aabb_t _aabb_empty(void) {
+    golf_bvh_aabb_t aabb;
+    aabb.min = V3(FLT_MAX, FLT_MAX, FLT_MAX);
+    aabb.max = V3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    return aabb;
+}
+
+static float _aabb_surface_area(golf_bvh_aabb_t aabb) {
+    vec3 d = vec3_sub(aabb.max, aabb.min);
+    if (d.x < 0 || d.y < 0 || d.z < 0) {
         return 0;
     }
-    else {
-        return -1;
-    }
+    return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
 }
 
-static int _golf_bvh_construct(golf_bvh_t *bvh, vec_golf_bvh_node_info_t node_infos, int idx, int n) {
-    if (n == 0) {
-        return -1;
+static float _vec3_axis(vec3 v, int axis) {
+    if (axis == 0) return v.x;
+    else if (axis == 1) return v.y;
+    else return v.z;
+}
+
+static int _alloc_node(vec_golf_bvh_node_t *nodes) {
+    golf_bvh_node_t node;
+    memset(&node, 0, sizeof(node));
+    vec_push(nodes, node);
+    return nodes->length - 1;
+}
+
+static golf_bvh_node_t *_get_node(golf_bvh_t *bvh, int idx) {
+    return &bvh->nodes.data[idx];
+}
+
+static int _bin_idx(float c, float cmin, float scale) {
+    int bin = (int)((c - cmin) * scale);
+    if (bin < 0) bin = 0;
+    if (bin > GOLF_BVH_NUM_SAH_BINS - 1) bin = GOLF_BVH_NUM_SAH_BINS - 1;
+    return bin;
+}
+
+// Splits the faces along the axis and bin boundary with the lowest surface area
+// heuristic cost. Returns false when keeping the faces in a single leaf is cheaper.
+static bool _find_sah_split(_golf_bvh_builder_t *builder, int start, int count, golf_bvh_aabb_t aabb, golf_bvh_aabb_t centroid_aabb, int *split_axis, int *split_bin) {
+    float best_cost = FLT_MAX;
+    *split_axis = -1;
+    *split_bin = -1;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float cmin = _vec3_axis(centroid_aabb.min, axis);
+        float cmax = _vec3_axis(centroid_aabb.max, axis);
+        if (cmax - cmin <= 0) {
+            continue;
+        }
+        float scale = GOLF_BVH_NUM_SAH_BINS / (cmax - cmin);
+
+        _golf_bvh_bin_t bins[GOLF_BVH_NUM_SAH_BINS];
+        for (int i = 0; i < GOLF_BVH_NUM_SAH_BINS; i++) {
+            bins[i].aabb = _aabb_empty();
+            bins[i].count = 0;
+        }
+        for (int i = start; i < start + count; i++) {
+            int prim_idx = builder->prim_idxs[i];
+            int bin = _bin_idx(_vec3_axis(builder->prim_centroids[prim_idx], axis), cmin, scale);
+            bins[bin].aabb = _aabb_combine(bins[bin].aabb, builder->prim_aabbs[prim_idx]);
+            bins[bin].count++;
+        }
+
+        float right_area[GOLF_BVH_NUM_SAH_BINS];
+        int right_count[GOLF_BVH_NUM_SAH_BINS];
+        golf_bvh_aabb_t right_aabb = _aabb_empty();
+        int right_n = 0;
+        for (int i = GOLF_BVH_NUM_SAH_BINS - 1; i > 0; i--) {
+            right_aabb = _aabb_combine(right_aabb, bins[i].aabb);
+            right_n += bins[i].count;
+            right_area[i] = _aabb_surface_area(right_aabb);
+            right_count[i] = right_n;
+        }
+
+        golf_bvh_aabb_t left_aabb = _aabb_empty();
+        int left_n = 0;
+        for (int i = 0; i < GOLF_BVH_NUM_SAH_BINS - 1; i++) {
+            left_aabb = _aabb_combine(left_aabb, bins[i].aabb);
+            left_n += bins[i].count;
+            if (left_n == 0 || right_count[i + 1] == 0) {
+                continue;
+            }
+
+            float cost = left_n * _aabb_surface_area(left_aabb) + right_count[i + 1] * right_area[i + 1];
+            if (cost < best_cost) {
+                best_cost = cost;
+                *split_axis = axis;
+                *split_bin = i;
+            }
+        }
     }
-    else if (n == 1) {
-        return _alloc_leaf_node(bvh, node_infos.data[idx]);
+
+    if (*split_axis < 0) {
+        return false;
     }
-    else if (n == 2) {
-        int left = _alloc_leaf_node(bvh, node_infos.data[idx]);
-        int right = _alloc_leaf_node(bvh, node_infos.data[idx + 1]);
-        return _alloc_inner_node(bvh, left, right);
+
+    // Traversal is assumed to cost about as much as one face test
+    float leaf_cost = count * _aabb_surface_area(aabb);
+    float split_cost = _aabb_surface_area(aabb) + best_cost;
+    return count > GOLF_BVH_MAX_LEAF_FACES || split_cost < leaf_cost;
+}
+
+static void _set_node_aabb(golf_bvh_node_t *node, golf_bvh_aabb_t aabb) {
+    node->aabb_min = aabb.min;
+    node->aabb_max = aabb.max;
+}
+
+static void _golf_bvh_construct(_golf_bvh_builder_t *builder, int node_idx, int depth, int start, int count) {
+    vec_golf_bvh_node_t *nodes = builder->nodes;
+
+    golf_bvh_aabb_t aabb = _aabb_empty();
+    golf_bvh_aabb_t centroid_aabb = _aabb_empty();
+    for (int i = start; i < start + count; i++) {
+        int prim_idx = builder->prim_idxs[i];
+        aabb = _aabb_combine(aabb, builder->prim_aabbs[prim_idx]);
+        _update_aabb(&centroid_aabb, builder->prim_centroids[prim_idx]);
+    }
+    _set_node_aabb(&nodes->data[node_idx], aabb);
+
+    // Past the max depth everything goes into one leaf so traversal stacks can't overflow
+    int split_axis = -1, split_bin = -1;
+    int left_count = 0;
+    if (depth >= GOLF_BVH_MAX_DEPTH - 1) {
+        left_count = 0;
     }
-    else {
-        _cmp_axis = vec3_normalize(V3(golf_randf(-1, 1), golf_randf(-1, 1), golf_randf(-1, 1)));
-        qsort(node_infos.data + idx, n, sizeof(golf_bvh_node_info_t), _bvh_node_cmp);
+    else if (count > 1 && _find_sah_split(builder, start, count, aabb, centroid_aabb, &split_axis, &split_bin)) {
+        float cmin = _vec3_axis(centroid_aabb.min, split_axis);
+        float cmax = _vec3_axis(centroid_aabb.max, split_axis);
+        float scale = GOLF_BVH_NUM_SAH_BINS / (cmax - cmin);
 
-        int left_n = n / 2;
-        int right_n = n - left_n;
+        int i = start;
+        int j = start + count - 1;
+        while (i <= j) {
+            int prim_idx = builder->prim_idxs[i];
+            if (_bin_idx(_vec3_axis(builder->prim_centroids[prim_idx], split_axis), cmin, scale) <= split_bin) {
+                i++;
+            }
+            else {
+                builder->prim_idxs[i] = builder->prim_idxs[j];
+                builder->prim_idxs[j] = prim_idx;
+                j--;
+            }
+        }
+        left_count = i - start;
+    }
+    else if (count > GOLF_BVH_MAX_LEAF_FACES) {
+        // All the centroids are in the same spot, so just split the primitives in half
+        left_count = count / 2;
+    }
 
-        int left = _golf_bvh_construct(bvh, node_infos, idx, left_n);
-        int right = _golf_bvh_construct(bvh, node_infos, idx + left_n, right_n);
-        return _alloc_inner_node(bvh, left, right);
+    if (left_count == 0 || left_count == count) {
+        golf_bvh_node_t *node = &nodes->data[node_idx];
+        node->first = start;
+        node->count = count;
+        return;
     }
+
+    int left = _alloc_node(nodes);
+    int right = _alloc_node(nodes);
+    assert(right == left + 1);
+    GOLF_UNUSED(right);
+
+    golf_bvh_node_t *node = &nodes->data[node_idx];
+    node->first = left;
+    node->count = 0;
+
+    _golf_bvh_construct(builder, left, depth + 1, start, left_count);
+    _golf_bvh_construct(builder, left + 1, depth + 1, start + left_count, count - left_count);
 }
 
 void golf_bvh_construct(golf_bvh_t *bvh, vec_golf_bvh_node_info_t node_infos) {
-    bvh->faces.length = 0;
+    _clear_faces(bvh);
     bvh->nodes.length = 0;
-    bvh->parent = _golf_bvh_construct(bvh, node_infos, 0, node_infos.length);
+    bvh->parent = -1;
+
+    int num_faces = 0;
+    for (int i = 0; i < node_infos.length; i++) {
+        num_faces += node_infos.data[i].face_count;
+    }
+
+    if (num_faces > 0) {
+        _golf_bvh_builder_t builder;
+        builder.nodes = &bvh->nodes;
+        builder.prim_idxs = golf_alloc(sizeof(int) * num_faces);
+        builder.prim_aabbs = golf_alloc(sizeof(golf_bvh_aabb_t) * bvh->faces.length);
+        builder.prim_centroids = golf_alloc(sizeof(vec3) * bvh->faces.length);
+        int *face_owners = golf_alloc(sizeof(int) * bvh->faces.length);
+
+        // Each node info is one entity's faces, so it gets one owner
+        int n = 0;
+        for (int i = 0; i < node_infos.length; i++) {
+            golf_bvh_node_info_t info = node_infos.data[i];
+            if (info.face_count > 0) {
+                golf_bvh_face_t *first_face = &bvh->faces.data[info.face_start];
+                golf_bvh_owner_t owner;
+                owner.idx = first_face->idx;
+                owner.t = first_face->t;
+                owner.level = first_face->level;
+                owner.entity = first_face->entity;
+                vec_push(&bvh->owners, owner);
+            }
+
+            for (int j = info.face_start; j < info.face_start + info.face_count; j++) {
+                golf_bvh_face_t *face = &bvh->faces.data[j];
+                golf_bvh_aabb_t aabb = _aabb_empty();
+                _update_aabb(&aabb, face->a);
+                _update_aabb(&aabb, face->b);
+                _update_aabb(&aabb, face->c);
+
+                builder.prim_idxs[n] = j;
+                builder.prim_aabbs[j] = aabb;
+                builder.prim_centroids[j] = vec3_scale(vec3_add(aabb.min, aabb.max), 0.5f);
+                face_owners[j] = bvh->owners.length - 1;
+                n++;
+            }
+        }
+
+        vec_reserve(&bvh->nodes, 2 * num_faces);
+        bvh->parent = _alloc_node(&bvh->nodes);
+        _golf_bvh_construct(&builder, bvh->parent, 0, 0, num_faces);
+
+        _reserve_faces(bvh, num_faces);
+        for (int i = 0; i < num_faces; i++) {
+            int face_idx = builder.prim_idxs[i];
+            _push_face(bvh, bvh->faces.data[face_idx], face_owners[face_idx]);
+        }
+
+        golf_free(face_owners);
+        golf_free(builder.prim_idxs);
+        golf_free(builder.prim_aabbs);
+        golf_free(builder.prim_centroids);
+    }
+
+    bvh->faces.length = 0;
+}
+
+static vec3 _face_a(golf_bvh_t *bvh, int i) {
+    return V3(bvh->ax.data[i], bvh->ay.data[i], bvh->az.data[i]);
 }
 
-static bool _golf_bvh_ray_test(golf_bvh_t *bvh, int node_idx, vec3 ro, vec3 rd, float *t, int *idx, golf_bvh_face_t *face) {
-    if (node_idx < 0) {
+static vec3 _face_b(golf_bvh_t *bvh, int i) {
+    return V3(bvh->bx.data[i], bvh->by.data[i], bvh->bz.data[i]);
+}
+
+static vec3 _face_c(golf_bvh_t *bvh, int i) {
+    return V3(bvh->cx.data[i], bvh->cy.data[i], bvh->cz.data[i]);
+}
+
+static triangle_soa_t _face_soa(golf_bvh_t *bvh) {
+    triangle_soa_t triangles = {
+        bvh->ax.data, bvh->ay.data, bvh->az.data,
+        bvh->bx.data, bvh->by.data, bvh->bz.data,
+        bvh->cx.data, bvh->cy.data, bvh->cz.data,
+    };
+    return triangles;
+}
+
+// Slab test against the node's AABB using the precomputed inverse ray direction.
+// Only succeeds if the box is in front of the ray and starts before max_t.
+static bool _ray_intersect_node(golf_bvh_node_t *node, vec3 ro, vec3 inv_rd, float max_t, float *t) {
+    float tx0 = (node->aabb_min.x - ro.x) * inv_rd.x;
+    float tx1 = (node->aabb_max.x - ro.x) * inv_rd.x;
+    float ty0 = (node->aabb_min.y - ro.y) * inv_rd.y;
+    float ty1 = (node->aabb_max.y - ro.y) * inv_rd.y;
+    float tz0 = (node->aabb_min.z - ro.z) * inv_rd.z;
+    float tz1 = (node->aabb_max.z - ro.z) * inv_rd.z;
+
+    float tmin = fmaxf(fmaxf(fminf(tx0, tx1), fminf(ty0, ty1)), fminf(tz0, tz1));
+    float tmax = fminf(fminf(fmaxf(tx0, tx1), fmaxf(ty0, ty1)), fmaxf(tz0, tz1));
+    if (tmax < 0 || tmin > tmax || tmin >= max_t) {
         return false;
     }
 
-    golf_bvh_node_t *node = _get_node(bvh, node_idx);
+    *t = tmin;
+    return true;
+}
+
+// Returns the index of the closest face hit before max_t, or -1 if there is none
+static int _golf_bvh_ray_test(golf_bvh_t *bvh, vec3 ro, vec3 rd, float max_t, float *t) {
+    if (bvh->parent < 0) {
+        return -1;
+    }
+
+    vec3 inv_rd = V3(1.0f / rd.x, 1.0f / rd.y, 1.0f / rd.z);
+    float best_t = max_t;
+    int best_face = -1;
+
+    float node_t;
+    if (!_ray_intersect_node(_get_node(bvh, bvh->parent), ro, inv_rd, best_t, &node_t)) {
+        return -1;
+    }
+
+    // Each stack entry is a node whose AABB was already hit, along with its entry t
+    int stack[GOLF_BVH_MAX_DEPTH];
+    float stack_t[GOLF_BVH_MAX_DEPTH];
+    int stack_size = 0;
+    stack[stack_size] = bvh->parent;
+    stack_t[stack_size] = node_t;
+    stack_size++;
+
+    while (stack_size > 0) {
+        stack_size--;
+        if (stack_t[stack_size] >= best_t) {
+            continue;
+        }
+
+        golf_bvh_node_t *node = _get_node(bvh, stack[stack_size]);
+        while (node->count == 0) {
+            golf_bvh_node_t *left = _get_node(bvh, node->first);
+            golf_bvh_node_t *right = _get_node(bvh, node->first + 1);
+
+            float t_left, t_right;
+            bool hit_left = _ray_intersect_node(left, ro, inv_rd, best_t, &t_left);
+            bool hit_right = _ray_intersect_node(right, ro, inv_rd, best_t, &t_right);
 
-    float t0;
-    if (!ray_intersect_aabb(ro, rd, node->aabb.min, node->aabb.max, &t0)) {
+            if (hit_left && hit_right) {
+                if (t_right < t_left) {
+                    golf_bvh_node_t *temp_node = left;
+                    left = right;
+                    right = temp_node;
+                    float temp_t = t_left;
+                    t_left = t_right;
+                    t_right = temp_t;
+                }
+
+                assert(stack_size < GOLF_BVH_MAX_DEPTH);
+                stack[stack_size] = (int)(right - bvh->nodes.data);
+                stack_t[stack_size] = t_right;
+                stack_size++;
+                node = left;
+            }
+            else if (hit_left) {
+                node = left;
+            }
+            else if (hit_right) {
+                node = right;
+            }
+            else {
+                node = NULL;
+                break;
+            }
+        }
+
+        if (!node) {
+            continue;
+        }
+
+        float t0;
+        int idx0;
+        triangle_soa_t triangles = triangle_soa_offset(_face_soa(bvh), node->first);
+        if (ray_intersect_triangles_soa(ro, rd, triangles, node->count, &t0, &idx0)) {
+            if (t0 < best_t) {
+                best_t = t0;
+                best_face = node->first + idx0;
+            }
+        }
+    }
+
+    *t = best_t;
+    return best_face;
+}
+
+bool golf_bvh_ray_test(golf_bvh_t *bvh, vec3 ro, vec3 rd, float *t, int *idx, golf_bvh_face_t *face) {
+    float best_t;
+    int best_face = _golf_bvh_ray_test(bvh, ro, rd, FLT_MAX, &best_t);
+    if (best_face < 0) {
+        return false;
+    }
+
+    *t = best_t;
+    *idx = bvh->owners.data[bvh->face_infos.data[best_face].owner].idx;
+    if (face) {
+        *face = golf_bvh_get_face(bvh, best_face);
+    }
+    return true;
+}
+
+// The sphere is given both in the space of the bvh's faces (local_bp, local_br),
+// which is used to cull nodes, and in world space, which is used for the face
+// tests. When instance is not NULL the faces are moved into world space by its
+// model matrix, and the contacts belong to its entity at time t.
+static bool _golf_bvh_ball_test(golf_bvh_t *bvh, vec3 local_bp, float local_br, const golf_bvh_instance_t *instance, float t, vec3 bp, float br, golf_ball_contact_t *contacts, int *num_ball_contacts, int max_ball_contacts) {
+    if (bvh->parent < 0) {
         return false;
     }
 
-    if (node->is_leaf) {
-        golf_bvh_node_info_t info = node->leaf_node_info;
+    bool any_hit = false;
+    int stack[GOLF_BVH_MAX_DEPTH];
+    int stack_size = 0;
+    stack[stack_size++] = bvh->parent;
 
-        *t = FLT_MAX;
-        *idx = -1;
+    while (stack_size > 0) {
+        golf_bvh_node_t *node = _get_node(bvh, stack[--stack_size]);
+        if (!sphere_intersect_aabb(local_bp, local_br, node->aabb_min, node->aabb_max)) {
+            continue;
+        }
 
-        for (int i = 0; i < info.face_count; i++) {
-            int face_idx = info.face_start + i; 
-            golf_bvh_face_t hit_face = bvh->faces.data[face_idx];
-            vec3 triangle_points[3] = { hit_face.a, hit_face.b, hit_face.c };
+        if (node->count == 0) {
+            assert(stack_size + 2 <= GOLF_BVH_MAX_DEPTH);
+            stack[stack_size++] = node->first + 1;
+            stack[stack_size++] = node->first;
+            continue;
+        }
 
-            float t0;
-            int idx0;
-            if (ray_intersect_triangles(ro, rd, triangle_points, 3, &t0, &idx0)) {
-                if (t0 < *t) {
-                    if (face) {
-                        *face = hit_face;
+        for (int start = node->first; start < node->first + node->count; start += GOLF_BVH_MAX_LEAF_FACES) {
+            int count = node->first + node->count - start;
+            if (count > GOLF_BVH_MAX_LEAF_FACES) count = GOLF_BVH_MAX_LEAF_FACES;
+
+            // Instanced faces are moved into world space before the batched test
+            float moved[9][GOLF_BVH_MAX_LEAF_FACES];
+            triangle_soa_t triangles = triangle_soa_offset(_face_soa(bvh), start);
+            if (instance) {
+                for (int j = 0; j < count; j++) {
+                    vec3 a = vec3_apply_mat4(_face_a(bvh, start + j), 1, instance->model_mat);
+                    vec3 b = vec3_apply_mat4(_face_b(bvh, start + j), 1, instance->model_mat);
+                    vec3 c = vec3_apply_mat4(_face_c(bvh, start + j), 1, instance->model_mat);
+                    moved[0][j] = a.x; moved[1][j] = a.y; moved[2][j] = a.z;
+                    moved[3][j] = b.x; moved[4][j] = b.y; moved[5][j] = b.z;
+                    moved[6][j] = c.x; moved[7][j] = c.y; moved[8][j] = c.z;
+                }
+                triangle_soa_t moved_triangles = {
+                    moved[0], moved[1], moved[2],
+                    moved[3], moved[4], moved[5],
+                    moved[6], moved[7], moved[8],
+                };
+                triangles = moved_triangles;
+            }
+
+            vec3 cps[GOLF_BVH_MAX_LEAF_FACES];
+            triangle_contact_type_t types[GOLF_BVH_MAX_LEAF_FACES];
+            closest_point_point_triangles_soa(bp, triangles, count, cps, types);
+
+            for (int j = 0; j < count; j++) {
+                vec3 cp = cps[j];
+                float dist = vec3_distance(bp, cp);
+                if (dist < br) {
+                    if (*num_ball_contacts < max_ball_contacts) {
+                        golf_bvh_face_info_t *info = &bvh->face_infos.data[start + j];
+                        golf_bvh_owner_t *owner = &bvh->owners.data[info->owner];
+                        golf_level_t *level = owner->level;
+                        golf_entity_t *entity = owner->entity;
+                        vec3 water_dir = info->water_dir;
+                        float face_t = owner->t;
+                        if (instance) {
+                            level = instance->level;
+                            entity = instance->entity;
+                            water_dir = vec3_apply_mat4(water_dir, 0, instance->model_mat);
+                            face_t = t;
+                        }
+
+                        vec3 a = V3(triangles.ax[j], triangles.ay[j], triangles.az[j]);
+                        vec3 b = V3(triangles.bx[j], triangles.by[j], triangles.bz[j]);
+                        vec3 c = V3(triangles.cx[j], triangles.cy[j], triangles.cz[j]);
+                        vec3 vel = golf_entity_get_velocity(level, entity, face_t, cp);
+                        bool is_out_of_bounds = entity->parent_idx >= 0;
+                        bool is_water = entity->type == WATER_ENTITY;
+                        golf_ball_contact_t contact = golf_ball_contact(a, b, c, vel, bp, br, cp, dist, info->restitution, info->friction, info->vel_scale, types[j], is_water, water_dir, is_out_of_bounds);
+                        contacts[*num_ball_contacts] = contact;
+                        *num_ball_contacts = *num_ball_contacts + 1;
                     }
-                    *t = t0;
-                    *idx = info.idx;
+
+                    any_hit = true;
                 }
             }
         }
+    }
+
+    return any_hit;
+}
+
+// Like _ray_intersect_node but against the node's AABB grown by r
+static bool _sweep_intersect_node(golf_bvh_node_t *node, float r, vec3 ro, vec3 inv_rd, float max_t, float *t) {
+    golf_bvh_node_t grown = *node;
+    grown.aabb_min = vec3_sub(grown.aabb_min, V3(r, r, r));
+    grown.aabb_max = vec3_add(grown.aabb_max, V3(r, r, r));
+    return _ray_intersect_node(&grown, ro, inv_rd, max_t, t);
+}
+
+// Finds the first time along the displacement d that the ball is skin deep into
+// a face it is not already touching. Spaces and instance are handled as in
+// _golf_bvh_ball_test. Water faces are skipped since the ball moves through them.
+static bool _golf_bvh_ball_sweep(golf_bvh_t *bvh, vec3 local_bp, float local_br, vec3 local_d, const golf_bvh_instance_t *instance, vec3 bp, float br, vec3 d, float skin, float *toi) {
+    if (bvh->parent < 0) {
+        return false;
+    }
+
+    vec3 inv_d = V3(1.0f / local_d.x, 1.0f / local_d.y, 1.0f / local_d.z);
+    bool any_hit = false;
+    int stack[GOLF_BVH_MAX_DEPTH];
+    int stack_size = 0;
+    stack[stack_size++] = bvh->parent;
+
+    while (stack_size > 0) {
+        golf_bvh_node_t *node = _get_node(bvh, stack[--stack_size]);
+        float node_t;
+        if (!_sweep_intersect_node(node, local_br, local_bp, inv_d, *toi, &node_t)) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            assert(stack_size + 2 <= GOLF_BVH_MAX_DEPTH);
+            stack[stack_size++] = node->first + 1;
+            stack[stack_size++] = node->first;
+            continue;
+        }
+
+        for (int i = node->first; i < node->first + node->count; i++) {
+            golf_entity_t *entity = instance ? instance->entity : bvh->owners.data[bvh->face_infos.data[i].owner].entity;
+            if (entity->type == WATER_ENTITY) {
+                continue;
+            }
+
+            vec3 a = _face_a(bvh, i);
+            vec3 b = _face_b(bvh, i);
+            vec3 c = _face_c(bvh, i);
+            if (instance) {
+                a = vec3_apply_mat4(a, 1, instance->model_mat);
+                b = vec3_apply_mat4(b, 1, instance->model_mat);
+                c = vec3_apply_mat4(c, 1, instance->model_mat);
+            }
+
+            // Faces the ball already touches are handled by the contacts
+            triangle_contact_type_t type;
+            vec3 cp = closest_point_point_triangle(bp, a, b, c, &type);
+            if (vec3_distance(bp, cp) < br) {
+                continue;
+            }
+
+            float t0;
+            if (swept_sphere_intersect_triangle(bp, br - skin, d, a, b, c, &t0) && t0 < *toi) {
+                *toi = t0;
+                any_hit = true;
+            }
+        }
+    }
+
+    return any_hit;
+}
+
+bool golf_bvh_ball_test(golf_bvh_t *bvh, vec3 bp, float br, vec3 bv, golf_ball_contact_t *contacts, int *num_ball_contacts, int max_ball_contacts) {
+    GOLF_UNUSED(bv);
+    return _golf_bvh_ball_test(bvh, bp, br, NULL, 0, bp, br, contacts, num_ball_contacts, max_ball_contacts);
+}
+
+bool golf_bvh_ball_sweep(golf_bvh_t *bvh, vec3 bp, float br, vec3 d, float skin, float *toi) {
+    *toi = 1.0f;
+    return _golf_bvh_ball_sweep(bvh, bp, br, d, NULL, bp, br, d, skin, toi);
+}
+
+void golf_tlas_init(golf_tlas_t *tlas) {
+    tlas->t = 0;
+    vec_init(&tlas->blases, "bvh");
+    vec_init(&tlas->instances, "bvh");
+    vec_init(&tlas->instance_idxs, "bvh");
+    vec_init(&tlas->nodes, "bvh");
+    tlas->parent = -1;
+}
+
+void golf_tlas_deinit(golf_tlas_t *tlas) {
+    golf_tlas_clear(tlas);
+    vec_deinit(&tlas->blases);
+    vec_deinit(&tlas->instances);
+    vec_deinit(&tlas->instance_idxs);
+    vec_deinit(&tlas->nodes);
+}
+
+void golf_tlas_clear(golf_tlas_t *tlas) {
+    for (int i = 0; i < tlas->blases.length; i++) {
+        golf_bvh_deinit(&tlas->blases.data[i].bvh);
+    }
+    tlas->blases.length = 0;
+    tlas->instances.length = 0;
+    tlas->instance_idxs.length = 0;
+    tlas->nodes.length = 0;
+    tlas->parent = -1;
+}
+
+uint32_t golf_blas_hash(golf_level_t *level, golf_model_t *model) {
+    uint32_t hash = 2166136261u;
+    uint32_t header[2] = { GOLF_BLAS_BUILD_VERSION, model->is_water };
+    hash = _fnv_hash(hash, header, sizeof(header));
+    for (int i = 0; i < model->groups.length; i++) {
+        golf_model_group_t group = model->groups.data[i];
+
+        float material_vals[3] = { 0, 0, 0 };
+        golf_material_t material;
+        if (golf_level_get_material(level, group.material_name, &material)) {
+            material_vals[0] = material.restitution;
+            material_vals[1] = material.friction;
+            material_vals[2] = material.vel_scale;
+        }
+        hash = _fnv_hash(hash, material_vals, sizeof(material_vals));
+        hash = _fnv_hash(hash, model->positions.data + group.start_vertex, sizeof(vec3) * group.vertex_count);
+    }
+    if (model->is_water) {
+        hash = _fnv_hash(hash, model->water_dir.data, sizeof(vec3) * model->water_dir.length);
+    }
+    return hash;
+}
+
+void golf_blas_construct(golf_blas_t *blas, golf_level_t *level, golf_model_t *model) {
+    // The faces are built without an entity, the instance supplies it during queries
+    blas->model = model;
+    golf_bvh_init(&blas->bvh);
+    vec_push(&blas->bvh.node_infos, _golf_bvh_node_info(&blas->bvh, -1, level, NULL, model, 0, mat4_identity()));
+    golf_bvh_construct(&blas->bvh, blas->bvh.node_infos);
+}
+
+// Serialized layout: u32 num nodes, u32 num faces, the nodes, the 9 vertex
+// component arrays and then a _blas_face_data_t per face
+typedef struct _blas_face_data {
+    vec3 water_dir;
+    float restitution, friction, vel_scale;
+} _blas_face_data_t;
+
+void golf_blas_serialize(golf_blas_t *blas, vec_char_t *buf) {
+    golf_bvh_t *bvh = &blas->bvh;
+    uint32_t counts[2] = { (uint32_t)bvh->nodes.length, (uint32_t)bvh->face_infos.length };
+    vec_pusharr(buf, (char*)counts, sizeof(counts));
+    vec_pusharr(buf, (char*)bvh->nodes.data, sizeof(golf_bvh_node_t) * bvh->nodes.length);
 
-        return *t < FLT_MAX;
+    vec_float_t *components[9] = { &bvh->ax, &bvh->ay, &bvh->az, &bvh->bx, &bvh->by, &bvh->bz, &bvh->cx, &bvh->cy, &bvh->cz };
+    for (int i = 0; i < 9; i++) {
+        vec_pusharr(buf, (char*)components[i]->data, sizeof(float) * components[i]->length);
     }
-    else {
-        float t_left;
-        int idx_left;
-        golf_bvh_face_t left_face;
-        bool left_test = _golf_bvh_ray_test(bvh, node->left, ro, rd, &t_left, &idx_left, &left_face);
 
-        float t_right;
-        int idx_right;
-        golf_bvh_face_t right_face;
-        bool right_test = _golf_bvh_ray_test(bvh, node->right, ro, rd, &t_right, &idx_right, &right_face);
+    for (int i = 0; i < bvh->face_infos.length; i++) {
+        golf_bvh_face_info_t *info = &bvh->face_infos.data[i];
+        _blas_face_data_t face_data;
+        face_data.water_dir = info->water_dir;
+        face_data.restitution = info->restitution;
+        face_data.friction = info->friction;
+        face_data.vel_scale = info->vel_scale;
+        vec_pusharr(buf, (char*)&face_data, sizeof(face_data));
+    }
+}
 
-        if (left_test && right_test) {
-            if (t_left < t_right) {
-                *t = t_left;
-                *idx = idx_left;
-                if (face) *face = left_face;
+bool golf_blas_deserialize(golf_blas_t *blas, golf_level_t *level, golf_model_t *model, const char *data, int data_len) {
+    uint32_t counts[2];
+    if (data_len < (int)sizeof(counts)) {
+        return false;
+    }
+    memcpy(counts, data, sizeof(counts));
+    int num_nodes = (int)counts[0];
+    int num_faces = (int)counts[1];
+    int64_t expected_len = (int64_t)sizeof(counts) + (int64_t)sizeof(golf_bvh_node_t) * counts[0] +
+        (int64_t)(9 * sizeof(float) + sizeof(_blas_face_data_t)) * counts[1];
+    if (num_nodes < 0 || num_faces < 0 || expected_len != data_len) {
+        return false;
+    }
+
+    // Traversal trusts the nodes, so check every face range and child index is in bounds.
+    // Children always come after their parent, which also rules out cycles, and the
+    // depth is held to what the builder allows so the traversal stacks can't overflow.
+    const char *nodes_data = data + sizeof(counts);
+    int *depths = golf_alloc(sizeof(int) * (num_nodes > 0 ? num_nodes : 1));
+    for (int i = 0; i < num_nodes; i++) {
+        depths[i] = 0;
+    }
+    bool valid = true;
+    for (int i = 0; i < num_nodes && valid; i++) {
+        golf_bvh_node_t node;
+        memcpy(&node, nodes_data + sizeof(golf_bvh_node_t) * i, sizeof(node));
+        if (node.count > 0) {
+            valid = node.first >= 0 && (int64_t)node.first + node.count <= num_faces;
+        }
+        else {
+            valid = node.count == 0 && node.first > i && (int64_t)node.first + 1 < num_nodes &&
+                depths[i] < GOLF_BVH_MAX_DEPTH - 1;
+            for (int j = 0; j < 2 && valid; j++) {
+                int child = node.first + j;
+                if (depths[child] < depths[i] + 1) {
+                    depths[child] = depths[i] + 1;
+                }
             }
-            else {
-                *t = t_right;
-                *idx = idx_right;
-                if (face) *face = right_face;
+        }
+    }
+    golf_free(depths);
+    if (!valid) {
+        return false;
+    }
+
+    blas->model = model;
+    golf_bvh_init(&blas->bvh);
+    golf_bvh_t *bvh = &blas->bvh;
+
+    const char *pos = data + sizeof(counts);
+    vec_pusharr(&bvh->nodes, (const golf_bvh_node_t*)pos, num_nodes);
+    pos += sizeof(golf_bvh_node_t) * num_nodes;
+
+    vec_float_t *components[9] = { &bvh->ax, &bvh->ay, &bvh->az, &bvh->bx, &bvh->by, &bvh->bz, &bvh->cx, &bvh->cy, &bvh->cz };
+    for (int i = 0; i < 9; i++) {
+        vec_pusharr(components[i], (const float*)pos, num_faces);
+        pos += sizeof(float) * num_faces;
+    }
+
+    golf_bvh_owner_t owner;
+    owner.idx = -1;
+    owner.t = 0;
+    owner.level = level;
+    owner.entity = NULL;
+    vec_push(&bvh->owners, owner);
+
+    vec_reserve(&bvh->face_infos, num_faces);
+    const _blas_face_data_t *face_datas = (const _blas_face_data_t*)pos;
+    for (int i = 0; i < num_faces; i++) {
+        golf_bvh_face_info_t info;
+        info.owner = 0;
+        info.water_dir = face_datas[i].water_dir;
+        info.restitution = face_datas[i].restitution;
+        info.friction = face_datas[i].friction;
+        info.vel_scale = face_datas[i].vel_scale;
+        vec_push(&bvh->face_infos, info);
+    }
+
+    bvh->parent = num_nodes > 0 ? 0 : -1;
+    return true;
+}
+
+static int _golf_tlas_get_blas(golf_tlas_t *tlas, golf_level_t *level, golf_entity_t *entity) {
+    golf_model_t *model = golf_entity_get_model(entity);
+    for (int i = 0; i < tlas->blases.length; i++) {
+        if (tlas->blases.data[i].model == model) {
+            return i;
+        }
+    }
+
+    // Use the BLAS built when the level was imported if the model hasn't changed since
+    golf_blas_t blas;
+    bool loaded = false;
+    uint32_t hash = golf_blas_hash(level, model);
+    for (int i = 0; i < level->bvhs.length && !loaded; i++) {
+        golf_level_bvh_t *level_bvh = &level->bvhs.data[i];
+        if (level_bvh->hash == hash) {
+            loaded = golf_blas_deserialize(&blas, level, model, level_bvh->data, level_bvh->data_len);
+            if (!loaded) {
+                golf_log_warning("Prebuilt BLAS %08x is invalid, building it instead", hash);
             }
-            return true;
         }
-        else if (left_test && !right_test) {
-            *t = t_left;
-            *idx = idx_left;
-            if (face) *face = left_face;
-            return true;
+    }
+    if (!loaded) {
+        golf_blas_construct(&blas, level, model);
+    }
+    blas.hash = hash;
+    vec_push(&tlas->blases, blas);
+    return tlas->blases.length - 1;
+}
+
+void golf_tlas_update_blas(golf_tlas_t *tlas, golf_level_t *level, golf_model_t *model) {
+    for (int i = 0; i < tlas->blases.length; i++) {
+        golf_blas_t *blas = &tlas->blases.data[i];
+        if (blas->model != model) continue;
+
+        // Rebuilt in place so instances keep their blas_idx
+        uint32_t hash = golf_blas_hash(level, model);
+        if (blas->hash != hash) {
+            golf_bvh_deinit(&blas->bvh);
+            golf_blas_construct(blas, level, model);
+            blas->hash = hash;
         }
-        else if (!left_test && right_test) {
-            *t = t_right;
-            *idx = idx_right;
-            if (face) *face = right_face;
-            return true;
+        return;
+    }
+}
+
+static golf_bvh_aabb_t _golf_tlas_instance_aabb(golf_tlas_t *tlas, golf_bvh_instance_t *instance, mat4 model_mat) {
+    golf_bvh_t *bvh = &tlas->blases.data[instance->blas_idx].bvh;
+    golf_bvh_node_t *root = _get_node(bvh, bvh->parent);
+    golf_bvh_aabb_t aabb = _aabb_empty();
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = V3(i & 1 ? root->aabb_max.x : root->aabb_min.x,
+                i & 2 ? root->aabb_max.y : root->aabb_min.y,
+                i & 4 ? root->aabb_max.z : root->aabb_min.z);
+        _update_aabb(&aabb, vec3_apply_mat4(corner, 1, model_mat));
+    }
+    return aabb;
+}
+
+static void _golf_tlas_update_instance(golf_tlas_t *tlas, golf_bvh_instance_t *instance, float t) {
+    golf_transform_t transform = _get_moved_transform(instance->level, instance->entity, t);
+    vec3 scale = transform.scale;
+    float min_scale = fminf(fabsf(scale.x), fminf(fabsf(scale.y), fabsf(scale.z)));
+
+    instance->model_mat = golf_transform_get_model_mat(transform);
+    instance->inv_model_mat = mat4_inverse(instance->model_mat);
+    instance->inv_min_scale = min_scale > 0 ? 1.0f / min_scale : FLT_MAX;
+    instance->aabb = _golf_tlas_instance_aabb(tlas, instance, instance->model_mat);
+}
+
+void golf_tlas_add_entity(golf_tlas_t *tlas, int idx, golf_level_t *level, golf_entity_t *entity) {
+    golf_model_t *model = golf_entity_get_model(entity);
+    if (!model || model->positions.length == 0) {
+        return;
+    }
+
+    int blas_idx = _golf_tlas_get_blas(tlas, level, entity);
+    if (tlas->blases.data[blas_idx].bvh.parent < 0) {
+        return;
+    }
+
+    golf_movement_t *movement = golf_entity_get_movement(entity);
+
+    golf_bvh_instance_t instance;
+    memset(&instance, 0, sizeof(instance));
+    instance.idx = idx;
+    instance.level = level;
+    instance.entity = entity;
+    instance.blas_idx = blas_idx;
+    instance.is_moving = movement && movement->type != GOLF_MOVEMENT_NONE;
+    vec_push(&tlas->instances, instance);
+}
+
+void golf_tlas_construct(golf_tlas_t *tlas, float t) {
+    tlas->t = t;
+    tlas->nodes.length = 0;
+    tlas->instance_idxs.length = 0;
+    tlas->parent = -1;
+
+    int num_instances = tlas->instances.length;
+    if (num_instances == 0) {
+        return;
+    }
+
+    _golf_bvh_builder_t builder;
+    builder.nodes = &tlas->nodes;
+    builder.prim_idxs = golf_alloc(sizeof(int) * num_instances);
+    builder.prim_aabbs = golf_alloc(sizeof(golf_bvh_aabb_t) * num_instances);
+    builder.prim_centroids = golf_alloc(sizeof(vec3) * num_instances);
+
+    for (int i = 0; i < num_instances; i++) {
+        golf_bvh_instance_t *instance = &tlas->instances.data[i];
+        _golf_tlas_update_instance(tlas, instance, t);
+        builder.prim_idxs[i] = i;
+        builder.prim_aabbs[i] = instance->aabb;
+        builder.prim_centroids[i] = vec3_scale(vec3_add(instance->aabb.min, instance->aabb.max), 0.5f);
+    }
+
+    vec_reserve(&tlas->nodes, 2 * num_instances);
+    tlas->parent = _alloc_node(&tlas->nodes);
+    _golf_bvh_construct(&builder, tlas->parent, 0, 0, num_instances);
+    vec_pusharr(&tlas->instance_idxs, builder.prim_idxs, num_instances);
+
+    golf_free(builder.prim_idxs);
+    golf_free(builder.prim_aabbs);
+    golf_free(builder.prim_centroids);
+}
+
+void golf_tlas_refit(golf_tlas_t *tlas, float t) {
+    tlas->t = t;
+
+    bool any_moved = false;
+    for (int i = 0; i < tlas->instances.length; i++) {
+        golf_bvh_instance_t *instance = &tlas->instances.data[i];
+        if (instance->is_moving) {
+            _golf_tlas_update_instance(tlas, instance, t);
+            any_moved = true;
+        }
+    }
+    if (!any_moved) {
+        return;
+    }
+
+    // Children are always allocated after their parent, so walking the nodes
+    // backwards updates both children before the node that contains them
+    for (int i = tlas->nodes.length - 1; i >= 0; i--) {
+        golf_bvh_node_t *node = &tlas->nodes.data[i];
+        golf_bvh_aabb_t aabb = _aabb_empty();
+        if (node->count > 0) {
+            for (int j = node->first; j < node->first + node->count; j++) {
+                aabb = _aabb_combine(aabb, tlas->instances.data[tlas->instance_idxs.data[j]].aabb);
+            }
         }
         else {
-            return false;
+            golf_bvh_node_t *left = &tlas->nodes.data[node->first];
+            golf_bvh_node_t *right = &tlas->nodes.data[node->first + 1];
+            aabb.min = V3(fminf(left->aabb_min.x, right->aabb_min.x), fminf(left->aabb_min.y, right->aabb_min.y), fminf(left->aabb_min.z, right->aabb_min.z));
+            aabb.max = V3(fmaxf(left->aabb_max.x, right->aabb_max.x), fmaxf(left->aabb_max.y, right->aabb_max.y), fmaxf(left->aabb_max.z, right->aabb_max.z));
         }
+        _set_node_aabb(node, aabb);
     }
 }
 
-bool golf_bvh_ray_test(golf_bvh_t *bvh, vec3 ro, vec3 rd, float *t, int *idx, golf_bvh_face_t *face) {
-    return _golf_bvh_ray_test(bvh, bvh->parent, ro, rd, t, idx, face);    
+bool golf_tlas_moving_near(golf_tlas_t *tlas, vec3 p, float radius, float t0, float t1, int num_samples) {
+    for (int i = 0; i < tlas->instances.length; i++) {
+        golf_bvh_instance_t *instance = &tlas->instances.data[i];
+        if (!instance->is_moving) {
+            continue;
+        }
+
+        // Pad the swept box by the most any side moved between two samples, so it
+        // also covers where the instance is in between them
+        golf_bvh_aabb_t swept = _aabb_empty();
+        golf_bvh_aabb_t prev = _aabb_empty();
+        float pad = 0;
+        for (int j = 0; j <= num_samples; j++) {
+            float t = t0 + (t1 - t0) * j / num_samples;
+            golf_transform_t transform = _get_moved_transform(instance->level, instance->entity, t);
+            golf_bvh_aabb_t aabb = _golf_tlas_instance_aabb(tlas, instance, golf_transform_get_model_mat(transform));
+            if (j > 0) {
+                vec3 d_min = vec3_sub(aabb.min, prev.min);
+                vec3 d_max = vec3_sub(aabb.max, prev.max);
+                pad = fmaxf(pad, fmaxf(fabsf(d_min.x), fmaxf(fabsf(d_min.y), fabsf(d_min.z))));
+                pad = fmaxf(pad, fmaxf(fabsf(d_max.x), fmaxf(fabsf(d_max.y), fabsf(d_max.z))));
+            }
+            prev = aabb;
+            swept = _aabb_combine(swept, aabb);
+        }
+
+        vec3 closest = V3(fmaxf(swept.min.x - pad, fminf(p.x, swept.max.x + pad)),
+                fmaxf(swept.min.y - pad, fminf(p.y, swept.max.y + pad)),
+                fmaxf(swept.min.z - pad, fminf(p.z, swept.max.z + pad)));
+        if (vec3_distance(closest, p) <= radius) {
+            return true;
+        }
+    }
+    return false;
 }
 
-static bool _golf_bvh_ball_test(golf_bvh_t *bvh, int node_idx, vec3 bp, float br, vec3 bv, golf_ball_contact_t *contacts, int *num_ball_contacts, int max_ball_contacts) {
-    if (node_idx < 0) {
+bool golf_tlas_ray_test(golf_tlas_t *tlas, vec3 ro, vec3 rd, float *t, int *idx, golf_bvh_face_t *face) {
+    if (tlas->parent < 0) {
         return false;
     }
 
-    golf_bvh_node_t *node = _get_node(bvh, node_idx);
-    if (!sphere_intersect_aabb(bp, br, node->aabb.min, node->aabb.max)) {
+    vec3 inv_rd = V3(1.0f / rd.x, 1.0f / rd.y, 1.0f / rd.z);
+    float best_t = FLT_MAX;
+    int best_face = -1;
+    golf_bvh_instance_t *best_instance = NULL;
+
+    int stack[GOLF_BVH_MAX_DEPTH];
+    int stack_size = 0;
+    stack[stack_size++] = tlas->parent;
+
+    while (stack_size > 0) {
+        golf_bvh_node_t *node = &tlas->nodes.data[stack[--stack_size]];
+
+        float node_t;
+        if (!_ray_intersect_node(node, ro, inv_rd, best_t, &node_t)) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            assert(stack_size + 2 <= GOLF_BVH_MAX_DEPTH);
+            stack[stack_size++] = node->first + 1;
+            stack[stack_size++] = node->first;
+            continue;
+        }
+
+        for (int i = node->first; i < node->first + node->count; i++) {
+            golf_bvh_instance_t *instance = &tlas->instances.data[tlas->instance_idxs.data[i]];
+            golf_bvh_t *bvh = &tlas->blases.data[instance->blas_idx].bvh;
+
+            // Affine transforms keep the ray parameter the same, so the t found in
+            // model space can be compared directly against the other instances
+            vec3 local_ro = vec3_apply_mat4(ro, 1, instance->inv_model_mat);
+            vec3 local_rd = vec3_apply_mat4(rd, 0, instance->inv_model_mat);
+            float local_t;
+            int face_idx = _golf_bvh_ray_test(bvh, local_ro, local_rd, best_t, &local_t);
+            if (face_idx >= 0) {
+                best_t = local_t;
+                best_face = face_idx;
+                best_instance = instance;
+            }
+        }
+    }
+
+    if (!best_instance) {
         return false;
     }
 
-    if (node->is_leaf) {
-        golf_bvh_node_info_t info = node->leaf_node_info;
+    *t = best_t;
+    *idx = best_instance->idx;
+    if (face) {
+        *face = golf_bvh_get_face(&tlas->blases.data[best_instance->blas_idx].bvh, best_face);
+        face->idx = best_instance->idx;
+        face->t = tlas->t;
+        face->level = best_instance->level;
+        face->entity = best_instance->entity;
+        face->a = vec3_apply_mat4(face->a, 1, best_instance->model_mat);
+        face->b = vec3_apply_mat4(face->b, 1, best_instance->model_mat);
+        face->c = vec3_apply_mat4(face->c, 1, best_instance->model_mat);
+        face->water_dir = vec3_apply_mat4(face->water_dir, 0, best_instance->model_mat);
+    }
+    return true;
+}
 
-        bool any_hit = false;
-        for (int i = 0; i < info.face_count; i++) {
-            int face_idx = info.face_start + i;
-            golf_bvh_face_t face = bvh->faces.data[face_idx];
+bool golf_tlas_ball_test(golf_tlas_t *tlas, vec3 bp, float br, vec3 bv, golf_ball_contact_t *contacts, int *num_ball_contacts, int max_ball_contacts) {
+    GOLF_UNUSED(bv);
 
-            triangle_contact_type_t type;
-            vec3 cp = closest_point_point_triangle(bp, face.a, face.b, face.c, &type);
-            float dist = vec3_distance(bp, cp);
-            if (dist < br) {
-                if (*num_ball_contacts < max_ball_contacts) {
-                    vec3 vel = golf_entity_get_velocity(face.level, face.entity, face.t, cp);
-                    bool is_out_of_bounds = face.entity->parent_idx >= 0;
-                    bool is_water = face.entity->type == WATER_ENTITY;
-                    vec3 water_dir = face.water_dir;
-                    golf_ball_contact_t contact = golf_ball_contact(face.a, face.b, face.c, vel, bp, br, cp, dist, face.restitution, face.friction, face.vel_scale, type, is_water, water_dir, is_out_of_bounds);
-                    contacts[*num_ball_contacts] = contact;
-                    *num_ball_contacts = *num_ball_contacts + 1;
-                }
+    if (tlas->parent < 0) {
+        return false;
+    }
+
+    bool any_hit = false;
+    int stack[GOLF_BVH_MAX_DEPTH];
+    int stack_size = 0;
+    stack[stack_size++] = tlas->parent;
+
+    while (stack_size > 0) {
+        golf_bvh_node_t *node = &tlas->nodes.data[stack[--stack_size]];
+        if (!sphere_intersect_aabb(bp, br, node->aabb_min, node->aabb_max)) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            assert(stack_size + 2 <= GOLF_BVH_MAX_DEPTH);
+            stack[stack_size++] = node->first + 1;
+            stack[stack_size++] = node->first;
+            continue;
+        }
+
+        for (int i = node->first; i < node->first + node->count; i++) {
+            golf_bvh_instance_t *instance = &tlas->instances.data[tlas->instance_idxs.data[i]];
+            if (!sphere_intersect_aabb(bp, br, instance->aabb.min, instance->aabb.max)) {
+                continue;
+            }
 
+            // The model matrix has no shear, so the ball in model space is contained
+            // in a sphere scaled by the inverse of the smallest scale
+            golf_bvh_t *bvh = &tlas->blases.data[instance->blas_idx].bvh;
+            vec3 local_bp = vec3_apply_mat4(bp, 1, instance->inv_model_mat);
+            float local_br = br * instance->inv_min_scale;
+            if (_golf_bvh_ball_test(bvh, local_bp, local_br, instance, tlas->t, bp, br, contacts, num_ball_contacts, max_ball_contacts)) {
                 any_hit = true;
             }
         }
-        return any_hit;
-    }
-    else {
-        bool left_test = _golf_bvh_ball_test(bvh, node->left, bp, br, bv, contacts, num_ball_contacts, max_ball_contacts);
-        bool right_test = _golf_bvh_ball_test(bvh, node->right, bp, br, bv, contacts, num_ball_contacts, max_ball_contacts);
-        return left_test || right_test;
     }
 
-    return true;
+    return any_hit;
 }
 
-bool golf_bvh_ball_test(golf_bvh_t *bvh, vec3 bp, float br, vec3 bv, golf_ball_contact_t *contacts, int *num_ball_contacts, int max_ball_contacts) {
-    return _golf_bvh_ball_test(bvh, bvh->parent, bp, br, bv, contacts, num_ball_contacts, max_ball_contacts);
+bool golf_tlas_ball_sweep(golf_tlas_t *tlas, vec3 bp, float br, vec3 d, float skin, float *toi) {
+    *toi = 1.0f;
+    if (tlas->parent < 0) {
+        return false;
+    }
+
+    vec3 inv_d = V3(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+    bool any_hit = false;
+    int stack[GOLF_BVH_MAX_DEPTH];
+    int stack_size = 0;
+    stack[stack_size++] = tlas->parent;
+
+    while (stack_size > 0) {
+        golf_bvh_node_t *node = &tlas->nodes.data[stack[--stack_size]];
+        float node_t;
+        if (!_sweep_intersect_node(node, br, bp, inv_d, *toi, &node_t)) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            assert(stack_size + 2 <= GOLF_BVH_MAX_DEPTH);
+            stack[stack_size++] = node->first + 1;
+            stack[stack_size++] = node->first;
+            continue;
+        }
+
+        for (int i = node->first; i < node->first + node->count; i++) {
+            golf_bvh_instance_t *instance = &tlas->instances.data[tlas->instance_idxs.data[i]];
+            if (instance->entity->type == WATER_ENTITY) {
+                continue;
+            }
+
+            // The displacement keeps its parameterization in model space, only the
+            // radius needs to be made conservative
+            golf_bvh_t *bvh = &tlas->blases.data[instance->blas_idx].bvh;
+            vec3 local_bp = vec3_apply_mat4(bp, 1, instance->inv_model_mat);
+            vec3 local_d = vec3_apply_mat4(d, 0, instance->inv_model_mat);
+            float local_br = br * instance->inv_min_scale;
+            if (_golf_bvh_ball_sweep(bvh, local_bp, local_br, local_d, instance, bp, br, d, skin, toi)) {
+                any_hit = true;
+            }
+        }
+    }
+
+    return any_hit;
 }
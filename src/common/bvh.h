@@ -8,7 +8,12 @@
 
 typedef struct golf_bvh golf_bvh_t;
 
+#define GOLF_BVH_MAX_LEAF_FACES 4
+#define GOLF_BVH_NUM_SAH_BINS 16
+#define GOLF_BVH_MAX_DEPTH 64
+
 typedef struct golf_bvh_face {
+    int idx;
     float t;
     golf_level_t *level;
     golf_entity_t *entity;
@@ -18,6 +23,24 @@ typedef struct golf_bvh_face {
 } golf_bvh_face_t;
 typedef vec_t(golf_bvh_face_t) vec_golf_bvh_face_t;
 
+// The entity a run of faces was built from. A BLAS has a single owner without an
+// entity, the instance being queried stands in for it.
+typedef struct golf_bvh_owner {
+    int idx;
+    float t;
+    golf_level_t *level;
+    golf_entity_t *entity;
+} golf_bvh_owner_t;
+typedef vec_t(golf_bvh_owner_t) vec_golf_bvh_owner_t;
+
+// The parts of a face that are only needed once a hit has been found
+typedef struct golf_bvh_face_info {
+    vec3 water_dir;
+    float restitution, friction, vel_scale;
+    int owner;
+} golf_bvh_face_info_t;
+typedef vec_t(golf_bvh_face_info_t) vec_golf_bvh_face_info_t;
+
 typedef struct golf_bvh_aabb {
     vec3 min, max;
 } golf_bvh_aabb_t;
@@ -31,23 +54,77 @@ typedef struct golf_bvh_node_info {
 typedef vec_t(golf_bvh_node_info_t) vec_golf_bvh_node_info_t;
 golf_bvh_node_info_t golf_bvh_node_info(golf_bvh_t *bvh, int idx, golf_level_t *level, golf_entity_t *entity, float t);
 
-typedef struct golf_bvh_node golf_bvh_node_t;
+// Nodes are 32 bytes. Leaves have a non-zero count and first is the start of
+// their face range. Inner nodes have a count of 0 and first is the index of the
+// left child, the right child always comes directly after it.
 typedef struct golf_bvh_node {
-    bool is_leaf;
-    golf_bvh_node_info_t leaf_node_info;
-
-    golf_bvh_aabb_t aabb;
-    int left, right;
+    vec3 aabb_min;
+    int first;
+    vec3 aabb_max;
+    int count;
 } golf_bvh_node_t;
 typedef vec_t(golf_bvh_node_t) vec_golf_bvh_node_t; 
 
+// faces is filled by golf_bvh_node_info and consumed by golf_bvh_construct, which
+// moves the faces referenced by the node infos into leaf order. The vertices are
+// split into one array per component for traversal and everything else goes into
+// face_infos, which is only read for faces that were actually hit. What's the same
+// for every face of an entity is kept once in owners.
 typedef struct golf_bvh {
     vec_golf_bvh_face_t faces;
+    vec_float_t ax, ay, az, bx, by, bz, cx, cy, cz;
+    vec_golf_bvh_face_info_t face_infos;
+    vec_golf_bvh_owner_t owners;
     vec_golf_bvh_node_info_t node_infos;
     vec_golf_bvh_node_t nodes;
     int parent;
 } golf_bvh_t;
 
+// A BVH over one model's faces in model space. It is shared by every entity in
+// the level that uses the model.
+typedef struct golf_blas {
+    golf_model_t *model;
+    // golf_blas_hash of the model when the TLAS built this
+    uint32_t hash;
+    golf_bvh_t bvh;
+} golf_blas_t;
+typedef vec_t(golf_blas_t) vec_golf_blas_t;
+
+// Bump when golf_bvh_construct changes so BLASes prebuilt with levels are rebuilt
+#define GOLF_BLAS_BUILD_VERSION 1
+
+// Hash of everything a BLAS is built from: the model's faces and the values of
+// the level materials they use. Prebuilt BLASes are only used when it matches.
+uint32_t golf_blas_hash(golf_level_t *level, golf_model_t *model);
+void golf_blas_construct(golf_blas_t *blas, golf_level_t *level, golf_model_t *model);
+void golf_blas_serialize(golf_blas_t *blas, vec_char_t *buf);
+bool golf_blas_deserialize(golf_blas_t *blas, golf_level_t *level, golf_model_t *model, const char *data, int data_len);
+
+// An entity placed in the TLAS. Queries are moved into model space to traverse
+// its BLAS, and entities that move only need their transform and AABB updated.
+typedef struct golf_bvh_instance {
+    int idx;
+    golf_level_t *level;
+    golf_entity_t *entity;
+    int blas_idx;
+    bool is_moving;
+    mat4 model_mat, inv_model_mat;
+    float inv_min_scale;
+    golf_bvh_aabb_t aabb;
+} golf_bvh_instance_t;
+typedef vec_t(golf_bvh_instance_t) vec_golf_bvh_instance_t;
+
+// Top level BVH over entity instances. Uses the same node layout as golf_bvh_t,
+// with leaves indexing into instance_idxs.
+typedef struct golf_tlas {
+    float t;
+    vec_golf_blas_t blases;
+    vec_golf_bvh_instance_t instances;
+    vec_int_t instance_idxs;
+    vec_golf_bvh_node_t nodes;
+    int parent;
+} golf_tlas_t;
+
 typedef struct golf_ball_contact {
     bool is_ignored, is_water, is_out_of_bounds;
     triangle_contact_type_t type;
@@ -61,8 +138,29 @@ typedef vec_t(golf_ball_contact_t) vec_golf_ball_contact_t;
 golf_ball_contact_t golf_ball_contact(vec3 a, vec3 b, vec3 c, vec3 vel, vec3 bp, float br, vec3 cp, float dist, float restitution, float friction, float vel_scale, triangle_contact_type_t type, bool is_water, vec3 water_dir, bool is_out_of_bounds);
 
 void golf_bvh_init(golf_bvh_t *bvh);
+void golf_bvh_deinit(golf_bvh_t *bvh);
+golf_bvh_face_t golf_bvh_get_face(golf_bvh_t *bvh, int face_idx);
 void golf_bvh_construct(golf_bvh_t *bvh, vec_golf_bvh_node_info_t);
 bool golf_bvh_ray_test(golf_bvh_t *bvh, vec3 ro, vec3 rd, float *t, int *idx, golf_bvh_face_t *face);
 bool golf_bvh_ball_test(golf_bvh_t *bvh, vec3 ball_pos, float ball_radius, vec3 ball_velocity, golf_ball_contact_t *contacts, int *num_ball_contacts, int max_ball_contacts);
+// Sweeps the ball along ball_delta, toi is the fraction of ball_delta travelled
+// before the ball is skin deep into a face that it was not already touching
+bool golf_bvh_ball_sweep(golf_bvh_t *bvh, vec3 ball_pos, float ball_radius, vec3 ball_delta, float skin, float *toi);
+
+void golf_tlas_init(golf_tlas_t *tlas);
+void golf_tlas_deinit(golf_tlas_t *tlas);
+void golf_tlas_clear(golf_tlas_t *tlas);
+void golf_tlas_add_entity(golf_tlas_t *tlas, int idx, golf_level_t *level, golf_entity_t *entity);
+// Rebuilds the model's BLAS if its faces or materials changed since it was built,
+// for models like geos that are edited in place
+void golf_tlas_update_blas(golf_tlas_t *tlas, golf_level_t *level, golf_model_t *model);
+void golf_tlas_construct(golf_tlas_t *tlas, float t);
+void golf_tlas_refit(golf_tlas_t *tlas, float t);
+// Whether a moving instance gets within radius of p at any point between t0 and t1,
+// checked at num_samples + 1 times across it
+bool golf_tlas_moving_near(golf_tlas_t *tlas, vec3 p, float radius, float t0, float t1, int num_samples);
+bool golf_tlas_ray_test(golf_tlas_t *tlas, vec3 ro, vec3 rd, float *t, int *idx, golf_bvh_face_t *face);
+bool golf_tlas_ball_test(golf_tlas_t *tlas, vec3 ball_pos, float ball_radius, vec3 ball_velocity, golf_ball_contact_t *contacts, int *num_ball_contacts, int max_ball_contacts);
+bool golf_tlas_ball_sweep(golf_tlas_t *tlas, vec3 ball_pos, float ball_radius, vec3 ball_delta, float skin, float *toi);
 
 #endif
@@ -1,12 +1,14 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "data.h"
 
+#include <float.h>
 #include <inttypes.h>
 
 #define STB_VORBIS_HEADER_ONLY
 
 #include "fast_obj/fast_obj.h"
 #include "mattiasgustavsson_libs/assetsys.h"
+#include "miniz/miniz.h"
 #include "parson/parson.h"
 #include "stb/stb_image.h"
 #include "stb/stb_image_write.h"
@@ -15,6 +17,7 @@
 #include "sokol/sokol_app.h"
 #include "sokol/sokol_time.h"
 #include "common/base64.h"
+#include "common/bvh.h"
 #include "common/common.h"
 #include "common/file.h"
 #include "common/graphics.h"
@@ -23,17 +26,34 @@
 #include "common/log.h"
 #include "common/map.h"
 #include "common/maths.h"
+#include "common/pack.h"
 #include "common/string.h"
 #include "common/thread.h"
 
 #if GOLF_PLATFORM_ANDROID | GOLF_PLATFORM_IOS | GOLF_PLATFORM_EMSCRIPTEN
-// CMake builds this file
-#include "common/data_zip.h"
+// CMake builds this file with tools/golf_pack
+#include "common/data_pack.h"
+#define GOLF_DATA_USE_PACK 1
+#endif
+
+// golf_sim and golf_bench are built with GOLF_HEADLESS, which leaves out everything
+// that needs sokol gfx. Nothing gets uploaded there, so loaders aren't finalized.
+#if GOLF_HEADLESS
+#define GOLF_DATA_FINALIZE_FN(fn) NULL
+#else
+#define GOLF_DATA_FINALIZE_FN(fn) fn
+#endif
+
+// Linux maps loose files straight from disk, so only the remaining platforms
+// without a data pack read through assetsys
+#if !GOLF_PLATFORM_LINUX && !GOLF_DATA_USE_PACK
+#define GOLF_DATA_USE_ASSETSYS 1
 #endif
 
 typedef enum _file_event_type {
     FILE_CREATED,
     FILE_UPDATED,
+    FILE_DELETED,
     FILE_LOADED,
 } _file_event_type;
 
@@ -43,26 +63,47 @@ typedef struct _file_event {
 } _file_event_t;
 typedef vec_t(_file_event_t) vec_file_event_t;
 
-static golf_thread_timer_t _main_thread_timer;
+// Files are loaded by a pool of worker threads. Loaders that need other files
+// queue them all at once and then wait for them, running queued loads while they
+// wait, so dependencies load in parallel and waiting workers can't stall the queue.
+#define GOLF_DATA_MAX_WORKERS 8
+
 static golf_thread_timer_t _data_thread_timer;
 
+// Broadcast whenever a file finishes loading or a file is queued
+static golf_cond_t _loaded_data_cond;
 static golf_mutex_t _loaded_data_lock;
 static map_golf_data_t _loaded_data;
 
+static golf_cond_t _files_to_load_cond;
 static golf_mutex_t _files_to_load_lock;
 static vec_golf_file_t _files_to_load;
 
 static golf_mutex_t _seen_files_lock;
 static vec_golf_file_t _seen_files;
 
+static golf_cond_t _file_events_cond;
 static golf_mutex_t _file_events_lock;
 static vec_file_event_t _file_events;
 
+#if GOLF_DATA_USE_ASSETSYS
 static golf_mutex_t _assetsys_lock;
 static assetsys_t *_assetsys;
+#endif
+#if GOLF_DATA_USE_PACK
+static golf_pack_t _data_pack;
+#endif
+// Held while importing so the watcher and golf_data_add_file don't write the same .golf_data at once
+static golf_mutex_t _import_lock;
 
 static map_uint64_t _file_time_map;
 
+// Headless programs have no graphics context, so the finalize step is skipped
+static bool _headless = false;
+
+// Only touched in golf_data_update, see golf_data_get_version
+static int _data_version = 0;
+
 static void _golf_data_thread_load_file(golf_file_t file);
 
 static void _golf_data_add_dependency(vec_golf_file_t *deps, golf_file_t dep) {
@@ -74,10 +115,68 @@ static void _golf_data_add_dependency(vec_golf_file_t *deps, golf_file_t dep) {
     vec_push(deps, dep);
 }
 
+static void _golf_data_queue_file(golf_file_t file) {
+    golf_mutex_lock(&_files_to_load_lock);
+    vec_push(&_files_to_load, file);
+    golf_cond_signal(&_files_to_load_cond);
+    golf_mutex_unlock(&_files_to_load_lock);
+
+    golf_mutex_lock(&_loaded_data_lock);
+    golf_cond_broadcast(&_loaded_data_cond);
+    golf_mutex_unlock(&_loaded_data_lock);
+}
+
+// Must be called with _files_to_load_lock locked
+static bool _golf_data_pop_file_to_load(golf_file_t *file) {
+    if (_files_to_load.length == 0) {
+        return false;
+    }
+    *file = _files_to_load.data[0];
+    vec_splice(&_files_to_load, 0, 1);
+    return true;
+}
+
+static void _golf_data_wait_until_loaded(const char *path) {
+    while (true) {
+        golf_file_t file_to_load;
+        bool has_file_to_load = false;
+
+        golf_mutex_lock(&_loaded_data_lock);
+        golf_data_t *data = map_get(&_loaded_data, path);
+        bool is_loaded = data && data->is_loaded;
+        if (!is_loaded) {
+            golf_mutex_lock(&_files_to_load_lock);
+            has_file_to_load = _golf_data_pop_file_to_load(&file_to_load);
+            golf_mutex_unlock(&_files_to_load_lock);
+            if (!has_file_to_load) {
+                golf_cond_wait(&_loaded_data_cond, &_loaded_data_lock);
+            }
+        }
+        golf_mutex_unlock(&_loaded_data_lock);
+
+        if (is_loaded) {
+            return;
+        }
+        if (has_file_to_load) {
+            _golf_data_thread_load_file(file_to_load);
+        }
+    }
+}
+
+static void _golf_data_load_dependencies(vec_golf_file_t *deps) {
+    for (int i = 0; i < deps->length; i++) {
+        _golf_data_queue_file(deps->data[i]);
+    }
+    for (int i = 0; i < deps->length; i++) {
+        _golf_data_wait_until_loaded(deps->data[i].path);
+    }
+}
+
 //
 // GIF TEXTURES
 //
 
+#if !GOLF_HEADLESS
 static bool _golf_gif_texture_finalize(void *ptr) {
     golf_gif_texture_t *texture = (golf_gif_texture_t*) ptr;
 
@@ -103,8 +202,9 @@ static bool _golf_gif_texture_finalize(void *ptr) {
 
     return true;
 }
+#endif
 
-static bool _golf_gif_texture_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_gif_texture_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(meta_data);
     GOLF_UNUSED(meta_data_len);
@@ -135,6 +235,7 @@ static bool _golf_gif_texture_unload(void *ptr) {
 // TEXTURES
 //
 
+#if !GOLF_HEADLESS
 static bool _golf_texture_finalize(void *ptr) {
     golf_texture_t* texture = (golf_texture_t*) ptr;
     sg_image_desc img_desc = {
@@ -155,8 +256,9 @@ static bool _golf_texture_finalize(void *ptr) {
     texture->image_data = NULL;
     return true;
 }
+#endif
 
-static bool _golf_texture_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_texture_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -193,8 +295,12 @@ static bool _golf_texture_load(void *ptr, const char *path, char *data, int data
 }
 
 static bool _golf_texture_unload(void *ptr) {
+#if GOLF_HEADLESS
+    GOLF_UNUSED(ptr);
+#else
     golf_texture_t* texture = (golf_texture_t*) ptr;
     sg_destroy_image(texture->sg_image);
+#endif
     return true;
 }
 
@@ -366,7 +472,7 @@ static void _golf_shader_import_get_shader(const char *file_path, const char *la
     }
 }
 
-static bool _golf_shader_import(const char *path, char *data, int data_len) {
+static bool _golf_shader_import(const char *path, const char *data, int data_len) {
     GOLF_UNUSED(data);
     GOLF_UNUSED(data_len);
 
@@ -386,7 +492,11 @@ static bool _golf_shader_import(const char *path, char *data, int data_len) {
     {
         golf_string_t import_shader_file_path;
         golf_string_initf(&import_shader_file_path, "data", "%s.golf_data", file.path);
-        json_serialize_to_file_pretty(val, import_shader_file_path.cstr);
+        char *serialized = json_serialize_to_string_pretty(val);
+        if (!serialized || !golf_file_save_data(import_shader_file_path.cstr, serialized, (int)strlen(serialized))) {
+            golf_log_warning("Unable to write %s", import_shader_file_path.cstr);
+        }
+        json_free_serialized_string(serialized);
         golf_string_deinit(&import_shader_file_path);
     }
 
@@ -395,6 +505,31 @@ static bool _golf_shader_import(const char *path, char *data, int data_len) {
     return true;
 }
 
+#if !GOLF_HEADLESS
+static void _golf_shader_match_uniform_layout(golf_shader_t *shader, golf_shader_uniform_t *uniform, bool is_vs) {
+    uniform->has_layout = false;
+    golf_shader_uniform_block_type_t type;
+    const golf_shader_uniform_layout_t *layout = golf_shader_uniform_layout_find(shader->file.path, is_vs, uniform->name, &type);
+    if (!layout) {
+        return;
+    }
+
+    bool matches = layout->size == uniform->size && layout->num_members == uniform->members.length;
+    for (int i = 0; matches && i < layout->num_members; i++) {
+        const golf_shader_uniform_layout_member_t *layout_member = &layout->members[i];
+        golf_shader_uniform_member_t *member = &uniform->members.data[i];
+        matches = strcmp(layout_member->name, member->name) == 0 &&
+            layout_member->offset == member->offset && layout_member->size == member->size;
+    }
+    if (!matches) {
+        golf_log_warning("Uniform block %s in %s doesn't match shader_uniforms.h", uniform->name, shader->file.path);
+        return;
+    }
+
+    uniform->has_layout = true;
+    uniform->layout = type;
+}
+
 static bool _golf_shader_finalize(void *ptr) {
     golf_shader_t *shader = (golf_shader_t*) ptr;
 
@@ -411,6 +546,7 @@ static bool _golf_shader_finalize(void *ptr) {
         desc.vs.uniform_blocks[uniform->binding].size = uniform->size;
         uniform->data = golf_alloc(uniform->size);
         memset(uniform->data, 0, uniform->size);
+        _golf_shader_match_uniform_layout(shader, uniform, true);
 
         desc.vs.uniform_blocks[uniform->binding].uniforms[0].name = uniform->name;
         desc.vs.uniform_blocks[uniform->binding].uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
@@ -424,6 +560,7 @@ static bool _golf_shader_finalize(void *ptr) {
         desc.fs.uniform_blocks[uniform->binding].size = uniform->size;
         uniform->data = golf_alloc(uniform->size);
         memset(uniform->data, 0, uniform->size);
+        _golf_shader_match_uniform_layout(shader, uniform, false);
 
         desc.fs.uniform_blocks[uniform->binding].uniforms[0].name = uniform->name;
         desc.fs.uniform_blocks[uniform->binding].uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
@@ -438,6 +575,7 @@ static bool _golf_shader_finalize(void *ptr) {
 
     shader->sg_shader = sg_make_shader(&desc);
 
+    // Pipelines reading golf_model_t buffers take the packed formats from _golf_model_pack_vertices
     vec_init(&shader->pipelines, "data.shader");
     if (strcmp(shader->file.path, "data/shaders/ui.glsl") == 0) {
         {
@@ -445,7 +583,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
                     },
                 },
@@ -473,7 +611,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
                     },
                 },
@@ -491,7 +629,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
                     },
                 },
@@ -509,8 +647,8 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
-                        [1] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 1 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
+                        [1] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 1 },
                     },
                 },
                 .depth = {
@@ -531,10 +669,10 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
-                        [2] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 2 },
-                        [3] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 3 },
+                        [2] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 2 },
+                        [3] = { .format = SG_VERTEXFORMAT_USHORT2N, .buffer_index = 3 },
                     },
                 },
                 .depth = {
@@ -548,6 +686,30 @@ static bool _golf_shader_finalize(void *ptr) {
             pipeline.sg_pipeline = sg_make_pipeline(&desc);
             vec_push(&shader->pipelines, pipeline);
         }
+        {
+            // Everything in one packed and indexed buffer, used for static level geometry
+            sg_pipeline_desc desc = {
+                .shader = shader->sg_shader,
+                .index_type = SG_INDEXTYPE_UINT32,
+                .layout = {
+                    .attrs = {
+                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 0 },
+                        [2] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
+                        [3] = { .format = SG_VERTEXFORMAT_USHORT2N, .buffer_index = 0 },
+                    },
+                },
+                .depth = {
+                    .compare = SG_COMPAREFUNC_LESS_EQUAL,
+                    .write_enabled = true,
+                },
+            };
+
+            golf_shader_pipeline_t pipeline;
+            snprintf(pipeline.name, GOLF_MAX_NAME_LEN, "%s", "environment_material_interleaved");
+            pipeline.sg_pipeline = sg_make_pipeline(&desc);
+            vec_push(&shader->pipelines, pipeline);
+        }
     }
     else if (strcmp(shader->file.path, "data/shaders/solid_color_material.glsl") == 0) {
         {
@@ -555,7 +717,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                     },
                 },
                 .depth = {
@@ -583,9 +745,9 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
-                        [2] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 2 },
+                        [2] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 2 },
                     },
                 },
                 .depth = {
@@ -612,9 +774,9 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
-                        [2] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 2 },
+                        [2] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 2 },
                     },
                 },
                 .stencil = {
@@ -642,7 +804,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                     },
                 },
                 .depth = {
@@ -680,7 +842,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
                     },
                 },
@@ -709,8 +871,8 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
-                        [1] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 1 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
+                        [1] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 1 },
                         [2] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 2 },
                     },
                 },
@@ -731,8 +893,8 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
-                        [1] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 1 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
+                        [1] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 1 },
                         [2] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 2 },
                     },
                 },
@@ -772,9 +934,9 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
-                        [2] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 2 },
+                        [2] = { .format = SG_VERTEXFORMAT_USHORT2N, .buffer_index = 2 },
                     },
                 },
                 .depth = {
@@ -802,9 +964,9 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
-                        [2] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 2 },
+                        [2] = { .format = SG_VERTEXFORMAT_USHORT2N, .buffer_index = 2 },
                     },
                 },
                 .depth = {
@@ -850,7 +1012,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
                     },
                 },
@@ -897,7 +1059,7 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
                         [1] = { .format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1 },
                     },
                 },
@@ -944,8 +1106,8 @@ static bool _golf_shader_finalize(void *ptr) {
                 .shader = shader->sg_shader,
                 .layout = {
                     .attrs = {
-                        [0] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0 },
-                        [1] = { .format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 1 },
+                        [0] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 0 },
+                        [1] = { .format = SG_VERTEXFORMAT_SHORT4N, .buffer_index = 1 },
                     },
                 },
                 .depth = {
@@ -973,6 +1135,7 @@ static bool _golf_shader_finalize(void *ptr) {
 
     return true;
 }
+#endif
 
 golf_shader_uniform_value_t golf_shader_uniform_value_float(const char *name, float f) {
     golf_shader_uniform_value_t value;
@@ -1152,6 +1315,22 @@ golf_shader_pipeline_t *golf_shader_get_pipeline(golf_shader_t *shader, const ch
     return NULL;
 }
 
+#if !GOLF_HEADLESS
+void golf_shader_apply_uniforms(golf_shader_t *shader, golf_shader_uniform_block_type_t type, const void *data) {
+    const golf_shader_uniform_layout_t *layout = golf_shader_uniform_layout_get(type);
+    vec_golf_shader_uniform_t *uniforms = layout->is_vs ? &shader->vs_uniforms : &shader->fs_uniforms;
+    for (int i = 0; i < uniforms->length; i++) {
+        golf_shader_uniform_t *uniform = &uniforms->data[i];
+        if (uniform->has_layout && uniform->layout == type) {
+            sg_shader_stage stage = layout->is_vs ? SG_SHADERSTAGE_VS : SG_SHADERSTAGE_FS;
+            sg_apply_uniforms(stage, uniform->binding, &(sg_range) { data, layout->size });
+            return;
+        }
+    }
+    golf_log_warning("Could not find uniform block %s in %s", layout->name, shader->file.path);
+}
+#endif
+
 static bool _golf_shader_load_inputs(JSON_Array *inputs_arr, vec_golf_shader_input_t *inputs) {
     vec_init(inputs, "data");
     for (int i = 0; i < (int)json_array_get_count(inputs_arr); i++) {
@@ -1180,6 +1359,8 @@ static bool _golf_shader_load_uniforms(JSON_Array *uniforms_arr, vec_golf_shader
         snprintf(uniform.name, GOLF_MAX_NAME_LEN, "%s", name);
         uniform.size = size;
         uniform.binding = binding;
+        uniform.has_layout = false;
+        uniform.layout = GOLF_UNIFORMS_COUNT;
         vec_init(&uniform.members, "data");
 
         JSON_Array *members_arr = json_object_get_array(uniform_obj, "members");
@@ -1218,7 +1399,7 @@ static bool _golf_shader_load_textures(JSON_Array *textures_arr, vec_golf_shader
     return true;
 }
 
-static bool _golf_shader_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_shader_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -1266,8 +1447,12 @@ static bool _golf_shader_load(void *ptr, const char *path, char *data, int data_
 }
 
 static bool _golf_shader_unload(void *ptr) {
+#if GOLF_HEADLESS
+    GOLF_UNUSED(ptr);
+#else
     golf_shader_t *shader = (golf_shader_t*) ptr;
     sg_destroy_shader(shader->sg_shader);
+#endif
     return true;
 }
 
@@ -1326,7 +1511,7 @@ static JSON_Value *_golf_font_atlas_import(const char *file_data, int font_size,
     return val;
 }
 
-static bool _golf_font_import(const char *path, char *data, int data_len) {
+static bool _golf_font_import(const char *path, const char *data, int data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
 
@@ -1349,13 +1534,18 @@ static bool _golf_font_import(const char *path, char *data, int data_len) {
 
     golf_string_t import_font_file_path;
     golf_string_initf(&import_font_file_path, "data", "%s.golf_data", path);
-    json_serialize_to_file(val, import_font_file_path.cstr);
+    char *serialized = json_serialize_to_string(val);
+    if (!serialized || !golf_file_save_data(import_font_file_path.cstr, serialized, (int)strlen(serialized))) {
+        golf_log_warning("Unable to write %s", import_font_file_path.cstr);
+    }
+    json_free_serialized_string(serialized);
     golf_string_deinit(&import_font_file_path);
 
     json_value_free(val);
     return true;
 }
 
+#if !GOLF_HEADLESS
 static bool _golf_font_finalize(void *ptr) {
     golf_font_t *font = (golf_font_t*) ptr;
     for (int i = 0; i < font->atlases.length; i++) {
@@ -1379,6 +1569,7 @@ static bool _golf_font_finalize(void *ptr) {
     }
     return true;
 }
+#endif
 
 static void _golf_font_load_atlas(JSON_Object *atlas_obj, golf_font_atlas_t *atlas) {
     atlas->font_size = (float)json_object_get_number(atlas_obj, "font_size");
@@ -1416,7 +1607,7 @@ static void _golf_font_load_atlas(JSON_Object *atlas_obj, golf_font_atlas_t *atl
     golf_free(img_data);
 }
 
-static bool _golf_font_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_font_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -1448,7 +1639,11 @@ static bool _golf_font_unload(void *ptr) {
     golf_font_t *font = (golf_font_t*) ptr;
     for (int i = 0; i < font->atlases.length; i++) {
         golf_font_atlas_t atlas = font->atlases.data[i];
+#if GOLF_HEADLESS
+        GOLF_UNUSED(atlas);
+#else
         sg_destroy_image(atlas.sg_image);
+#endif
     }
     vec_deinit(&font->atlases);
     return true;
@@ -1480,6 +1675,8 @@ golf_model_t golf_model_dynamic(vec_golf_group_t groups, vec_vec3_t positions, v
     model.texcoords = texcoords;
     model.is_water = false;
     model.sg_size = 0;
+    model.sg_pos_offset = V3(0, 0, 0);
+    model.sg_pos_scale = 1;
     return model;
 }
 
@@ -1492,10 +1689,62 @@ golf_model_t golf_model_dynamic_water(vec_golf_group_t groups, vec_vec3_t positi
     model.is_water = true;
     model.water_dir = water_dir;
     model.sg_size = 0;
+    model.sg_pos_offset = V3(0, 0, 0);
+    model.sg_pos_scale = 1;
     return model;
 }
 
+mat4 golf_model_get_pack_mat(golf_model_t *model) {
+    float s = model->sg_pos_scale;
+    return mat4_multiply(mat4_translation(model->sg_pos_offset), mat4_scale(V3(s, s, s)));
+}
+
+#if !GOLF_HEADLESS
+// Positions are quantized to SHORT4N against the model's bounds and normals packed to
+// SHORT4N, both 8 bytes a vertex instead of 12. The scale is the same on every axis so
+// shaders that transform normals by the inverse transpose of model_mat are unaffected.
+// The caller frees *positions and *normals.
+static void _golf_model_pack_vertices(golf_model_t *model, int16_t **positions, int16_t **normals) {
+    int n = model->positions.length;
+    vec3 bmin = V3(FLT_MAX, FLT_MAX, FLT_MAX);
+    vec3 bmax = V3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int i = 0; i < n; i++) {
+        vec3 p = model->positions.data[i];
+        bmin = V3(fminf(bmin.x, p.x), fminf(bmin.y, p.y), fminf(bmin.z, p.z));
+        bmax = V3(fmaxf(bmax.x, p.x), fmaxf(bmax.y, p.y), fmaxf(bmax.z, p.z));
+    }
+
+    model->sg_pos_offset = V3(0, 0, 0);
+    model->sg_pos_scale = 1;
+    if (n > 0) {
+        vec3 half = vec3_scale(vec3_sub(bmax, bmin), 0.5f);
+        float scale = fmaxf(half.x, fmaxf(half.y, half.z));
+        model->sg_pos_offset = vec3_add(bmin, half);
+        model->sg_pos_scale = scale > 0 ? scale : 1;
+    }
+
+    *positions = golf_alloc(sizeof(int16_t) * 4 * (n > 0 ? n : 1));
+    *normals = golf_alloc(sizeof(int16_t) * 4 * (n > 0 ? n : 1));
+    for (int i = 0; i < n; i++) {
+        vec3 p = vec3_scale(vec3_sub(model->positions.data[i], model->sg_pos_offset), 1.0f / model->sg_pos_scale);
+        (*positions)[4 * i + 0] = golf_pack_snorm16(p.x);
+        (*positions)[4 * i + 1] = golf_pack_snorm16(p.y);
+        (*positions)[4 * i + 2] = golf_pack_snorm16(p.z);
+        (*positions)[4 * i + 3] = 0;
+
+        vec3 normal = model->normals.data[i];
+        (*normals)[4 * i + 0] = golf_pack_snorm16(normal.x);
+        (*normals)[4 * i + 1] = golf_pack_snorm16(normal.y);
+        (*normals)[4 * i + 2] = golf_pack_snorm16(normal.z);
+        (*normals)[4 * i + 3] = 0;
+    }
+}
+#endif
+
 void golf_model_dynamic_finalize(golf_model_t *model) {
+#if GOLF_HEADLESS
+    GOLF_UNUSED(model);
+#else
     model->sg_size = model->positions.length;
 
     if (model->sg_size > 0) {
@@ -1504,10 +1753,10 @@ void golf_model_dynamic_finalize(golf_model_t *model) {
             .usage = SG_USAGE_DYNAMIC,
         };
 
-        desc.size = sizeof(vec3) * model->sg_size;
+        desc.size = 4 * sizeof(int16_t) * model->sg_size;
         model->sg_positions_buf = sg_make_buffer(&desc);
 
-        desc.size = sizeof(vec3) * model->sg_size;
+        desc.size = 4 * sizeof(int16_t) * model->sg_size;
         model->sg_normals_buf = sg_make_buffer(&desc);
 
         desc.size = sizeof(vec2) * model->sg_size;
@@ -1515,9 +1764,13 @@ void golf_model_dynamic_finalize(golf_model_t *model) {
 
         golf_model_dynamic_update_sg_buf(model);
     }
+#endif
 }
 
 void golf_model_dynamic_update_sg_buf(golf_model_t *model) {
+#if GOLF_HEADLESS
+    GOLF_UNUSED(model);
+#else
     if (model->positions.length > model->sg_size) {
         if (model->sg_size > 0) {
             sg_destroy_buffer(model->sg_positions_buf);
@@ -1532,10 +1785,10 @@ void golf_model_dynamic_update_sg_buf(golf_model_t *model) {
             .usage = SG_USAGE_DYNAMIC,
         };
 
-        desc.size = sizeof(vec3) * model->sg_size;
+        desc.size = 4 * sizeof(int16_t) * model->sg_size;
         model->sg_positions_buf = sg_make_buffer(&desc);
 
-        desc.size = sizeof(vec3) * model->sg_size;
+        desc.size = 4 * sizeof(int16_t) * model->sg_size;
         model->sg_normals_buf = sg_make_buffer(&desc);
 
         desc.size = sizeof(vec2) * model->sg_size;
@@ -1543,13 +1796,18 @@ void golf_model_dynamic_update_sg_buf(golf_model_t *model) {
     }
 
     if (model->positions.length > 0) {
+        int16_t *positions, *normals;
+        _golf_model_pack_vertices(model, &positions, &normals);
         sg_update_buffer(model->sg_positions_buf, 
-                &(sg_range) { model->positions.data, sizeof(vec3) * model->positions.length });
+                &(sg_range) { positions, 4 * sizeof(int16_t) * model->positions.length });
         sg_update_buffer(model->sg_normals_buf, 
-                &(sg_range) { model->normals.data, sizeof(vec3) * model->normals.length });
+                &(sg_range) { normals, 4 * sizeof(int16_t) * model->normals.length });
         sg_update_buffer(model->sg_texcoords_buf, 
                 &(sg_range) { model->texcoords.data, sizeof(vec2) * model->texcoords.length });
+        golf_free(positions);
+        golf_free(normals);
     }
+#endif
 }
 
 /*
@@ -1608,6 +1866,7 @@ void golf_model_update_buf(golf_model_t *model) {
 }
 */
 
+#if !GOLF_HEADLESS
 static bool _golf_model_finalize(void *ptr) {
     golf_model_t *model = (golf_model_t*) ptr;
     sg_buffer_desc desc = {
@@ -1615,24 +1874,30 @@ static bool _golf_model_finalize(void *ptr) {
         .usage = SG_USAGE_IMMUTABLE,
     };
 
-    desc.data.ptr = model->positions.data,
-    desc.data.size = sizeof(vec3) * model->positions.length,
+    int16_t *positions, *normals;
+    _golf_model_pack_vertices(model, &positions, &normals);
+
+    desc.data.ptr = positions,
+    desc.data.size = 4 * sizeof(int16_t) * model->positions.length,
     model->sg_positions_buf = sg_make_buffer(&desc);
 
-    desc.data.ptr = model->normals.data,
-    desc.data.size = sizeof(vec3) * model->normals.length,
+    desc.data.ptr = normals,
+    desc.data.size = 4 * sizeof(int16_t) * model->normals.length,
     model->sg_normals_buf = sg_make_buffer(&desc);
 
     desc.data.ptr = model->texcoords.data,
     desc.data.size = sizeof(vec2) * model->texcoords.length,
     model->sg_texcoords_buf = sg_make_buffer(&desc);
 
+    golf_free(positions);
+    golf_free(normals);
     return true;
 }
+#endif
 
 typedef struct _fast_obj_user_data {
     const char *path;
-    char *data;
+    const char *data;
     int data_len, data_pos;
 } _fast_obj_user_data_t;
 
@@ -1671,7 +1936,7 @@ static unsigned long _fast_obj_file_size(void *file, void *user_data) {
     return (unsigned long)data->data_len;
 }
 
-static bool _golf_model_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_model_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -1808,9 +2073,11 @@ static bool _golf_model_load(void *ptr, const char *path, char *data, int data_l
 
 static bool _golf_model_unload(void *ptr) {
     golf_model_t *model = (golf_model_t*) ptr;
+#if !GOLF_HEADLESS
     sg_destroy_buffer(model->sg_positions_buf);
     sg_destroy_buffer(model->sg_normals_buf);
     sg_destroy_buffer(model->sg_texcoords_buf);
+#endif
     vec_deinit(&model->positions);
     vec_deinit(&model->normals);
     vec_deinit(&model->texcoords);
@@ -1833,7 +2100,7 @@ static void _golf_pixel_pack_pos_to_uvs(golf_pixel_pack_t *pp, int tex_w, int te
     uv1->y /= tex_h;
 }
 
-static bool _golf_pixel_pack_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_pixel_pack_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -1844,9 +2111,8 @@ static bool _golf_pixel_pack_load(void *ptr, const char *path, char *data, int d
     JSON_Object *obj = json_value_get_object(val);
 
     const char *texture_path = json_object_get_string(obj, "texture");
-    _golf_data_thread_load_file(golf_file(texture_path));
-    while (golf_data_get_load_state(texture_path) != GOLF_DATA_LOADED) 
-        golf_thread_timer_wait(&_data_thread_timer, 10000000);
+    _golf_data_queue_file(golf_file(texture_path));
+    _golf_data_wait_until_loaded(texture_path);
     pixel_pack->texture = golf_data_get_texture(texture_path);
     pixel_pack->tile_size = (float)json_object_get_number(obj, "tile_size");
     pixel_pack->tile_padding = (float)json_object_get_number(obj, "tile_padding");
@@ -2185,7 +2451,7 @@ static void _golf_ui_layout_get_entity_dependency(JSON_Object *entity_obj, vec_g
 
 }
 
-static bool _golf_ui_layout_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_ui_layout_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -2205,11 +2471,7 @@ static bool _golf_ui_layout_load(void *ptr, const char *path, char *data, int da
         JSON_Object *entity_obj = json_array_get_object(entities_arr, i);
         _golf_ui_layout_get_entity_dependency(entity_obj, &deps);
     }
-    for (int i = 0; i < deps.length; i++) {
-        _golf_data_thread_load_file(deps.data[i]);
-        while (golf_data_get_load_state(deps.data[i].path) != GOLF_DATA_LOADED)
-            golf_thread_timer_wait(&_data_thread_timer, 10000000);
-    }
+    _golf_data_load_dependencies(&deps);
     vec_deinit(&deps);
 
     for (int i = 0; i < (int)json_array_get_count(entities_arr); i++) {
@@ -2268,7 +2530,7 @@ static bool _golf_ui_layout_unload(void *ptr) {
 // AUDIO
 //
 
-static bool _golf_audio_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_audio_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(meta_data);
     GOLF_UNUSED(meta_data_len);
@@ -2302,7 +2564,7 @@ static bool _golf_audio_unload(void *ptr) {
 // CONFIG
 //
 
-static bool _golf_config_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_config_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -2317,6 +2579,7 @@ static bool _golf_config_load(void *ptr, const char *path, char *data, int data_
         return false;
     }
 
+    config->version++;
     map_init(&config->properties, "data");
 
     for (int i = 0; i < (int)json_object_get_count(obj); i++) {
@@ -2448,6 +2711,48 @@ vec4 golf_config_get_vec4(golf_config_t *cfg, const char *name) {
     }
 }
 
+bool golf_config_bind(golf_config_t *cfg, const golf_config_binding_t *bindings, int num_bindings, void *out) {
+    bool is_valid = true;
+    for (int i = 0; i < num_bindings; i++) {
+        const golf_config_binding_t *binding = &bindings[i];
+        char *field = (char*)out + binding->offset;
+        golf_config_property_t *prop = map_get(&cfg->properties, binding->name);
+        bool is_prop_valid = prop && prop->type == binding->type;
+        if (!is_prop_valid) {
+            golf_log_error("Missing or invalid config property %s", binding->name);
+            is_valid = false;
+        }
+
+        switch (binding->type) {
+            case GOLF_CONFIG_PROPERTY_NUM: {
+                float val = is_prop_valid ? prop->num_val : 0.0f;
+                memcpy(field, &val, sizeof(val));
+                break;
+            }
+            case GOLF_CONFIG_PROPERTY_VEC2: {
+                vec2 val = is_prop_valid ? prop->vec2_val : V2(0, 0);
+                memcpy(field, &val, sizeof(val));
+                break;
+            }
+            case GOLF_CONFIG_PROPERTY_VEC3: {
+                vec3 val = is_prop_valid ? prop->vec3_val : V3(0, 0, 0);
+                memcpy(field, &val, sizeof(val));
+                break;
+            }
+            case GOLF_CONFIG_PROPERTY_VEC4: {
+                vec4 val = is_prop_valid ? prop->vec4_val : V4(0, 0, 0, 0);
+                memcpy(field, &val, sizeof(val));
+                break;
+            }
+            case GOLF_CONFIG_PROPERTY_STRING:
+                golf_log_error("Config property %s can't be bound, strings don't outlive a reload", binding->name);
+                is_valid = false;
+                break;
+        }
+    }
+    return is_valid;
+}
+
 //
 // LEVEL
 //
@@ -2632,6 +2937,7 @@ static void _golf_json_object_get_geo(JSON_Object *obj, const char *name, golf_g
     *geo = golf_geo(points, faces, generator_data, is_water);
 }
 
+#if !GOLF_HEADLESS
 static bool _golf_level_finalize(void *ptr) {
     golf_level_t *level = (golf_level_t*) ptr;
     for (int i = 0; i < level->lightmap_images.length; i++) {
@@ -2652,93 +2958,452 @@ static bool _golf_level_finalize(void *ptr) {
     }
     return true;
 }
+#endif
 
-static bool _golf_level_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
-    GOLF_UNUSED(path);
-    GOLF_UNUSED(data_len);
-    GOLF_UNUSED(meta_data);
-    GOLF_UNUSED(meta_data_len);
+// Levels are saved as JSON by the editor and imported into a binary .golf_data
+// file that the game loads. The binary file starts with a header and a table
+// of sections. Each section is an array of fixed size records, except the blob
+// section which holds the variable length arrays the records point into (geo
+// vertex data, face indices, lightmap uvs and deflated lightmap texels). All
+// offsets are 4 byte aligned so the records can be read in place. Geo models
+// are stored already triangulated so loading doesn't regenerate them, and the
+// BLASes of the level's models are stored so the physics doesn't build them.
+#define LEVEL_BIN_MAGIC "GLVL"
+#define LEVEL_BIN_VERSION 1
+
+typedef enum _level_bin_section_type {
+    LEVEL_BIN_MATERIALS,
+    LEVEL_BIN_LIGHTMAPS,
+    LEVEL_BIN_LIGHTMAP_SAMPLES,
+    LEVEL_BIN_ENTITIES,
+    LEVEL_BIN_GEOS,
+    LEVEL_BIN_GEO_FACES,
+    LEVEL_BIN_GEO_ARGS,
+    LEVEL_BIN_MODEL_GROUPS,
+    LEVEL_BIN_BLOB,
+    LEVEL_BIN_BVHS,
+    LEVEL_BIN_NUM_SECTIONS,
+} _level_bin_section_type_t;
+
+typedef struct _level_bin_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_sections;
+    uint32_t reserved;
+} _level_bin_header_t;
+
+typedef struct _level_bin_section {
+    uint32_t type, offset, size, count;
+} _level_bin_section_t;
+
+typedef struct _level_bin_material {
+    uint32_t type;
+    char name[GOLF_MAX_NAME_LEN];
+    float friction, restitution, vel_scale;
+    char texture_path[GOLF_FILE_MAX_PATH];
+    vec4 color;
+} _level_bin_material_t;
+
+typedef struct _level_bin_lightmap {
+    char name[GOLF_MAX_NAME_LEN];
+    int32_t resolution, width, height;
+    float time_length;
+    uint32_t repeats;
+    uint32_t first_sample, num_samples;
+} _level_bin_lightmap_t;
+
+// Deflated width * height texels in the blob
+typedef struct _level_bin_lightmap_sample {
+    uint32_t offset, size;
+} _level_bin_lightmap_sample_t;
+
+typedef struct _level_bin_movement {
+    uint32_t type, repeats;
+    float t0, length;
+    vec3 p0, p1, axis;
+    float theta0, theta1, transition_length;
+} _level_bin_movement_t;
+
+typedef struct _level_bin_entity {
+    uint32_t type;
+    int32_t parent_idx;
+    char name[GOLF_MAX_NAME_LEN];
+    golf_transform_t transform;
+    _level_bin_movement_t movement;
+    char model_path[GOLF_FILE_MAX_PATH];
+    float uv_scale;
+    uint32_t ignore_physics, towards_hole;
+    char lightmap_name[GOLF_MAX_NAME_LEN];
+    uint32_t lightmap_uvs_offset, lightmap_num_uvs;
+    int32_t geo_idx;
+} _level_bin_entity_t;
+
+typedef struct _level_bin_geo {
+    uint32_t is_water;
+    uint32_t points_offset, num_points;
+    uint32_t first_face, num_faces;
+    char script_path[GOLF_FILE_MAX_PATH];
+    uint32_t first_arg, num_args;
+    uint32_t first_group, num_groups;
+    uint32_t num_vertices;
+    uint32_t positions_offset, normals_offset, texcoords_offset, water_dir_offset;
+} _level_bin_geo_t;
+
+typedef struct _level_bin_geo_face {
+    char material_name[GOLF_MAX_NAME_LEN];
+    uint32_t uv_gen_type;
+    uint32_t idx_offset, uvs_offset, num_idx;
+    int32_t start_vertex_in_model;
+    vec3 water_dir;
+} _level_bin_geo_face_t;
+
+typedef struct _level_bin_geo_arg {
+    char name[GOLF_MAX_NAME_LEN];
+    uint32_t type;
+    int32_t int_val;
+    vec3 val;
+} _level_bin_geo_arg_t;
+
+typedef struct _level_bin_model_group {
+    char material_name[GOLF_MAX_NAME_LEN];
+    int32_t start_vertex, vertex_count;
+} _level_bin_model_group_t;
+
+// A golf_blas_serialize'd BLAS in the blob
+typedef struct _level_bin_bvh {
+    uint32_t hash;
+    uint32_t offset, size;
+} _level_bin_bvh_t;
+
+static const int _level_bin_record_size[LEVEL_BIN_NUM_SECTIONS] = {
+    sizeof(_level_bin_material_t),
+    sizeof(_level_bin_lightmap_t),
+    sizeof(_level_bin_lightmap_sample_t),
+    sizeof(_level_bin_entity_t),
+    sizeof(_level_bin_geo_t),
+    sizeof(_level_bin_geo_face_t),
+    sizeof(_level_bin_geo_arg_t),
+    sizeof(_level_bin_model_group_t),
+    1,
+    sizeof(_level_bin_bvh_t),
+};
 
-    golf_level_t *level = (golf_level_t*) ptr;
+typedef struct _level_bin_writer {
+    vec_char_t sections[LEVEL_BIN_NUM_SECTIONS];
+    int counts[LEVEL_BIN_NUM_SECTIONS];
+
+    // Only has the materials, which is all that BLASes are built from
+    golf_level_t bvh_level;
+    vec_int_t bvh_hashes;
+    map_int_t bvh_model_paths;
+} _level_bin_writer_t;
+
+typedef struct _level_bin_reader {
+    const char *sections[LEVEL_BIN_NUM_SECTIONS];
+    int counts[LEVEL_BIN_NUM_SECTIONS];
+    int blob_size;
+} _level_bin_reader_t;
+
+static int _level_bin_push(_level_bin_writer_t *writer, _level_bin_section_type_t section, const void *data, int size) {
+    vec_char_t *buf = &writer->sections[section];
+    int offset = buf->length;
+    vec_pusharr(buf, (const char*)data, size);
+    while (buf->length % 4 != 0) {
+        vec_push(buf, 0);
+    }
+    writer->counts[section]++;
+    return offset;
+}
 
-    vec_init(&level->materials, "level");
-    vec_init(&level->lightmap_images, "level");
-    vec_init(&level->entities, "level");
+static void _level_bin_write_geo(_level_bin_writer_t *writer, golf_geo_t *geo, const char *script_path) {
+    _level_bin_geo_t bin_geo;
+    memset(&bin_geo, 0, sizeof(bin_geo));
+    bin_geo.is_water = geo->is_water;
+
+    vec_vec3_t points;
+    vec_init(&points, "level");
+    for (int i = 0; i < geo->points.length; i++) {
+        vec_push(&points, geo->points.data[i].position);
+    }
+    bin_geo.num_points = points.length;
+    bin_geo.points_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, points.data, sizeof(vec3) * points.length);
+    vec_deinit(&points);
+
+    bin_geo.first_face = writer->counts[LEVEL_BIN_GEO_FACES];
+    bin_geo.num_faces = geo->faces.length;
+    for (int i = 0; i < geo->faces.length; i++) {
+        golf_geo_face_t *face = &geo->faces.data[i];
+        _level_bin_geo_face_t bin_face;
+        memset(&bin_face, 0, sizeof(bin_face));
+        snprintf(bin_face.material_name, GOLF_MAX_NAME_LEN, "%s", face->material_name);
+        bin_face.uv_gen_type = face->uv_gen_type;
+        bin_face.num_idx = face->idx.length;
+        bin_face.idx_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, face->idx.data, sizeof(int) * face->idx.length);
+        bin_face.uvs_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, face->uvs.data, sizeof(vec2) * face->uvs.length);
+        bin_face.start_vertex_in_model = face->start_vertex_in_model;
+        bin_face.water_dir = face->water_dir;
+        _level_bin_push(writer, LEVEL_BIN_GEO_FACES, &bin_face, sizeof(bin_face));
+    }
+
+    snprintf(bin_geo.script_path, GOLF_FILE_MAX_PATH, "%s", script_path ? script_path : "");
+    bin_geo.first_arg = writer->counts[LEVEL_BIN_GEO_ARGS];
+    bin_geo.num_args = geo->generator_data.args.length;
+    for (int i = 0; i < geo->generator_data.args.length; i++) {
+        golf_geo_generator_data_arg_t *arg = &geo->generator_data.args.data[i];
+        _level_bin_geo_arg_t bin_arg;
+        memset(&bin_arg, 0, sizeof(bin_arg));
+        snprintf(bin_arg.name, GOLF_MAX_NAME_LEN, "%s", arg->name);
+        bin_arg.type = arg->val.type;
+        switch (arg->val.type) {
+            case GS_VAL_BOOL:
+                bin_arg.int_val = arg->val.bool_val;
+                break;
+            case GS_VAL_INT:
+                bin_arg.int_val = arg->val.int_val;
+                break;
+            case GS_VAL_FLOAT:
+                bin_arg.val.x = arg->val.float_val;
+                break;
+            case GS_VAL_VEC2:
+                bin_arg.val = V3(arg->val.vec2_val.x, arg->val.vec2_val.y, 0);
+                break;
+            case GS_VAL_VEC3:
+                bin_arg.val = arg->val.vec3_val;
+                break;
+            default:
+                break;
+        }
+        _level_bin_push(writer, LEVEL_BIN_GEO_ARGS, &bin_arg, sizeof(bin_arg));
+    }
 
-    JSON_Value *json_val = json_parse_string(data);
+    golf_model_t *model = &geo->model;
+    bin_geo.first_group = writer->counts[LEVEL_BIN_MODEL_GROUPS];
+    bin_geo.num_groups = model->groups.length;
+    for (int i = 0; i < model->groups.length; i++) {
+        golf_model_group_t *group = &model->groups.data[i];
+        _level_bin_model_group_t bin_group;
+        memset(&bin_group, 0, sizeof(bin_group));
+        snprintf(bin_group.material_name, GOLF_MAX_NAME_LEN, "%s", group->material_name);
+        bin_group.start_vertex = group->start_vertex;
+        bin_group.vertex_count = group->vertex_count;
+        _level_bin_push(writer, LEVEL_BIN_MODEL_GROUPS, &bin_group, sizeof(bin_group));
+    }
+
+    bin_geo.num_vertices = model->positions.length;
+    bin_geo.positions_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, model->positions.data, sizeof(vec3) * model->positions.length);
+    bin_geo.normals_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, model->normals.data, sizeof(vec3) * model->normals.length);
+    bin_geo.texcoords_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, model->texcoords.data, sizeof(vec2) * model->texcoords.length);
+    if (geo->is_water) {
+        bin_geo.water_dir_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, model->water_dir.data, sizeof(vec3) * model->water_dir.length);
+    }
+
+    _level_bin_push(writer, LEVEL_BIN_GEOS, &bin_geo, sizeof(bin_geo));
+}
+
+static void _level_bin_write_lightmap_section(_level_bin_writer_t *writer, golf_lightmap_section_t *section, _level_bin_entity_t *bin_entity) {
+    snprintf(bin_entity->lightmap_name, GOLF_MAX_NAME_LEN, "%s", section->lightmap_name);
+    bin_entity->lightmap_num_uvs = section->uvs.length;
+    bin_entity->lightmap_uvs_offset = _level_bin_push(writer, LEVEL_BIN_BLOB, section->uvs.data, sizeof(vec2) * section->uvs.length);
+}
+
+static void _level_bin_write_movement(golf_movement_t *movement, _level_bin_movement_t *bin_movement) {
+    bin_movement->type = movement->type;
+    bin_movement->repeats = movement->repeats;
+    bin_movement->t0 = movement->t0;
+    bin_movement->length = movement->length;
+    switch (movement->type) {
+        case GOLF_MOVEMENT_NONE:
+        case GOLF_MOVEMENT_SPINNER:
+            break;
+        case GOLF_MOVEMENT_LINEAR:
+            bin_movement->p0 = movement->linear.p0;
+            bin_movement->p1 = movement->linear.p1;
+            break;
+        case GOLF_MOVEMENT_PENDULUM:
+            bin_movement->theta0 = movement->pendulum.theta0;
+            bin_movement->axis = movement->pendulum.axis;
+            break;
+        case GOLF_MOVEMENT_RAMP:
+            bin_movement->theta0 = movement->ramp.theta0;
+            bin_movement->theta1 = movement->ramp.theta1;
+            bin_movement->transition_length = movement->ramp.transition_length;
+            bin_movement->axis = movement->ramp.axis;
+            break;
+    }
+}
+
+static golf_movement_t _level_bin_read_movement(const _level_bin_movement_t *bin_movement) {
+    golf_movement_t movement;
+    switch ((golf_movement_type_t)bin_movement->type) {
+        case GOLF_MOVEMENT_LINEAR:
+            movement = golf_movement_linear(bin_movement->t0, bin_movement->p0, bin_movement->p1, bin_movement->length);
+            break;
+        case GOLF_MOVEMENT_SPINNER:
+            movement = golf_movement_spinner(bin_movement->t0, bin_movement->length);
+            break;
+        case GOLF_MOVEMENT_PENDULUM:
+            movement = golf_movement_pendulum(bin_movement->t0, bin_movement->length, bin_movement->theta0, bin_movement->axis);
+            break;
+        case GOLF_MOVEMENT_RAMP:
+            movement = golf_movement_ramp(bin_movement->t0, bin_movement->length, bin_movement->theta0, bin_movement->theta1, bin_movement->transition_length, bin_movement->axis);
+            break;
+        case GOLF_MOVEMENT_NONE:
+        default:
+            movement = golf_movement_none();
+            break;
+    }
+    movement.repeats = bin_movement->repeats;
+    return movement;
+}
+
+static void _level_bin_write_bvh(_level_bin_writer_t *writer, golf_model_t *model) {
+    if (model->positions.length == 0) {
+        return;
+    }
+
+    uint32_t hash = golf_blas_hash(&writer->bvh_level, model);
+    for (int i = 0; i < writer->bvh_hashes.length; i++) {
+        if ((uint32_t)writer->bvh_hashes.data[i] == hash) {
+            return;
+        }
+    }
+    vec_push(&writer->bvh_hashes, (int)hash);
+
+    golf_blas_t blas;
+    golf_blas_construct(&blas, &writer->bvh_level, model);
+    vec_char_t data;
+    vec_init(&data, "level");
+    golf_blas_serialize(&blas, &data);
+    golf_bvh_deinit(&blas.bvh);
+
+    _level_bin_bvh_t bin_bvh;
+    bin_bvh.hash = hash;
+    bin_bvh.size = data.length;
+    bin_bvh.offset = _level_bin_push(writer, LEVEL_BIN_BLOB, data.data, data.length);
+    _level_bin_push(writer, LEVEL_BIN_BVHS, &bin_bvh, sizeof(bin_bvh));
+    vec_deinit(&data);
+}
+
+// The models are loaded straight from the file since importing can't wait on the data thread
+static void _level_bin_write_model_bvh(_level_bin_writer_t *writer, const char *model_path) {
+    if (map_get(&writer->bvh_model_paths, model_path)) {
+        return;
+    }
+    map_set(&writer->bvh_model_paths, model_path, 1);
+
+    golf_file_view_t view;
+    if (!golf_file_view_open(&view, model_path)) {
+        golf_log_warning("Unable to load %s to build its BVH", model_path);
+        return;
+    }
+
+    golf_model_t model;
+    memset(&model, 0, sizeof(model));
+    if (_golf_model_load(&model, model_path, view.data, view.data_len, NULL, 0)) {
+        _level_bin_write_bvh(writer, &model);
+    }
+    vec_deinit(&model.groups);
+    vec_deinit(&model.positions);
+    vec_deinit(&model.normals);
+    vec_deinit(&model.texcoords);
+    golf_file_view_close(&view);
+}
+
+static void _golf_level_geo_deinit(golf_geo_t *geo) {
+    for (int i = 0; i < geo->faces.length; i++) {
+        golf_geo_face_t *face = &geo->faces.data[i];
+        vec_deinit(&face->idx);
+        vec_deinit(&face->uvs);
+    }
+
+    vec_deinit(&geo->points);
+    vec_deinit(&geo->faces);
+    vec_deinit(&geo->generator_data.args);
+
+    vec_deinit(&geo->model.groups);
+    vec_deinit(&geo->model.positions);
+    vec_deinit(&geo->model.normals);
+    vec_deinit(&geo->model.texcoords);
+    if (geo->model.is_water) {
+        vec_deinit(&geo->model.water_dir);
+    }
+}
+
+// Converts the JSON the editor saves into the binary format. Nothing here looks
+// up other data files, so it can run before any of the level's dependencies are
+// loaded or when importing outside the game.
+static bool _golf_level_json_to_bin(const char *path, const char *json, vec_char_t *bin) {
+    JSON_Value *json_val = json_parse_string(json);
     JSON_Object *json_obj = json_value_get_object(json_val);
+    if (!json_obj) {
+        golf_log_warning("Unable to parse level %s", path);
+        json_value_free(json_val);
+        return false;
+    }
 
     JSON_Array *json_materials_arr = json_object_get_array(json_obj, "materials");
     JSON_Array *json_lightmap_images_arr = json_object_get_array(json_obj, "lightmap_images");
     JSON_Array *json_entities_arr = json_object_get_array(json_obj, "entities");
 
-    // load dependencies
-    {
-        vec_init(&level->deps, "level");
-        _golf_data_add_dependency(&level->deps, golf_file("data/textures/hole_lightmap.png"));
-        _golf_data_add_dependency(&level->deps, golf_file("data/models/hole.obj"));
-        _golf_data_add_dependency(&level->deps, golf_file("data/models/hole-cover.obj"));
-        _golf_data_add_dependency(&level->deps, golf_file("data/models/sphere.obj"));
-        for (int i = 0; i < (int)json_array_get_count(json_materials_arr); i++) {
-            JSON_Object *obj = json_array_get_object(json_materials_arr, i);
-            const char *type = json_object_get_string(obj, "type");
-            if (type && strcmp(type, "texture") == 0) {
-                const char *texture = json_object_get_string(obj, "texture");
-                if (texture) _golf_data_add_dependency(&level->deps, golf_file(texture));
-            }
-            else if (type && strcmp(type, "environment") == 0) {
-                const char *texture = json_object_get_string(obj, "texture");
-                if (texture) _golf_data_add_dependency(&level->deps, golf_file(texture));
-            }
-        }
-        for (int i = 0; i < (int)json_array_get_count(json_entities_arr); i++) {
-            JSON_Object *obj = json_array_get_object(json_entities_arr, i);
-            const char *type = json_object_get_string(obj, "type");
-            if (type && strcmp(type, "model") == 0) {
-                const char *model = json_object_get_string(obj, "model");
-                if (model) _golf_data_add_dependency(&level->deps, golf_file(model));
-            }
-        }
-        for (int i = 0; i < level->deps.length; i++) {
-            _golf_data_thread_load_file(level->deps.data[i]);
-            while (golf_data_get_load_state(level->deps.data[i].path) != GOLF_DATA_LOADED) 
-                golf_thread_timer_wait(&_data_thread_timer, 10000000);
-        }
+    _level_bin_writer_t writer;
+    for (int i = 0; i < LEVEL_BIN_NUM_SECTIONS; i++) {
+        vec_init(&writer.sections[i], "level");
+        writer.counts[i] = 0;
     }
+    memset(&writer.bvh_level, 0, sizeof(writer.bvh_level));
+    vec_init(&writer.bvh_level.materials, "level");
+    vec_init(&writer.bvh_hashes, "level");
+    map_init(&writer.bvh_model_paths, "level");
 
     for (int i = 0; i < (int)json_array_get_count(json_materials_arr); i++) {
         JSON_Object *obj = json_array_get_object(json_materials_arr, i);
         const char *type = json_object_get_string(obj, "type");
         const char *name = json_object_get_string(obj, "name");
-        float friction = (float)json_object_get_number(obj, "friction");
-        float restitution = (float)json_object_get_number(obj, "restitution");
-        float vel_scale = (float)json_object_get_number(obj, "vel_scale");
 
-        bool valid_material = false;
-        golf_material_t material;
+        _level_bin_material_t bin_material;
+        memset(&bin_material, 0, sizeof(bin_material));
+        snprintf(bin_material.name, GOLF_MAX_NAME_LEN, "%s", name ? name : "");
+        bin_material.friction = (float)json_object_get_number(obj, "friction");
+        bin_material.restitution = (float)json_object_get_number(obj, "restitution");
+        bin_material.vel_scale = (float)json_object_get_number(obj, "vel_scale");
+
+        bool valid_material = true;
         if (type && strcmp(type, "texture") == 0) {
-            const char *texture_path = json_object_get_string(obj, "texture");
-            material = golf_material_texture(name, friction, restitution, vel_scale, texture_path);
-            valid_material = true;
+            bin_material.type = GOLF_MATERIAL_TEXTURE;
         }
         else if (type && strcmp(type, "color") == 0) {
-            vec4 color = golf_json_object_get_vec4(obj, "color");
-            material = golf_material_color(name, friction, restitution, vel_scale, color);
-            valid_material = true;
+            bin_material.type = GOLF_MATERIAL_COLOR;
         }
         else if (type && strcmp(type, "diffuse_color") == 0) {
-            vec4 color = golf_json_object_get_vec4(obj, "color");
-            material = golf_material_diffuse_color(name, friction, restitution, vel_scale, color);
-            valid_material = true;
+            bin_material.type = GOLF_MATERIAL_DIFFUSE_COLOR;
         }
         else if (type && strcmp(type, "environment") == 0) {
+            bin_material.type = GOLF_MATERIAL_ENVIRONMENT;
+        }
+        else {
+            valid_material = false;
+        }
+
+        if (bin_material.type == GOLF_MATERIAL_TEXTURE || bin_material.type == GOLF_MATERIAL_ENVIRONMENT) {
             const char *texture_path = json_object_get_string(obj, "texture");
-            material = golf_material_environment(name, friction, restitution, vel_scale, texture_path);
-            valid_material = true;
+            snprintf(bin_material.texture_path, GOLF_FILE_MAX_PATH, "%s", texture_path ? texture_path : "");
+        }
+        else {
+            bin_material.color = golf_json_object_get_vec4(obj, "color");
         }
 
         if (valid_material) {
-            vec_push(&level->materials, material);
+            _level_bin_push(&writer, LEVEL_BIN_MATERIALS, &bin_material, sizeof(bin_material));
+
+            golf_material_t material;
+            memset(&material, 0, sizeof(material));
+            material.active = true;
+            snprintf(material.name, GOLF_MAX_NAME_LEN, "%s", bin_material.name);
+            material.friction = bin_material.friction;
+            material.restitution = bin_material.restitution;
+            material.vel_scale = bin_material.vel_scale;
+            material.type = (golf_material_type_t)bin_material.type;
+            vec_push(&writer.bvh_level.materials, material);
         }
         else {
             golf_log_warning("Invalid material. type: %s, name: %s", type, name);
@@ -2748,141 +3413,590 @@ static bool _golf_level_load(void *ptr, const char *path, char *data, int data_l
     for (int i = 0; i < (int)json_array_get_count(json_lightmap_images_arr); i++) {
         JSON_Object *obj = json_array_get_object(json_lightmap_images_arr, i);
         const char *name = json_object_get_string(obj, "name");
-        int resolution = (int)json_object_get_number(obj, "resolution");
-        float time_length = (float)json_object_get_number(obj, "time_length");
-        bool repeats = (bool)json_object_get_boolean(obj, "repeats");
 
-        int width, height, c;
+        _level_bin_lightmap_t bin_lightmap;
+        memset(&bin_lightmap, 0, sizeof(bin_lightmap));
+        snprintf(bin_lightmap.name, GOLF_MAX_NAME_LEN, "%s", name ? name : "");
+        bin_lightmap.resolution = (int)json_object_get_number(obj, "resolution");
+        bin_lightmap.time_length = (float)json_object_get_number(obj, "time_length");
+        bin_lightmap.repeats = (bool)json_object_get_boolean(obj, "repeats");
+        bin_lightmap.first_sample = writer.counts[LEVEL_BIN_LIGHTMAP_SAMPLES];
+
         JSON_Array *datas_arr = json_object_get_array(obj, "datas");
         int num_samples = (int)json_array_get_count(datas_arr);
-        unsigned char **image_datas = golf_alloc(sizeof(unsigned char*) * num_samples);
-        for (int i = 0; i < num_samples; i++) {
+        for (int s = 0; s < num_samples; s++) {
             unsigned char *data;
             int data_len;
-            golf_json_array_get_data(datas_arr, i, &data, &data_len);
+            golf_json_array_get_data(datas_arr, s, &data, &data_len);
+            int width, height, c;
             unsigned char *image_data = stbi_load_from_memory(data, data_len, &width, &height, &c, 1);
-            image_datas[i] = image_data;
             golf_free(data);
-        }
+            if (!image_data) {
+                golf_log_warning("Unable to decode lightmap %s in level %s", name, path);
+                continue;
+            }
 
-        sg_image *sg_images = golf_alloc(sizeof(sg_image) * num_samples);
+            bin_lightmap.width = width;
+            bin_lightmap.height = height;
+            mz_ulong size = mz_compressBound((mz_ulong)(width * height));
+            unsigned char *compressed = golf_alloc(size);
+            if (mz_compress(compressed, &size, image_data, (mz_ulong)(width * height)) == MZ_OK) {
+                _level_bin_lightmap_sample_t sample;
+                sample.size = (uint32_t)size;
+                sample.offset = _level_bin_push(&writer, LEVEL_BIN_BLOB, compressed, (int)size);
+                _level_bin_push(&writer, LEVEL_BIN_LIGHTMAP_SAMPLES, &sample, sizeof(sample));
+                bin_lightmap.num_samples++;
+            }
+            golf_free(compressed);
+            stbi_image_free(image_data);
+        }
 
-        vec_push(&level->lightmap_images, golf_lightmap_image(name, resolution, width, height, time_length, repeats, num_samples, image_datas, sg_images));
+        _level_bin_push(&writer, LEVEL_BIN_LIGHTMAPS, &bin_lightmap, sizeof(bin_lightmap));
     }
 
     for (int i = 0; i < (int)json_array_get_count(json_entities_arr); i++) {
         JSON_Object *obj = json_array_get_object(json_entities_arr, i);
         const char *type = json_object_get_string(obj, "type");
         const char *name = json_object_get_string(obj, "name");
-        int parent_idx = (int)json_object_get_number(obj, "parent_idx");
 
-        bool valid_entity = false;
-        golf_entity_t entity;  
-        entity.active = true;  
-        if (type && strcmp(type, "model") == 0) {
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
+        _level_bin_entity_t bin_entity;
+        memset(&bin_entity, 0, sizeof(bin_entity));
+        snprintf(bin_entity.name, GOLF_MAX_NAME_LEN, "%s", name ? name : "");
+        bin_entity.parent_idx = (int)json_object_get_number(obj, "parent_idx");
+        bin_entity.geo_idx = -1;
+        _golf_json_object_get_transform(obj, "transform", &bin_entity.transform);
 
+        bool valid_entity = true;
+        bool has_movement = false, has_lightmap_section = false, has_geo = false, is_water = false;
+        if (type && strcmp(type, "model") == 0) {
+            bin_entity.type = MODEL_ENTITY;
             const char *model_path = json_object_get_string(obj, "model");
-
-            float uv_scale = (float)json_object_get_number(obj, "uv_scale");
-
-            golf_lightmap_section_t lightmap_section;
-            _golf_json_object_get_lightmap_section(obj, "lightmap_section", &lightmap_section);
-
-            int ignore_physics = json_object_get_boolean(obj, "ignore_physics");
-            if (ignore_physics == -1) ignore_physics = 0;
-
-            golf_movement_t movement;
-            _golf_json_object_get_movement(obj, "movement", &movement);
-
-            entity = golf_entity_model(name, transform, model_path, uv_scale, lightmap_section, movement, (bool)ignore_physics);
-            valid_entity = true;
+            snprintf(bin_entity.model_path, GOLF_FILE_MAX_PATH, "%s", model_path ? model_path : "");
+            bin_entity.uv_scale = (float)json_object_get_number(obj, "uv_scale");
+            bin_entity.ignore_physics = json_object_get_boolean(obj, "ignore_physics") == 1;
+            has_movement = true;
+            has_lightmap_section = true;
         }
         else if (type && strcmp(type, "ball-start") == 0) {
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
-
-            entity = golf_entity_ball_start(name, transform);
-            valid_entity = true;
+            bin_entity.type = BALL_START_ENTITY;
         }
         else if (type && strcmp(type, "hole") == 0) {
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
-
-            entity = golf_entity_hole(name, transform);
-            valid_entity = true;
+            bin_entity.type = HOLE_ENTITY;
         }
         else if (type && strcmp(type, "geo") == 0) {
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
+            bin_entity.type = GEO_ENTITY;
+            has_movement = true;
+            has_lightmap_section = true;
+            has_geo = true;
+        }
+        else if (type && strcmp(type, "group") == 0) {
+            bin_entity.type = GROUP_ENTITY;
+        }
+        else if (type && strcmp(type, "water") == 0) {
+            bin_entity.type = WATER_ENTITY;
+            has_lightmap_section = true;
+            has_geo = true;
+            is_water = true;
+        }
+        else if (type && strcmp(type, "begin_animation") == 0) {
+            bin_entity.type = BEGIN_ANIMATION_ENTITY;
+        }
+        else if (type && strcmp(type, "camera_zone") == 0) {
+            bin_entity.type = CAMERA_ZONE_ENTITY;
+            bin_entity.towards_hole = (bool)json_object_get_boolean(obj, "towards_hole");
+        }
+        else {
+            valid_entity = false;
+        }
+
+        if (!valid_entity) {
+            golf_log_warning("Invalid entity. type: %s, name: %s", type, name);
+            continue;
+        }
 
+        bool is_moving = false;
+        if (has_movement) {
             golf_movement_t movement;
             _golf_json_object_get_movement(obj, "movement", &movement);
+            _level_bin_write_movement(&movement, &bin_entity.movement);
+            is_moving = movement.type != GOLF_MOVEMENT_NONE;
+        }
 
-            golf_geo_t geo;
-            _golf_json_object_get_geo(obj, "geo", &geo, false);
+        // Same entities that golf_sim_start_level puts in the physics
+        if (bin_entity.type == MODEL_ENTITY && bin_entity.model_path[0] && (is_moving || !bin_entity.ignore_physics)) {
+            _level_bin_write_model_bvh(&writer, bin_entity.model_path);
+        }
 
+        if (has_lightmap_section) {
             golf_lightmap_section_t lightmap_section;
             _golf_json_object_get_lightmap_section(obj, "lightmap_section", &lightmap_section);
+            _level_bin_write_lightmap_section(&writer, &lightmap_section, &bin_entity);
+            vec_deinit(&lightmap_section.uvs);
+        }
 
-            entity = golf_entity_geo(name, transform, movement, geo, lightmap_section);
-            valid_entity = true;
+        if (has_geo) {
+            // The model is generated here once instead of every time the level loads
+            golf_geo_t geo;
+            _golf_json_object_get_geo(obj, "geo", &geo, is_water);
+            JSON_Object *generator_data_obj = json_object_get_object(json_object_get_object(obj, "geo"), "generator_data");
+            const char *script_path = json_object_get_string(generator_data_obj, "script");
+            bin_entity.geo_idx = writer.counts[LEVEL_BIN_GEOS];
+            _level_bin_write_geo(&writer, &geo, script_path);
+            _level_bin_write_bvh(&writer, &geo.model);
+            _golf_level_geo_deinit(&geo);
         }
-        else if (type && strcmp(type, "group") == 0) {
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
 
-            entity = golf_entity_group(name, transform);
+        _level_bin_push(&writer, LEVEL_BIN_ENTITIES, &bin_entity, sizeof(bin_entity));
+    }
+
+    json_value_free(json_val);
+    vec_deinit(&writer.bvh_level.materials);
+    vec_deinit(&writer.bvh_hashes);
+    map_deinit(&writer.bvh_model_paths);
+
+    _level_bin_header_t header;
+    memcpy(header.magic, LEVEL_BIN_MAGIC, 4);
+    header.version = LEVEL_BIN_VERSION;
+    header.num_sections = LEVEL_BIN_NUM_SECTIONS;
+    header.reserved = 0;
+
+    bin->length = 0;
+    vec_pusharr(bin, (char*)&header, sizeof(header));
+    uint32_t offset = sizeof(_level_bin_header_t) + LEVEL_BIN_NUM_SECTIONS * sizeof(_level_bin_section_t);
+    for (int i = 0; i < LEVEL_BIN_NUM_SECTIONS; i++) {
+        _level_bin_section_t section;
+        section.type = i;
+        section.offset = offset;
+        section.size = writer.sections[i].length;
+        section.count = writer.counts[i];
+        vec_pusharr(bin, (char*)&section, sizeof(section));
+        offset += section.size;
+    }
+    for (int i = 0; i < LEVEL_BIN_NUM_SECTIONS; i++) {
+        vec_pusharr(bin, writer.sections[i].data, writer.sections[i].length);
+        vec_deinit(&writer.sections[i]);
+    }
+    return true;
+}
+
+static bool _level_bin_is_bin(const char *data, int data_len) {
+    return data_len >= (int)sizeof(_level_bin_header_t) && memcmp(data, LEVEL_BIN_MAGIC, 4) == 0;
+}
+
+static bool _level_bin_reader_init(_level_bin_reader_t *reader, const char *path, const char *data, int data_len) {
+    memset(reader, 0, sizeof(_level_bin_reader_t));
+
+    _level_bin_header_t header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != LEVEL_BIN_VERSION) {
+        golf_log_warning("Level %s has version %u, expected %u", path, header.version, LEVEL_BIN_VERSION);
+        return false;
+    }
+
+    int64_t table_end = (int64_t)sizeof(header) + (int64_t)header.num_sections * sizeof(_level_bin_section_t);
+    if (table_end > data_len) {
+        golf_log_warning("Level %s is truncated", path);
+        return false;
+    }
 
-            valid_entity = true;
+    const _level_bin_section_t *sections = (const _level_bin_section_t*)(data + sizeof(header));
+    for (uint32_t i = 0; i < header.num_sections; i++) {
+        const _level_bin_section_t *section = &sections[i];
+        if (section->type >= LEVEL_BIN_NUM_SECTIONS) {
+            continue;
         }
-        else if (type && strcmp(type, "water") == 0) {
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
+        if ((int64_t)section->offset + section->size > data_len || section->offset % 4 != 0 ||
+                (section->type != LEVEL_BIN_BLOB && (int64_t)section->count * _level_bin_record_size[section->type] > section->size)) {
+            golf_log_warning("Level %s has an invalid section %u", path, section->type);
+            return false;
+        }
+        reader->sections[section->type] = data + section->offset;
+        reader->counts[section->type] = section->count;
+        if (section->type == LEVEL_BIN_BLOB) {
+            reader->blob_size = section->size;
+        }
+    }
+    return true;
+}
 
-            golf_geo_t geo;
-            _golf_json_object_get_geo(obj, "geo", &geo, true);
+// Returns NULL if the range isn't inside the blob
+static const void *_level_bin_reader_get_blob(_level_bin_reader_t *reader, uint32_t offset, int64_t size) {
+    if (size < 0 || (int64_t)offset + size > reader->blob_size) {
+        return NULL;
+    }
+    return reader->sections[LEVEL_BIN_BLOB] + offset;
+}
 
-            golf_lightmap_section_t lightmap_section;
-            _golf_json_object_get_lightmap_section(obj, "lightmap_section", &lightmap_section);
+static bool _level_bin_reader_has_range(_level_bin_reader_t *reader, _level_bin_section_type_t section, uint32_t first, uint32_t count) {
+    return (int64_t)first + count <= reader->counts[section];
+}
 
-            entity = golf_entity_water(name, transform, geo, lightmap_section);
+static bool _level_bin_read_lightmap_section(_level_bin_reader_t *reader, const _level_bin_entity_t *bin_entity, golf_lightmap_section_t *section) {
+    const vec2 *uvs_data = _level_bin_reader_get_blob(reader, bin_entity->lightmap_uvs_offset, (int64_t)sizeof(vec2) * bin_entity->lightmap_num_uvs);
+    if (!uvs_data) {
+        return false;
+    }
 
-            valid_entity = true;
+    vec_vec2_t uvs;
+    vec_init(&uvs, "level");
+    vec_pusharr(&uvs, uvs_data, bin_entity->lightmap_num_uvs);
+    *section = golf_lightmap_section(bin_entity->lightmap_name, uvs);
+    return true;
+}
+
+static bool _level_bin_read_geo(_level_bin_reader_t *reader, int geo_idx, uint32_t num_lightmap_uvs, golf_geo_t *geo) {
+    if (geo_idx < 0 || geo_idx >= reader->counts[LEVEL_BIN_GEOS]) {
+        return false;
+    }
+    const _level_bin_geo_t *bin_geo = (const _level_bin_geo_t*)reader->sections[LEVEL_BIN_GEOS] + geo_idx;
+    const vec3 *points_data = _level_bin_reader_get_blob(reader, bin_geo->points_offset, (int64_t)sizeof(vec3) * bin_geo->num_points);
+    const vec3 *positions_data = _level_bin_reader_get_blob(reader, bin_geo->positions_offset, (int64_t)sizeof(vec3) * bin_geo->num_vertices);
+    const vec3 *normals_data = _level_bin_reader_get_blob(reader, bin_geo->normals_offset, (int64_t)sizeof(vec3) * bin_geo->num_vertices);
+    const vec2 *texcoords_data = _level_bin_reader_get_blob(reader, bin_geo->texcoords_offset, (int64_t)sizeof(vec2) * bin_geo->num_vertices);
+    const vec3 *water_dir_data = NULL;
+    if (bin_geo->is_water) {
+        water_dir_data = _level_bin_reader_get_blob(reader, bin_geo->water_dir_offset, (int64_t)sizeof(vec3) * bin_geo->num_vertices);
+    }
+    if (!points_data || !positions_data || !normals_data || !texcoords_data || (bin_geo->is_water && !water_dir_data) ||
+            !_level_bin_reader_has_range(reader, LEVEL_BIN_GEO_FACES, bin_geo->first_face, bin_geo->num_faces) ||
+            !_level_bin_reader_has_range(reader, LEVEL_BIN_GEO_ARGS, bin_geo->first_arg, bin_geo->num_args) ||
+            !_level_bin_reader_has_range(reader, LEVEL_BIN_MODEL_GROUPS, bin_geo->first_group, bin_geo->num_groups)) {
+        return false;
+    }
+
+    // The lightmap has a uv for every vertex of the generated model
+    if (num_lightmap_uvs != bin_geo->num_vertices) {
+        return false;
+    }
+
+    const _level_bin_model_group_t *bin_groups = (const _level_bin_model_group_t*)reader->sections[LEVEL_BIN_MODEL_GROUPS] + bin_geo->first_group;
+    for (uint32_t i = 0; i < bin_geo->num_groups; i++) {
+        const _level_bin_model_group_t *bin_group = &bin_groups[i];
+        if (bin_group->start_vertex < 0 || bin_group->vertex_count < 0 ||
+                (int64_t)bin_group->start_vertex + bin_group->vertex_count > bin_geo->num_vertices) {
+            return false;
         }
-        else if (type && strcmp(type, "begin_animation") == 0) {
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
+    }
 
-            entity = golf_entity_begin_animation(name, transform);
+    const _level_bin_geo_face_t *bin_faces = (const _level_bin_geo_face_t*)reader->sections[LEVEL_BIN_GEO_FACES] + bin_geo->first_face;
+    for (uint32_t i = 0; i < bin_geo->num_faces; i++) {
+        const _level_bin_geo_face_t *bin_face = &bin_faces[i];
+        const int *idx_data = _level_bin_reader_get_blob(reader, bin_face->idx_offset, (int64_t)sizeof(int) * bin_face->num_idx);
+        if (!idx_data ||
+                !_level_bin_reader_get_blob(reader, bin_face->uvs_offset, (int64_t)sizeof(vec2) * bin_face->num_idx)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < bin_face->num_idx; j++) {
+            if (idx_data[j] < 0 || (uint32_t)idx_data[j] >= bin_geo->num_points) {
+                return false;
+            }
+        }
+    }
+
+    vec_init(&geo->points, "geo");
+    for (uint32_t i = 0; i < bin_geo->num_points; i++) {
+        vec_push(&geo->points, golf_geo_point(points_data[i]));
+    }
+
+    vec_init(&geo->faces, "geo");
+    for (uint32_t i = 0; i < bin_geo->num_faces; i++) {
+        const _level_bin_geo_face_t *bin_face = &bin_faces[i];
+        vec_int_t idx;
+        vec_init(&idx, "geo");
+        vec_pusharr(&idx, (const int*)_level_bin_reader_get_blob(reader, bin_face->idx_offset, 0), bin_face->num_idx);
+        vec_vec2_t uvs;
+        vec_init(&uvs, "geo");
+        vec_pusharr(&uvs, (const vec2*)_level_bin_reader_get_blob(reader, bin_face->uvs_offset, 0), bin_face->num_idx);
+
+        golf_geo_face_t face = golf_geo_face(bin_face->material_name, idx, (golf_geo_face_uv_gen_type_t)bin_face->uv_gen_type, uvs, bin_face->water_dir);
+        face.start_vertex_in_model = bin_face->start_vertex_in_model;
+        vec_push(&geo->faces, face);
+    }
 
-            valid_entity = true;
+    // The game doesn't load the scripts, only the editor so check if it's loaded or not first
+    golf_script_t *script = NULL;
+    if (bin_geo->script_path[0] && golf_data_get_load_state(bin_geo->script_path) == GOLF_DATA_LOADED) {
+        script = golf_data_get_script(bin_geo->script_path);
+    }
+    vec_golf_geo_generator_data_arg_t args;
+    vec_init(&args, "geo");
+    const _level_bin_geo_arg_t *bin_args = (const _level_bin_geo_arg_t*)reader->sections[LEVEL_BIN_GEO_ARGS] + bin_geo->first_arg;
+    for (uint32_t i = 0; i < bin_geo->num_args; i++) {
+        const _level_bin_geo_arg_t *bin_arg = &bin_args[i];
+        golf_geo_generator_data_arg_t arg;
+        snprintf(arg.name, GOLF_MAX_NAME_LEN, "%s", bin_arg->name);
+        switch ((gs_val_type)bin_arg->type) {
+            case GS_VAL_BOOL:
+                arg.val = gs_val_bool(bin_arg->int_val != 0);
+                break;
+            case GS_VAL_INT:
+                arg.val = gs_val_int(bin_arg->int_val);
+                break;
+            case GS_VAL_FLOAT:
+                arg.val = gs_val_float(bin_arg->val.x);
+                break;
+            case GS_VAL_VEC2:
+                arg.val = gs_val_vec2(V2(bin_arg->val.x, bin_arg->val.y));
+                break;
+            case GS_VAL_VEC3:
+                arg.val = gs_val_vec3(bin_arg->val);
+                break;
+            default:
+                golf_log_warning("Invalid type for generator data argument: %s", bin_arg->name);
+                continue;
         }
-        else if (type && strcmp(type, "camera_zone") == 0) {
-            bool towards_hole = (bool)json_object_get_boolean(obj, "towards_hole");
+        vec_push(&args, arg);
+    }
+    geo->generator_data = golf_geo_generator_data(script, args);
+
+    vec_golf_group_t groups;
+    vec_init(&groups, "geo");
+    for (uint32_t i = 0; i < bin_geo->num_groups; i++) {
+        vec_push(&groups, golf_model_group(bin_groups[i].material_name, bin_groups[i].start_vertex, bin_groups[i].vertex_count));
+    }
+    vec_vec3_t positions;
+    vec_init(&positions, "positions");
+    vec_pusharr(&positions, positions_data, bin_geo->num_vertices);
+    vec_vec3_t normals;
+    vec_init(&normals, "normals");
+    vec_pusharr(&normals, normals_data, bin_geo->num_vertices);
+    vec_vec2_t texcoords;
+    vec_init(&texcoords, "texcoords");
+    vec_pusharr(&texcoords, texcoords_data, bin_geo->num_vertices);
+
+    geo->is_water = bin_geo->is_water;
+    geo->model_updated_this_frame = false;
+    if (bin_geo->is_water) {
+        vec_vec3_t water_dir;
+        vec_init(&water_dir, "water_dir");
+        vec_pusharr(&water_dir, water_dir_data, bin_geo->num_vertices);
+        geo->model = golf_model_dynamic_water(groups, positions, normals, texcoords, water_dir);
+    }
+    else {
+        geo->model = golf_model_dynamic(groups, positions, normals, texcoords);
+    }
+    return true;
+}
 
-            golf_transform_t transform;
-            _golf_json_object_get_transform(obj, "transform", &transform);
+static bool _golf_level_load_bin(golf_level_t *level, const char *path, const char *data, int data_len) {
+    _level_bin_reader_t reader;
+    if (!_level_bin_reader_init(&reader, path, data, data_len)) {
+        return false;
+    }
 
-            entity = golf_entity_camera_zone(name, towards_hole, transform);
+    const _level_bin_material_t *bin_materials = (const _level_bin_material_t*)reader.sections[LEVEL_BIN_MATERIALS];
+    const _level_bin_lightmap_t *bin_lightmaps = (const _level_bin_lightmap_t*)reader.sections[LEVEL_BIN_LIGHTMAPS];
+    const _level_bin_lightmap_sample_t *bin_samples = (const _level_bin_lightmap_sample_t*)reader.sections[LEVEL_BIN_LIGHTMAP_SAMPLES];
+    const _level_bin_entity_t *bin_entities = (const _level_bin_entity_t*)reader.sections[LEVEL_BIN_ENTITIES];
+    const _level_bin_bvh_t *bin_bvhs = (const _level_bin_bvh_t*)reader.sections[LEVEL_BIN_BVHS];
 
-            valid_entity = true;
+    // load dependencies
+    {
+        _golf_data_add_dependency(&level->deps, golf_file("data/textures/hole_lightmap.png"));
+        _golf_data_add_dependency(&level->deps, golf_file("data/models/hole.obj"));
+        _golf_data_add_dependency(&level->deps, golf_file("data/models/hole-cover.obj"));
+        _golf_data_add_dependency(&level->deps, golf_file("data/models/sphere.obj"));
+        for (int i = 0; i < reader.counts[LEVEL_BIN_MATERIALS]; i++) {
+            const _level_bin_material_t *bin_material = &bin_materials[i];
+            if ((bin_material->type == GOLF_MATERIAL_TEXTURE || bin_material->type == GOLF_MATERIAL_ENVIRONMENT) && bin_material->texture_path[0]) {
+                _golf_data_add_dependency(&level->deps, golf_file(bin_material->texture_path));
+            }
+        }
+        for (int i = 0; i < reader.counts[LEVEL_BIN_ENTITIES]; i++) {
+            const _level_bin_entity_t *bin_entity = &bin_entities[i];
+            if (bin_entity->type == MODEL_ENTITY && bin_entity->model_path[0]) {
+                _golf_data_add_dependency(&level->deps, golf_file(bin_entity->model_path));
+            }
         }
-        entity.parent_idx = parent_idx;
+        _golf_data_load_dependencies(&level->deps);
+    }
 
-        if (valid_entity) {
-            vec_push(&level->entities, entity);
+    for (int i = 0; i < reader.counts[LEVEL_BIN_MATERIALS]; i++) {
+        const _level_bin_material_t *bin_material = &bin_materials[i];
+        golf_material_t material;
+        switch ((golf_material_type_t)bin_material->type) {
+            case GOLF_MATERIAL_TEXTURE:
+                material = golf_material_texture(bin_material->name, bin_material->friction, bin_material->restitution, bin_material->vel_scale, bin_material->texture_path);
+                break;
+            case GOLF_MATERIAL_COLOR:
+                material = golf_material_color(bin_material->name, bin_material->friction, bin_material->restitution, bin_material->vel_scale, bin_material->color);
+                break;
+            case GOLF_MATERIAL_DIFFUSE_COLOR:
+                material = golf_material_diffuse_color(bin_material->name, bin_material->friction, bin_material->restitution, bin_material->vel_scale, bin_material->color);
+                break;
+            case GOLF_MATERIAL_ENVIRONMENT:
+                material = golf_material_environment(bin_material->name, bin_material->friction, bin_material->restitution, bin_material->vel_scale, bin_material->texture_path);
+                break;
+            default:
+                golf_log_warning("Invalid material. type: %u, name: %s", bin_material->type, bin_material->name);
+                continue;
         }
-        else {
-            golf_log_warning("Invalid entity. type: %s, name: %s", type, name);
+        vec_push(&level->materials, material);
+    }
+
+    for (int i = 0; i < reader.counts[LEVEL_BIN_LIGHTMAPS]; i++) {
+        const _level_bin_lightmap_t *bin_lightmap = &bin_lightmaps[i];
+        // The size is worked out in 64 bits so a bad width and height can't wrap around the
+        // check. Deflate expands by at most about 1032 times, so the samples in the blob
+        // can't hold more texels than that.
+        uint64_t texels_size64 = (uint64_t)(uint32_t)bin_lightmap->width * (uint32_t)bin_lightmap->height;
+        if (!_level_bin_reader_has_range(&reader, LEVEL_BIN_LIGHTMAP_SAMPLES, bin_lightmap->first_sample, bin_lightmap->num_samples) ||
+                bin_lightmap->width <= 0 || bin_lightmap->height <= 0 ||
+                texels_size64 > (uint64_t)reader.blob_size * 1032 || texels_size64 > INT32_MAX) {
+            golf_log_warning("Level %s has an invalid lightmap %s", path, bin_lightmap->name);
+            return false;
+        }
+
+        // Allocated with malloc like the stb_image decoded data the editor makes
+        int num_samples = bin_lightmap->num_samples;
+        mz_ulong texels_size = (mz_ulong)texels_size64;
+        unsigned char **image_datas = golf_alloc(sizeof(unsigned char*) * num_samples);
+        for (int s = 0; s < num_samples; s++) {
+            const _level_bin_lightmap_sample_t *sample = &bin_samples[bin_lightmap->first_sample + s];
+            const unsigned char *compressed = _level_bin_reader_get_blob(&reader, sample->offset, sample->size);
+            image_datas[s] = malloc(texels_size);
+            mz_ulong size = texels_size;
+            if (!compressed || mz_uncompress(image_datas[s], &size, compressed, sample->size) != MZ_OK || size != texels_size) {
+                golf_log_warning("Level %s has an invalid lightmap %s", path, bin_lightmap->name);
+                memset(image_datas[s], 0xFF, texels_size);
+            }
         }
+
+        sg_image *sg_images = golf_alloc(sizeof(sg_image) * num_samples);
+
+        vec_push(&level->lightmap_images, golf_lightmap_image(bin_lightmap->name, bin_lightmap->resolution, bin_lightmap->width, bin_lightmap->height, bin_lightmap->time_length, bin_lightmap->repeats, num_samples, image_datas, sg_images));
+    }
+
+    for (int i = 0; i < reader.counts[LEVEL_BIN_ENTITIES]; i++) {
+        const _level_bin_entity_t *bin_entity = &bin_entities[i];
+        golf_transform_t transform = bin_entity->transform;
+
+        bool valid_entity = true;
+        golf_entity_t entity;
+        entity.active = true;
+        switch ((golf_entity_type_t)bin_entity->type) {
+            case MODEL_ENTITY: {
+                golf_lightmap_section_t lightmap_section;
+                valid_entity = _level_bin_read_lightmap_section(&reader, bin_entity, &lightmap_section);
+                if (valid_entity) {
+                    golf_movement_t movement = _level_bin_read_movement(&bin_entity->movement);
+                    entity = golf_entity_model(bin_entity->name, transform, bin_entity->model_path, bin_entity->uv_scale, lightmap_section, movement, bin_entity->ignore_physics);
+                }
+                break;
+            }
+            case BALL_START_ENTITY:
+                entity = golf_entity_ball_start(bin_entity->name, transform);
+                break;
+            case HOLE_ENTITY:
+                entity = golf_entity_hole(bin_entity->name, transform);
+                break;
+            case GEO_ENTITY: {
+                golf_lightmap_section_t lightmap_section;
+                golf_geo_t geo;
+                valid_entity = _level_bin_read_geo(&reader, bin_entity->geo_idx, bin_entity->lightmap_num_uvs, &geo) &&
+                    _level_bin_read_lightmap_section(&reader, bin_entity, &lightmap_section);
+                if (valid_entity) {
+                    golf_movement_t movement = _level_bin_read_movement(&bin_entity->movement);
+                    entity = golf_entity_geo(bin_entity->name, transform, movement, geo, lightmap_section);
+                }
+                break;
+            }
+            case WATER_ENTITY: {
+                golf_lightmap_section_t lightmap_section;
+                golf_geo_t geo;
+                valid_entity = _level_bin_read_geo(&reader, bin_entity->geo_idx, bin_entity->lightmap_num_uvs, &geo) &&
+                    _level_bin_read_lightmap_section(&reader, bin_entity, &lightmap_section);
+                if (valid_entity) {
+                    entity = golf_entity_water(bin_entity->name, transform, geo, lightmap_section);
+                }
+                break;
+            }
+            case GROUP_ENTITY:
+                entity = golf_entity_group(bin_entity->name, transform);
+                break;
+            case BEGIN_ANIMATION_ENTITY:
+                entity = golf_entity_begin_animation(bin_entity->name, transform);
+                break;
+            case CAMERA_ZONE_ENTITY:
+                entity = golf_entity_camera_zone(bin_entity->name, bin_entity->towards_hole, transform);
+                break;
+            default:
+                valid_entity = false;
+                break;
+        }
+
+        if (!valid_entity) {
+            golf_log_warning("Level %s has an invalid entity. type: %u, name: %s", path, bin_entity->type, bin_entity->name);
+            return false;
+        }
+        entity.parent_idx = bin_entity->parent_idx;
+        vec_push(&level->entities, entity);
+    }
+
+    for (int i = 0; i < reader.counts[LEVEL_BIN_BVHS]; i++) {
+        const _level_bin_bvh_t *bin_bvh = &bin_bvhs[i];
+        uint64_t bvh_size = bin_bvh->size;
+        const char *data = _level_bin_reader_get_blob(&reader, bin_bvh->offset, (int64_t)bvh_size);
+        if (!data || bvh_size > INT32_MAX) {
+            golf_log_warning("Level %s has an invalid BVH", path);
+            continue;
+        }
+
+        golf_level_bvh_t level_bvh;
+        level_bvh.hash = bin_bvh->hash;
+        level_bvh.data_len = (int)bvh_size;
+        level_bvh.data = golf_alloc((size_t)bvh_size);
+        memcpy(level_bvh.data, data, (size_t)bvh_size);
+        vec_push(&level->bvhs, level_bvh);
     }
 
-    json_value_free(json_val);
     return true;
 }
 
+static bool _golf_level_import(const char *path, const char *data, int data_len) {
+    GOLF_UNUSED(data_len);
+
+    vec_char_t bin;
+    vec_init(&bin, "level");
+    bool imported = _golf_level_json_to_bin(path, data, &bin);
+    if (imported) {
+        golf_string_t import_level_file_path;
+        golf_string_initf(&import_level_file_path, "data", "%s.golf_data", path);
+        imported = golf_file_save_data(import_level_file_path.cstr, bin.data, bin.length);
+        if (!imported) {
+            golf_log_warning("Unable to write %s", import_level_file_path.cstr);
+        }
+        golf_string_deinit(&import_level_file_path);
+    }
+    vec_deinit(&bin);
+    return imported;
+}
+
+static bool _golf_level_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
+    GOLF_UNUSED(meta_data);
+    GOLF_UNUSED(meta_data_len);
+
+    golf_level_t *level = (golf_level_t*) ptr;
+
+    vec_init(&level->materials, "level");
+    vec_init(&level->lightmap_images, "level");
+    vec_init(&level->entities, "level");
+    vec_init(&level->bvhs, "level");
+    vec_init(&level->deps, "level");
+
+    // The data is the JSON when the level hasn't been imported yet
+    if (_level_bin_is_bin(data, data_len)) {
+        return _golf_level_load_bin(level, path, data, data_len);
+    }
+    else {
+        vec_char_t bin;
+        vec_init(&bin, "level");
+        bool loaded = _golf_level_json_to_bin(path, data, &bin) && _golf_level_load_bin(level, path, bin.data, bin.length);
+        vec_deinit(&bin);
+        return loaded;
+    }
+}
+
 static bool _golf_level_unload(void *ptr) {
     golf_level_t *level = (golf_level_t*) ptr;
 
@@ -2893,7 +4007,9 @@ static bool _golf_level_unload(void *ptr) {
     for (int i = 0; i < level->lightmap_images.length; i++) {
         golf_lightmap_image_t *lightmap_image = &level->lightmap_images.data[i];
         for (int i = 0; i < lightmap_image->num_samples; i++) {
+#if !GOLF_HEADLESS
             sg_destroy_image(lightmap_image->sg_image[i]);
+#endif
             free(lightmap_image->data[i]);
         }
         golf_free(lightmap_image->data);
@@ -2910,41 +4026,31 @@ static bool _golf_level_unload(void *ptr) {
 
         golf_geo_t *geo = golf_entity_get_geo(entity);
         if (geo) {
-            for (int i = 0; i < geo->faces.length; i++) {
-                golf_geo_face_t *face = &geo->faces.data[i];
-                vec_deinit(&face->idx);
-                vec_deinit(&face->uvs);
-            }
-
-            vec_deinit(&geo->points);
-            vec_deinit(&geo->faces);
-            vec_deinit(&geo->generator_data.args);
-
-            vec_deinit(&geo->model.groups);
-            vec_deinit(&geo->model.positions);
-            vec_deinit(&geo->model.normals);
-            vec_deinit(&geo->model.texcoords);
-            if (geo->model.is_water) {
-                vec_deinit(&geo->model.water_dir);
-            }
-
+#if !GOLF_HEADLESS
             if (geo->model.sg_size > 0) {
                 sg_destroy_buffer(geo->model.sg_positions_buf);
                 sg_destroy_buffer(geo->model.sg_normals_buf);
                 sg_destroy_buffer(geo->model.sg_texcoords_buf);
             }
+#endif
+            _golf_level_geo_deinit(geo);
         }
     }
 
+    for (int i = 0; i < level->bvhs.length; i++) {
+        golf_free(level->bvhs.data[i].data);
+    }
+
     vec_deinit(&level->materials);
     vec_deinit(&level->lightmap_images);
     vec_deinit(&level->entities);
+    vec_deinit(&level->bvhs);
     vec_deinit(&level->deps);
 
     return true;
 }
 
-static bool _golf_static_data_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_static_data_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(path);
     GOLF_UNUSED(data_len);
     GOLF_UNUSED(meta_data);
@@ -2961,19 +4067,12 @@ static bool _golf_static_data_load(void *ptr, const char *path, char *data, int
             char *data_path_copy = golf_alloc(strlen(data_path) + 1);
             strcpy(data_path_copy, data_path);
             vec_push(&static_data->data_paths, data_path_copy);
-            _golf_data_thread_load_file(golf_file(data_path_copy));
+            _golf_data_queue_file(golf_file(data_path_copy));
         }
     }
 
-    while (true) {
-        bool all_loaded = true;
-        for (int i = 0; i < static_data->data_paths.length; i++) {
-            if (golf_data_get_load_state(static_data->data_paths.data[i]) != GOLF_DATA_LOADED) {
-                all_loaded = false;
-            }
-        }
-        if (all_loaded) break;
-        golf_thread_timer_wait(&_data_thread_timer, 10000000);
+    for (int i = 0; i < static_data->data_paths.length; i++) {
+        _golf_data_wait_until_loaded(static_data->data_paths.data[i]);
     }
 
     json_value_free(val);
@@ -2995,7 +4094,7 @@ static bool _golf_static_data_unload(void *ptr) {
     return true;
 }
 
-static bool _golf_script_data_load(void *ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len) {
+static bool _golf_script_data_load(void *ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len) {
     GOLF_UNUSED(meta_data);
     GOLF_UNUSED(meta_data_len);
 
@@ -3027,20 +4126,49 @@ static _file_event_t _file_event(_file_event_type type, golf_file_t file) {
     return event;
 }
 
-static assetsys_error_t _golf_assetsys_file_load(const char *path, char **data, int *data_len) {
+// Loose files on Linux are mapped straight from disk and builds with a data pack
+// read from that, everything else is copied out of assetsys
+static bool _golf_data_file_open(const char *path, golf_file_view_t *view) {
+#if GOLF_PLATFORM_LINUX
+    return golf_file_view_open(view, path);
+#elif GOLF_DATA_USE_PACK
+    const golf_pack_entry_t *entry = golf_pack_find(&_data_pack, path);
+    return entry && golf_pack_open(&_data_pack, entry, view);
+#else
     char assetsys_path[GOLF_FILE_MAX_PATH];
     snprintf(assetsys_path, GOLF_FILE_MAX_PATH, "/%s", path);
 
     golf_mutex_lock(&_assetsys_lock);
     assetsys_file_t asset_file;
-    assetsys_file(_assetsys, assetsys_path, &asset_file);
+    if (assetsys_file(_assetsys, assetsys_path, &asset_file) != ASSETSYS_SUCCESS) {
+        golf_mutex_unlock(&_assetsys_lock);
+        return false;
+    }
     int size = assetsys_file_size(_assetsys, asset_file);
-    *data = (char*) golf_alloc(size + 1);
-    *data_len = 0;
-    assetsys_error_t error = assetsys_file_load(_assetsys, asset_file, data_len, *data, size);
-    (*data)[size] = 0;
+    char *data = (char*) golf_alloc(size + 1);
+    int data_len = 0;
+    assetsys_error_t error = assetsys_file_load(_assetsys, asset_file, &data_len, data, size);
+    data[size] = 0;
     golf_mutex_unlock(&_assetsys_lock);
-    return error;
+
+    if (error != ASSETSYS_SUCCESS) {
+        golf_free(data);
+        return false;
+    }
+    view->data = data;
+    view->data_len = data_len;
+    view->map_len = 0;
+    view->owns_data = true;
+    return true;
+#endif
+}
+
+// The meta file is optional, loaders get an empty string when there isn't one
+static void _golf_data_meta_file_open(const char *path, golf_file_view_t *view) {
+    golf_file_t meta_file = golf_file_append_extension(path, ".golf_meta");
+    if (!_golf_data_file_open(meta_file.path, view)) {
+        golf_file_view_empty(view);
+    }
 }
 
 typedef struct _data_loader {
@@ -3048,9 +4176,9 @@ typedef struct _data_loader {
     golf_data_type_t data_type;
     int data_size;
     bool (*finalize_fn)(void* ptr);
-    bool (*load_fn)(void* ptr, const char *path, char *data, int data_len, char *meta_data, int meta_data_len);
+    bool (*load_fn)(void* ptr, const char *path, const char *data, int data_len, const char *meta_data, int meta_data_len);
     bool (*unload_fn)(void *ptr);
-    bool (*import_fn)(const char *path, char *data, int data_len);
+    bool (*import_fn)(const char *path, const char *data, int data_len);
     bool reload_on;
 } _data_loader_t;
 
@@ -3059,7 +4187,7 @@ static _data_loader_t _loaders[] = {
         .ext = ".gif",
         .data_type = GOLF_DATA_GIF_TEXTURE,
         .data_size = sizeof(golf_gif_texture_t),
-        .finalize_fn = _golf_gif_texture_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_gif_texture_finalize),
         .load_fn = _golf_gif_texture_load,
         .unload_fn = _golf_gif_texture_unload,
         .import_fn = NULL,
@@ -3069,7 +4197,7 @@ static _data_loader_t _loaders[] = {
         .ext = ".png",
         .data_type = GOLF_DATA_TEXTURE,
         .data_size = sizeof(golf_texture_t),
-        .finalize_fn = _golf_texture_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_texture_finalize),
         .load_fn = _golf_texture_load,
         .unload_fn = _golf_texture_unload,
         .import_fn = NULL,
@@ -3079,7 +4207,7 @@ static _data_loader_t _loaders[] = {
         .ext = ".jpg",
         .data_type = GOLF_DATA_TEXTURE,
         .data_size = sizeof(golf_texture_t),
-        .finalize_fn = _golf_texture_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_texture_finalize),
         .load_fn = _golf_texture_load,
         .unload_fn = _golf_texture_unload,
         .import_fn = NULL,
@@ -3089,7 +4217,7 @@ static _data_loader_t _loaders[] = {
         .data_type = GOLF_DATA_TEXTURE,
         .ext = ".bmp",
         .data_size = sizeof(golf_texture_t),
-        .finalize_fn = _golf_texture_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_texture_finalize),
         .load_fn = _golf_texture_load,
         .unload_fn = _golf_texture_unload,
         .import_fn = NULL,
@@ -3099,7 +4227,7 @@ static _data_loader_t _loaders[] = {
         .ext = ".glsl",
         .data_type = GOLF_DATA_SHADER,
         .data_size = sizeof(golf_shader_t),
-        .finalize_fn = _golf_shader_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_shader_finalize),
         .load_fn = _golf_shader_load,
         .unload_fn = _golf_shader_unload,
         .import_fn = _golf_shader_import,
@@ -3109,7 +4237,7 @@ static _data_loader_t _loaders[] = {
         .ext = ".ttf",
         .data_type = GOLF_DATA_FONT,
         .data_size = sizeof(golf_font_t),
-        .finalize_fn = _golf_font_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_font_finalize),
         .load_fn = _golf_font_load,
         .unload_fn = _golf_font_unload,
         .import_fn = _golf_font_import,
@@ -3119,7 +4247,7 @@ static _data_loader_t _loaders[] = {
         .ext = ".obj",
         .data_type = GOLF_DATA_MODEL,
         .data_size = sizeof(golf_model_t),
-        .finalize_fn = _golf_model_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_model_finalize),
         .load_fn = _golf_model_load,
         .unload_fn = _golf_model_unload,
         //.import_fn = _golf_model_import,
@@ -3129,10 +4257,10 @@ static _data_loader_t _loaders[] = {
         .ext = ".level",
         .data_type = GOLF_DATA_LEVEL,
         .data_size = sizeof(golf_level_t),
-        .finalize_fn = _golf_level_finalize,
+        .finalize_fn = GOLF_DATA_FINALIZE_FN(_golf_level_finalize),
         .load_fn = _golf_level_load,
         .unload_fn = _golf_level_unload,
-        .import_fn = NULL,
+        .import_fn = _golf_level_import,
         .reload_on = true,
     },
     {
@@ -3207,14 +4335,103 @@ static _data_loader_t *_get_data_loader(const char *ext) {
     return NULL;
 }
 
-static int _file_alpha_cmp(const void *a, const void *b) {
-    const golf_file_t *file_a = (const golf_file_t*)a;
-    const golf_file_t *file_b = (const golf_file_t*)b;
-    return strcmp(file_a->path, file_b->path);
+// _seen_files is kept sorted by path for golf_data_get_all_matching
+static void _golf_data_add_seen_file(golf_file_t file) {
+    golf_mutex_lock(&_seen_files_lock);
+    int lo = 0, hi = _seen_files.length;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (strcmp(_seen_files.data[mid].path, file.path) < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    vec_push(&_seen_files, file);
+    memmove(_seen_files.data + lo + 1, _seen_files.data + lo, sizeof(golf_file_t) * (_seen_files.length - 1 - lo));
+    _seen_files.data[lo] = file;
+    golf_mutex_unlock(&_seen_files_lock);
+}
+
+static bool _golf_data_is_seen_file(const char *path) {
+    golf_mutex_lock(&_seen_files_lock);
+    int lo = 0, hi = _seen_files.length;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (strcmp(_seen_files.data[mid].path, path) < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    bool is_seen = lo < _seen_files.length && strcmp(_seen_files.data[lo].path, path) == 0;
+    golf_mutex_unlock(&_seen_files_lock);
+    return is_seen;
+}
+
+static void _golf_data_remove_seen_file(const char *path) {
+    golf_mutex_lock(&_seen_files_lock);
+    for (int i = 0; i < _seen_files.length; i++) {
+        if (strcmp(_seen_files.data[i].path, path) == 0) {
+            vec_splice(&_seen_files, i, 1);
+            break;
+        }
+    }
+    golf_mutex_unlock(&_seen_files_lock);
+}
+
+static void _golf_data_import_file(_data_loader_t *loader, const char *file_path) {
+    golf_file_view_t view;
+    if (golf_file_view_open(&view, file_path)) {
+        golf_log_note("Importing %s\n", file_path);
+        golf_mutex_lock(&_import_lock);
+        loader->import_fn(file_path, view.data, view.data_len);
+        golf_mutex_unlock(&_import_lock);
+        golf_file_view_close(&view);
+    }
+}
+
+#if GOLF_DATA_USE_ASSETSYS
+// Adds or removes a file and its import in the assetsys index, called with _assetsys_lock held
+static void _golf_assetsys_update_file(golf_file_t *file, bool exists) {
+    golf_file_t files[2];
+    int num_files = 0;
+    files[num_files++] = *file;
+    _data_loader_t *loader = _get_data_loader(file->ext);
+    if (loader && loader->import_fn) {
+        files[num_files++] = golf_file_append_extension(file->path, ".golf_data");
+    }
+
+    for (int i = 0; i < num_files; i++) {
+        char assetsys_path[GOLF_FILE_MAX_PATH + 1];
+        snprintf(assetsys_path, sizeof(assetsys_path), "/%s", files[i].path);
+
+        assetsys_error_t error;
+        if (exists) {
+            error = assetsys_mount_add_file(_assetsys, "data", "/data", assetsys_path);
+        }
+        else {
+            error = assetsys_mount_remove_file(_assetsys, "data", "/data", assetsys_path);
+        }
+        // The file can be gone again by the time its event is handled
+        if (error != ASSETSYS_SUCCESS && error != ASSETSYS_ERROR_FILE_NOT_FOUND) {
+            golf_log_warning("Unable to update %s in assetsys, error: %d", files[i].path, (int)error);
+        }
+    }
 }
+#endif
+
+typedef struct _file_scan {
+    bool push_events;
+    // Set when the watcher saw the file being written, which can happen within
+    // the same second as the last change so the times don't show it
+    bool is_changed;
+} _file_scan_t;
 
 static void _golf_data_handle_file(const char *file_path, void *udata) {
-    bool push_events = *((bool*)udata);
+    _file_scan_t *scan = (_file_scan_t*)udata;
 
     golf_file_t file = golf_file(file_path);
     uint64_t file_time = golf_file_get_time(file_path);
@@ -3222,31 +4439,35 @@ static void _golf_data_handle_file(const char *file_path, void *udata) {
         return;
     }
 
+    // The watcher also reports files that were deleted or moved away
+    if (file_time == 0) {
+        if (map_get(&_file_time_map, file_path)) {
+            map_remove(&_file_time_map, file_path);
+            _golf_data_remove_seen_file(file_path);
+            if (scan->push_events) {
+                golf_mutex_lock(&_file_events_lock);
+                vec_push(&_file_events, _file_event(FILE_DELETED, file));
+                golf_cond_broadcast(&_file_events_cond);
+                golf_mutex_unlock(&_file_events_lock);
+            }
+        }
+        return;
+    }
+
     _data_loader_t *loader = _get_data_loader(file.ext);
     if (loader && loader->import_fn) {
         golf_file_t import_file = golf_file_append_extension(file_path, ".golf_data");
         uint64_t import_file_time = golf_file_get_time(import_file.path);
 
-        if (import_file_time < file_time) {
-            char *data;
-            int data_len;
-            if (golf_file_load_data(file_path, &data, &data_len)) {
-                golf_log_note("Importing %s\n", file_path);
-                loader->import_fn(file_path, data, data_len);
-                golf_free(data);
-            }
+        if (import_file_time < file_time || (scan->is_changed && import_file_time == file_time)) {
+            _golf_data_import_file(loader, file_path);
         }
     }
 
     uint64_t *last_file_time = map_get(&_file_time_map, file_path);
     if (!last_file_time) {
         map_set(&_file_time_map, file_path, file_time);
-
-        golf_file_t file = golf_file(file_path);
-        golf_mutex_lock(&_seen_files_lock);
-        vec_push(&_seen_files, file);
-        golf_mutex_unlock(&_seen_files_lock);
-        qsort(_seen_files.data, _seen_files.length, sizeof(golf_file_t), _file_alpha_cmp);
+        _golf_data_add_seen_file(file);
 
         _file_event_type event_type = FILE_CREATED;
         // Consider updates to .golf_meta files to be updates to the actual data file
@@ -3259,16 +4480,16 @@ static void _golf_data_handle_file(const char *file_path, void *udata) {
             event_type = FILE_UPDATED;
         }
 
-        if (push_events) {
+        if (scan->push_events) {
             golf_mutex_lock(&_file_events_lock);
             vec_push(&_file_events, _file_event(event_type, file));
+            golf_cond_broadcast(&_file_events_cond);
             golf_mutex_unlock(&_file_events_lock);
         }
     }
-    else if (*last_file_time < file_time) {
+    else if (*last_file_time < file_time || scan->is_changed) {
         map_set(&_file_time_map, file_path, file_time);
 
-        golf_file_t file = golf_file(file_path);
         // Consider updates to .golf_meta files to be updates to the actual data file
         if (strcmp(file.ext, ".golf_meta") == 0) {
             char actual_file_path[GOLF_FILE_MAX_PATH];
@@ -3278,31 +4499,16 @@ static void _golf_data_handle_file(const char *file_path, void *udata) {
             file = golf_file(actual_file_path);
         }
 
-        if (push_events) {
+        if (scan->push_events) {
             golf_mutex_lock(&_file_events_lock);
             vec_push(&_file_events, _file_event(FILE_UPDATED, file));
+            golf_cond_broadcast(&_file_events_cond);
             golf_mutex_unlock(&_file_events_lock);
         }
     }
 }
 
 static void _golf_data_thread_load_file(golf_file_t file) {
-    {
-        golf_mutex_lock(&_loaded_data_lock);
-        bool done = false;
-        golf_data_t *loaded_data = map_get(&_loaded_data, file.path);
-        if (loaded_data) {
-            loaded_data->load_count++;
-            golf_log_note("Loading file %s, count: %d", file.path, loaded_data->load_count);
-            done = true;
-        }
-        golf_mutex_unlock(&_loaded_data_lock);
-        if (done) {
-            return;
-        }
-    }
-    golf_log_note("Loading file %s, count: 1", file.path);
-
     _data_loader_t *loader = _get_data_loader(file.ext);
     if (!loader) {
         golf_log_warning("No loader for file %s", file.path);
@@ -3314,74 +4520,101 @@ static void _golf_data_thread_load_file(golf_file_t file) {
         file_to_load = golf_file_append_extension(file.path, ".golf_data");
     }
 
-    char *data = NULL;
-    int data_len = 0;
-    assetsys_error_t error = _golf_assetsys_file_load(file_to_load.path, &data, &data_len);
-    if (error == ASSETSYS_SUCCESS) {
-        golf_file_t meta_file = golf_file_append_extension(file.path, ".golf_meta");
-        char *meta_data;
-        int meta_data_len;
-        _golf_assetsys_file_load(meta_file.path, &meta_data, &meta_data_len);
-
-        golf_data_t golf_data;
-        golf_data.load_count = 1;
-        golf_data.file = file_to_load;
-        golf_data.type = loader->data_type;
-        golf_data.ptr = golf_alloc(loader->data_size);
-        golf_data.is_loaded = false;
-
+    // The entry is added before loading so that only one worker loads each file
+    void *ptr = NULL;
+    {
         golf_mutex_lock(&_loaded_data_lock);
-        map_set(&_loaded_data, file.path, golf_data);
+        golf_data_t *loaded_data = map_get(&_loaded_data, file.path);
+        if (loaded_data) {
+            loaded_data->load_count++;
+            golf_log_note("Loading file %s, count: %d", file.path, loaded_data->load_count);
+        }
+        else {
+            golf_data_t golf_data;
+            golf_data.load_count = 1;
+            golf_data.file = file_to_load;
+            golf_data.type = loader->data_type;
+            golf_data.ptr = golf_alloc(loader->data_size);
+            memset(golf_data.ptr, 0, loader->data_size);
+            golf_data.is_loaded = false;
+            golf_data.version = 0;
+            map_set(&_loaded_data, file.path, golf_data);
+            ptr = golf_data.ptr;
+        }
         golf_mutex_unlock(&_loaded_data_lock);
+        if (!ptr) {
+            return;
+        }
+    }
+    golf_log_note("Loading file %s, count: 1", file.path);
+
+    golf_file_view_t view;
+    if (_golf_data_file_open(file_to_load.path, &view)) {
+        golf_file_view_t meta_view;
+        _golf_data_meta_file_open(file.path, &meta_view);
 
-        loader->load_fn(golf_data.ptr, file.path, data, data_len, meta_data, meta_data_len);
+        loader->load_fn(ptr, file.path, view.data, view.data_len, meta_view.data, meta_view.data_len);
 
         golf_mutex_lock(&_file_events_lock);
         vec_push(&_file_events, _file_event(FILE_LOADED, file));
+        golf_cond_broadcast(&_file_events_cond);
         golf_mutex_unlock(&_file_events_lock);
 
-        golf_free(meta_data);
+        golf_file_view_close(&meta_view);
+        golf_file_view_close(&view);
     }
     else {
         golf_log_warning("Assetys unable to load file %s", file_to_load.path);
+
+        golf_mutex_lock(&_loaded_data_lock);
+        map_remove(&_loaded_data, file.path);
+        golf_mutex_unlock(&_loaded_data_lock);
+        golf_free(ptr);
     }
-    golf_free(data);
 }
 
-static golf_thread_result_t _golf_data_thread_fn(void *udata) {
+static golf_thread_result_t _golf_data_worker_thread_fn(void *udata) {
     GOLF_UNUSED(udata);
 
 #if GOLF_PLATFORM_EMSCRIPTEN
     stm_setup();
 #endif
 
-    vec_golf_file_t files_to_load;
-    vec_init(&files_to_load, "data_thread");
-    uint64_t last_run_time = stm_now();
-
     while (true) {
-        files_to_load.length = 0;
-
+        golf_file_t file;
         golf_mutex_lock(&_files_to_load_lock);
-        for (int i = 0; i < _files_to_load.length; i++) {
-            vec_push(&files_to_load, _files_to_load.data[i]);
+        while (!_golf_data_pop_file_to_load(&file)) {
+            golf_cond_wait(&_files_to_load_cond, &_files_to_load_lock);
         }
-        _files_to_load.length = 0;
         golf_mutex_unlock(&_files_to_load_lock);
 
-        for (int i = 0; i < files_to_load.length; i++) {
-            _golf_data_thread_load_file(files_to_load.data[i]);
-        }
+        _golf_data_thread_load_file(file);
+    }
+    return GOLF_THREAD_RESULT_SUCCESS;
+}
 
-        golf_thread_timer_wait(&_data_thread_timer, 10000000);
+static golf_thread_result_t _golf_data_watch_thread_fn(void *udata) {
+    GOLF_UNUSED(udata);
 
-        double time_since_last_run = stm_sec(stm_since(last_run_time));
-        if (time_since_last_run > 1) {
-            bool push_events = true;
-            golf_dir_recurse("data", _golf_data_handle_file, &push_events); 
-            last_run_time = stm_now();
+    golf_dir_watch_t watch;
+    if (golf_dir_watch_init(&watch, "data")) {
+        // Catch anything that changed between golf_data_init and the watch starting
+        _file_scan_t scan = { .push_events = true, .is_changed = false };
+        golf_dir_recurse("data", _golf_data_handle_file, &scan);
+
+        scan.is_changed = true;
+        while (true) {
+            golf_dir_watch_wait(&watch, _golf_data_handle_file, &scan);
         }
     }
+
+    golf_log_note("Unable to watch the data directory, polling it for changes instead");
+    while (true) {
+        golf_thread_timer_wait(&_data_thread_timer, 1000000000);
+
+        _file_scan_t scan = { .push_events = true, .is_changed = false };
+        golf_dir_recurse("data", _golf_data_handle_file, &scan);
+    }
     return GOLF_THREAD_RESULT_SUCCESS;
 }
 
@@ -3395,51 +4628,102 @@ void golf_data_turn_off_reload(const char *ext) {
     }
 }
 
+void golf_data_set_headless(bool headless) {
+    _headless = headless;
+}
+
 void golf_data_init(void) {
-    golf_thread_timer_init(&_main_thread_timer);
     golf_thread_timer_init(&_data_thread_timer);
+    golf_cond_init(&_loaded_data_cond);
     golf_mutex_init(&_loaded_data_lock);
     map_init(&_loaded_data, "data");
+    golf_cond_init(&_files_to_load_cond);
     golf_mutex_init(&_files_to_load_lock);
     vec_init(&_files_to_load, "data");
     golf_mutex_init(&_seen_files_lock);
     vec_init(&_seen_files, "data");
+    golf_cond_init(&_file_events_cond);
     golf_mutex_init(&_file_events_lock);
     vec_init(&_file_events, "data");
+    golf_mutex_init(&_import_lock);
+    map_init(&_file_time_map, "data");
+
+    // Import before mounting so that newly imported files are visible to assetsys
+    _file_scan_t scan = { .push_events = false, .is_changed = false };
+    golf_dir_recurse("data", _golf_data_handle_file, &scan);
+
+#if GOLF_DATA_USE_PACK
+    // The pack's index is used in place, so there's nothing to scan or inflate up front
+    // A bad pack leaves no seen files, so every load fails instead of reading through a NULL header
+    if (!golf_pack_init(&_data_pack, (const char*)golf_data_pack, (int)sizeof(golf_data_pack))) {
+        golf_log_warning("Unable to read the data pack");
+    }
+    else {
+        for (uint32_t i = 0; i < _data_pack.header->num_entries; i++) {
+            const char *path = golf_pack_get_path(&_data_pack, &_data_pack.entries[i]);
+            if (!map_get(&_file_time_map, path)) {
+                _golf_data_add_seen_file(golf_file(path));
+            }
+        }
+    }
+#elif GOLF_DATA_USE_ASSETSYS
     golf_mutex_init(&_assetsys_lock);
     _assetsys = assetsys_create(NULL);
-    map_init(&_file_time_map, "data");
-#if GOLF_PLATFORM_IOS | GOLF_PLATFORM_ANDROID | GOLF_PLATFORM_EMSCRIPTEN
-    assetsys_error_t error = assetsys_mount(_assetsys, "data.zip", (const char*)golf_data_zip, sizeof(golf_data_zip), "/data");
-#else
     assetsys_error_t error = assetsys_mount(_assetsys, "data", NULL, 0, "/data");
-#endif
     if (error != ASSETSYS_SUCCESS) {
         golf_log_error("Unable to mount data, error: %d", (int)error);
     }
+#endif
 
-    bool push_events = false;
-    golf_dir_recurse("data", _golf_data_handle_file, &push_events); 
-    qsort(_seen_files.data, _seen_files.length, sizeof(golf_file_t), _file_alpha_cmp);
+    // Emscripten has a fixed size thread pool, so it only gets one worker
+#if GOLF_PLATFORM_EMSCRIPTEN
+    int num_workers = 1;
+#else
+    int num_workers = golf_thread_get_num_cores() - 1;
+    if (num_workers < 1) num_workers = 1;
+    if (num_workers > GOLF_DATA_MAX_WORKERS) num_workers = GOLF_DATA_MAX_WORKERS;
+#endif
+    for (int i = 0; i < num_workers; i++) {
+        golf_thread_create(_golf_data_worker_thread_fn, NULL, "_golf_data_worker_thread_fn");
+    }
 
-    golf_thread_create(_golf_data_thread_fn, NULL, "_golf_data_thread_fn");
+    // Only desktop builds load from a data directory that can change
+#if GOLF_PLATFORM_LINUX | GOLF_PLATFORM_WINDOWS
+    golf_thread_create(_golf_data_watch_thread_fn, NULL, "_golf_data_watch_thread_fn");
+#endif
 }
 
 void golf_data_update(float dt) {
     GOLF_UNUSED(dt);
 
     golf_mutex_lock(&_file_events_lock);  
+
+#if GOLF_DATA_USE_ASSETSYS
+    // Apply all new and deleted files to assetsys in one go, before any reloads that might need them
+    bool has_new_files = false;
+    for (int i = 0; i < _file_events.length; i++) {
+        if (_file_events.data[i].type == FILE_CREATED || _file_events.data[i].type == FILE_DELETED) {
+            has_new_files = true;
+            break;
+        }
+    }
+    if (has_new_files) {
+        golf_mutex_lock(&_assetsys_lock);
+        for (int i = 0; i < _file_events.length; i++) {
+            _file_event_t *event = &_file_events.data[i];
+            if (event->type == FILE_CREATED || event->type == FILE_DELETED) {
+                _golf_assetsys_update_file(&event->file, event->type == FILE_CREATED);
+            }
+        }
+        golf_mutex_unlock(&_assetsys_lock);
+    }
+#endif
+
     for (int i = 0; i < _file_events.length; i++) {
         _file_event_t event = _file_events.data[i];
         switch (event.type) {
-            case FILE_CREATED: {
-                golf_mutex_lock(&_assetsys_lock);
-                assetsys_dismount(_assetsys, "data", "/data");
-                assetsys_error_t error = assetsys_mount(_assetsys, "data", NULL, 0, "/data");
-                golf_mutex_unlock(&_assetsys_lock);
-                if (error != ASSETSYS_SUCCESS) {
-                    golf_log_error("Unable to mount data");
-                }
+            case FILE_CREATED:
+            case FILE_DELETED: {
                 break;
             }
             case FILE_UPDATED: {
@@ -3464,26 +4748,30 @@ void golf_data_update(float dt) {
                     }
 
                     loader->unload_fn(ptr);
-                    char *bytes = NULL;
-                    int bytes_len = 0;
-                    assetsys_error_t error = _golf_assetsys_file_load(file_to_load.path, &bytes, &bytes_len);
-                    if (error == ASSETSYS_SUCCESS) {
-                        golf_file_t meta_file = golf_file_append_extension(event.file.path, ".golf_meta");
-                        char *meta_data;
-                        int meta_data_len;
-                        _golf_assetsys_file_load(meta_file.path, &meta_data, &meta_data_len);
-
-                        loader->load_fn(ptr, event.file.path, bytes, bytes_len, meta_data, meta_data_len);
-                        if (loader->finalize_fn) {
+                    golf_file_view_t view;
+                    if (_golf_data_file_open(file_to_load.path, &view)) {
+                        golf_file_view_t meta_view;
+                        _golf_data_meta_file_open(event.file.path, &meta_view);
+
+                        loader->load_fn(ptr, event.file.path, view.data, view.data_len, meta_view.data, meta_view.data_len);
+                        if (loader->finalize_fn && !_headless) {
                             loader->finalize_fn(ptr);
                         }
+                        _data_version++;
+
+                        golf_mutex_lock(&_loaded_data_lock);
+                        data = map_get(&_loaded_data, event.file.path);
+                        if (data) {
+                            data->version = _data_version;
+                        }
+                        golf_mutex_unlock(&_loaded_data_lock);
 
-                        golf_free(meta_data);
+                        golf_file_view_close(&meta_view);
+                        golf_file_view_close(&view);
                     }
                     else {
                         golf_log_warning("Assetys unable to load file %s", file_to_load.path);
                     }
-                    golf_free(bytes);
                 }
                 break;
             }
@@ -3496,13 +4784,16 @@ void golf_data_update(float dt) {
                 golf_mutex_unlock(&_loaded_data_lock);
 
                 _data_loader_t *loader = _get_data_loader(event.file.ext);
-                if (loader->finalize_fn) {
+                if (loader->finalize_fn && !_headless) {
                     loader->finalize_fn(ptr);
                 }
 
+                _data_version++;
                 golf_mutex_lock(&_loaded_data_lock);
                 data = map_get(&_loaded_data, event.file.path);
                 data->is_loaded = true;
+                data->version = _data_version;
+                golf_cond_broadcast(&_loaded_data_cond);
                 golf_mutex_unlock(&_loaded_data_lock);
                 break;
             }
@@ -3513,14 +4804,24 @@ void golf_data_update(float dt) {
 }
 
 void golf_data_load(const char *path, bool load_async) {
-    golf_mutex_lock(&_files_to_load_lock);
-    vec_push(&_files_to_load, golf_file(path));
-    golf_mutex_unlock(&_files_to_load_lock);
+    // A file that isn't there would never finish loading, so don't wait on it
+    if (!_golf_data_is_seen_file(path)) {
+        golf_log_warning("Unable to load %s, file not found", path);
+        return;
+    }
+
+    _golf_data_queue_file(golf_file(path));
 
     if (!load_async) {
+        // Files only finish loading in golf_data_update, so wake up for each file event
+        golf_data_update(0);
         while (golf_data_get_load_state(path) != GOLF_DATA_LOADED) {
+            golf_mutex_lock(&_file_events_lock);
+            while (_file_events.length == 0) {
+                golf_cond_wait(&_file_events_cond, &_file_events_lock);
+            }
+            golf_mutex_unlock(&_file_events_lock);
             golf_data_update(0);
-            golf_thread_timer_wait(&_main_thread_timer, 10000000);
         }
     }
 }
@@ -3545,25 +4846,34 @@ golf_data_load_state_t golf_data_get_load_state(const char *path) {
 void golf_data_unload(const char *path) {
     golf_log_note("Unloading file %s", path);
 
+    golf_file_t file = golf_file(path);
+    _data_loader_t *loader = _get_data_loader(file.ext);
+    if (!loader) {
+        golf_log_warning("Unable to unload file %s", path);
+        return;
+    }
+
+    // Workers add entries while loading, so the map is only touched with the lock held
+    golf_mutex_lock(&_loaded_data_lock);
     golf_data_t *golf_data = map_get(&_loaded_data, path); 
     if (!golf_data) {
+        golf_mutex_unlock(&_loaded_data_lock);
         golf_log_warning("Unloading file %s that is not loaded", path);
         return;
     }
 
     golf_data->load_count--;
+    void *ptr = NULL;
     if (golf_data->load_count == 0) {
-        golf_file_t file = golf_file(path);
-        _data_loader_t *loader = _get_data_loader(file.ext);
-        if (!loader) {
-            golf_log_warning("Unable to unload file %s", path);
-            return;
-        }
-
-        loader->unload_fn(golf_data->ptr);
-        golf_free(golf_data->ptr);
+        ptr = golf_data->ptr;
         map_remove(&_loaded_data, path);
     }
+    golf_mutex_unlock(&_loaded_data_lock);
+
+    if (ptr) {
+        loader->unload_fn(ptr);
+        golf_free(ptr);
+    }
 }
 
 static void *_golf_data_get_ptr(const char *path, golf_data_type_t type) {
@@ -3580,6 +4890,21 @@ static void *_golf_data_get_ptr(const char *path, golf_data_type_t type) {
     return ptr;
 }
 
+int golf_data_get_version(void) {
+    return _data_version;
+}
+
+int golf_data_get_file_version(const char *path) {
+    int version = 0;
+    golf_mutex_lock(&_loaded_data_lock);
+    golf_data_t *data_file = map_get(&_loaded_data, path);
+    if (data_file && data_file->is_loaded) {
+        version = data_file->version;
+    }
+    golf_mutex_unlock(&_loaded_data_lock);
+    return version;
+}
+
 void *golf_data_get_ptr(const char *path, golf_data_type_t type) {
     return _golf_data_get_ptr(path, type);
 }
@@ -3708,11 +5033,18 @@ void golf_data_get_all_matching(golf_data_type_t type, const char *str, vec_golf
     golf_mutex_unlock(&_seen_files_lock);
 }
 
-void golf_data_force_remount(void) {
+void golf_data_add_file(const char *path) {
+    golf_file_t file = golf_file(path);
+    _data_loader_t *loader = _get_data_loader(file.ext);
+    if (loader && loader->import_fn) {
+        _golf_data_import_file(loader, path);
+    }
+
+#if GOLF_DATA_USE_ASSETSYS
     golf_mutex_lock(&_assetsys_lock);
-    assetsys_dismount(_assetsys, "data", "/data");
-    assetsys_mount(_assetsys, "data", NULL, 0, "/data");
+    _golf_assetsys_update_file(&file, true);
     golf_mutex_unlock(&_assetsys_lock);
+#endif
 }
 
 #define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
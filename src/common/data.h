@@ -3,11 +3,13 @@
 
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include "sokol/sokol_gfx.h"
 #include "common/file.h"
 #include "common/map.h"
 #include "common/maths.h"
 #include "common/script.h"
+#include "common/shader_uniforms.h"
 #include "common/string.h"
 
 #define GOLF_MAX_NAME_LEN 64
@@ -65,6 +67,9 @@ typedef struct golf_model {
     vec_vec3_t water_dir;
 
     int sg_size;
+    // sg_positions_buf holds positions relative to these, see golf_model_get_pack_mat
+    vec3 sg_pos_offset;
+    float sg_pos_scale;
     sg_buffer sg_positions_buf, sg_normals_buf, sg_texcoords_buf;
 } golf_model_t;
 typedef vec_t(golf_model_t) vec_golf_model_t;
@@ -72,6 +77,9 @@ golf_model_t golf_model_dynamic(vec_golf_group_t groups, vec_vec3_t positions, v
 golf_model_t golf_model_dynamic_water(vec_golf_group_t groups, vec_vec3_t positions, vec_vec3_t normals, vec_vec2_t texcoords, vec_vec3_t water_dir);
 void golf_model_dynamic_finalize(golf_model_t *model);
 void golf_model_dynamic_update_sg_buf(golf_model_t *model);
+// Takes the packed positions in sg_positions_buf back to model space, anything drawn
+// with the model's buffers multiplies this into its model matrix
+mat4 golf_model_get_pack_mat(golf_model_t *model);
 
 typedef struct golf_shader_input {
     char name[GOLF_MAX_NAME_LEN];
@@ -90,6 +98,10 @@ typedef struct golf_shader_uniform {
     int size, binding;
     char *data;
     vec_golf_shader_uniform_member_t members;
+
+    // Set when the block matched its struct in shader_uniforms.h on load
+    bool has_layout;
+    golf_shader_uniform_block_type_t layout;
 } golf_shader_uniform_t;
 typedef vec_t(golf_shader_uniform_t) vec_golf_shader_uniform_t;
 
@@ -154,6 +166,9 @@ void golf_shader_uniform_set_mat4(golf_shader_uniform_t *uniform, const char *na
 golf_shader_uniform_t *golf_shader_get_vs_uniform(golf_shader_t *shader, const char *name);
 golf_shader_uniform_t *golf_shader_get_fs_uniform(golf_shader_t *shader, const char *name);
 golf_shader_pipeline_t *golf_shader_get_pipeline(golf_shader_t *shader, const char *name);
+// Applies a struct from shader_uniforms.h to the block it mirrors. Blocks are matched
+// to their structs when the shader loads, so this doesn't look anything up by name.
+void golf_shader_apply_uniforms(golf_shader_t *shader, golf_shader_uniform_block_type_t type, const void *data);
 
 typedef struct golf_pixel_pack_icon {
     vec2 uv0, uv1;
@@ -196,14 +211,33 @@ typedef struct golf_config_property {
 typedef map_t(golf_config_property_t) map_golf_config_property_t;
 
 typedef struct golf_config {
+    // Bumped every time the file is loaded, bound structs compare against it to
+    // know when they need to be resolved again after a hot reload
+    int version;
     map_golf_config_property_t properties;
 } golf_config_t;
 
+// Describes where a config property is written in a plain struct, so code that
+// reads config every frame can resolve the names once instead of per lookup
+typedef struct golf_config_binding {
+    const char *name;
+    golf_config_property_type_t type;
+    size_t offset;
+} golf_config_binding_t;
+
+#define GOLF_CONFIG_BIND_NUM(type, field, name) { name, GOLF_CONFIG_PROPERTY_NUM, offsetof(type, field) }
+#define GOLF_CONFIG_BIND_VEC2(type, field, name) { name, GOLF_CONFIG_PROPERTY_VEC2, offsetof(type, field) }
+#define GOLF_CONFIG_BIND_VEC3(type, field, name) { name, GOLF_CONFIG_PROPERTY_VEC3, offsetof(type, field) }
+#define GOLF_CONFIG_BIND_VEC4(type, field, name) { name, GOLF_CONFIG_PROPERTY_VEC4, offsetof(type, field) }
+
 float golf_config_get_num(golf_config_t *cfg, const char *name);
 const char *golf_config_get_string(golf_config_t *cfg, const char *name);
 vec2 golf_config_get_vec2(golf_config_t *cfg, const char *name);
 vec3 golf_config_get_vec3(golf_config_t *cfg, const char *name);
 vec4 golf_config_get_vec4(golf_config_t *cfg, const char *name);
+// Writes every binding into out, returns false and logs each property that is
+// missing or has the wrong type. Those fields are zeroed.
+bool golf_config_bind(golf_config_t *cfg, const golf_config_binding_t *bindings, int num_bindings, void *out);
 
 #define CFG_NUM(cfg, name) golf_config_get_num(cfg, name)
 #define CFG_STRING(cfg, name) golf_config_get_string(cfg, name)
@@ -363,6 +397,8 @@ typedef enum golf_data_type {
 typedef struct golf_data {
     bool is_loaded;
     int load_count;
+    // The golf_data_get_version this file last finished loading or reloading at
+    int version;
     golf_file_t file;
 
     golf_data_type_t type; 
@@ -377,15 +413,24 @@ typedef enum golf_data_load_state {
 } golf_data_load_state_t;
 
 void golf_data_turn_off_reload(const char *ext);
+void golf_data_set_headless(bool headless);
 void golf_data_init(void);
 void golf_data_update(float dt);
+// Files that aren't in the data directory are logged and skipped, nothing gets loaded
 void golf_data_load(const char *path, bool load_async);
 golf_data_load_state_t golf_data_get_load_state(const char *path);
 void golf_data_unload(const char *path);
 void golf_data_debug_console_tab(void);
 void golf_data_get_all_matching(golf_data_type_t type, const char *str, vec_golf_file_t *files);
-void golf_data_force_remount(void);
-
+// Makes a file the game just wrote loadable straight away instead of once the
+// data watcher picks it up, importing it first if its loader needs that
+void golf_data_add_file(const char *path);
+
+// Bumped whenever a file finishes loading or reloading, so anything built from
+// loaded data can tell when it needs building again
+int golf_data_get_version(void);
+// Like golf_data_get_version but only for one file, 0 while it isn't loaded
+int golf_data_get_file_version(const char *path);
 void *golf_data_get_ptr(const char *path, golf_data_type_t type);
 golf_gif_texture_t *golf_data_get_gif_texture(const char *path);
 golf_texture_t *golf_data_get_texture(const char *path);
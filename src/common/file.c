@@ -22,6 +22,20 @@
 
 #endif
 
+// These check for the OS rather than GOLF_PLATFORM_LINUX, which Darwin builds define too.
+// Files are mapped wherever POSIX mmap is available and only Linux has inotify.
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__) && defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#define GOLF_FILE_VIEW_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#define GOLF_DIR_WATCH_INOTIFY 1
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
 #if defined(_WIN32)
 
 static uint64_t _get_file_time(const char *path) {
@@ -162,6 +176,132 @@ bool golf_file_load_data(const char *path, char **data, int *data_len) {
     return true;
 }
 
+bool golf_file_save_data(const char *path, const char *data, int data_len) {
+    char tmp_path[GOLF_FILE_MAX_PATH];
+    int tmp_path_len = snprintf(tmp_path, GOLF_FILE_MAX_PATH, "%s.tmp", path);
+    if (tmp_path_len < 0 || tmp_path_len >= GOLF_FILE_MAX_PATH) {
+        return false;
+    }
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) {
+        return false;
+    }
+    bool written = data_len == 0 || fwrite(data, data_len, 1, f) == 1;
+    if (fclose(f) != 0) {
+        written = false;
+    }
+    if (!written) {
+        remove(tmp_path);
+        return false;
+    }
+
+#if defined(_WIN32)
+    bool renamed = MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool renamed = rename(tmp_path, path) == 0;
+#endif
+    if (!renamed) {
+        remove(tmp_path);
+    }
+    return renamed;
+}
+
+void golf_file_view_empty(golf_file_view_t *view) {
+    char *data = golf_alloc(1);
+    data[0] = 0;
+    view->data = data;
+    view->data_len = 0;
+    view->map_len = 0;
+    view->owns_data = true;
+}
+
+#if GOLF_FILE_VIEW_MMAP
+
+bool golf_file_view_open(golf_file_view_t *view, const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size > INT32_MAX - 1) {
+        close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        golf_file_view_empty(view);
+        return true;
+    }
+
+    // Reserve one byte more than the file so there's always a zero after it. The
+    // end of the file's last page reads as zeros, and when the file ends exactly
+    // on a page boundary the reserved anonymous page does.
+    size_t file_len = (size_t)info.st_size;
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t map_len = (file_len + 1 + page_size - 1) / page_size * page_size;
+    char *reserved = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    char *mapped = mmap(reserved, file_len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        munmap(reserved, map_len);
+        return false;
+    }
+    madvise(mapped, file_len, MADV_WILLNEED);
+
+    view->data = mapped;
+    view->data_len = (int)file_len;
+    view->map_len = map_len;
+    view->owns_data = false;
+    return true;
+}
+
+void golf_file_view_close(golf_file_view_t *view) {
+    if (view->map_len > 0) {
+        munmap((void*)view->data, view->map_len);
+    }
+    else if (view->owns_data) {
+        golf_free((void*)view->data);
+    }
+    view->data = NULL;
+    view->data_len = 0;
+    view->map_len = 0;
+    view->owns_data = false;
+}
+
+#else
+
+bool golf_file_view_open(golf_file_view_t *view, const char *path) {
+    char *data;
+    int data_len;
+    if (!golf_file_load_data(path, &data, &data_len)) {
+        return false;
+    }
+
+    view->data = data;
+    view->data_len = data_len;
+    view->map_len = 0;
+    view->owns_data = true;
+    return true;
+}
+
+void golf_file_view_close(golf_file_view_t *view) {
+    if (view->owns_data) {
+        golf_free((void*)view->data);
+    }
+    view->data = NULL;
+    view->data_len = 0;
+    view->map_len = 0;
+    view->owns_data = false;
+}
+
+#endif
+
 static void _grow_buffer(char **buffer, int *buffer_len) {
     int new_buffer_len = 2 * (*buffer_len + 1);
     char *new_buffer = malloc(new_buffer_len);
@@ -351,3 +491,204 @@ void golf_dir_init(golf_dir_t *dir, const char *dir_name, bool recurse) {
 void golf_dir_deinit(golf_dir_t *dir) {
     golf_free(dir->files);
 }
+
+#if GOLF_DIR_WATCH_INOTIFY
+
+// Changes are collected until none arrive for this long, so that a save that
+// touches many files is handled as one batch
+#define GOLF_DIR_WATCH_SETTLE_MS 20
+#define GOLF_DIR_WATCH_MAX_BATCH_MS 500
+
+#define GOLF_DIR_WATCH_DIR_MASK (IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM | IN_ONLYDIR)
+
+static void _dir_watch_add(golf_dir_watch_t *watch, const char *dir_name) {
+    int wd = inotify_add_watch(watch->fd, dir_name, GOLF_DIR_WATCH_DIR_MASK);
+    if (wd < 0) {
+        return;
+    }
+
+    // Adding a directory that is already watched returns its existing descriptor
+    for (int i = 0; i < watch->wds.length; i++) {
+        if (watch->wds.data[i] == wd) {
+            return;
+        }
+    }
+
+    int dir_name_len = (int)strlen(dir_name);
+    char *dir_path = golf_alloc(dir_name_len + 1);
+    memcpy(dir_path, dir_name, dir_name_len + 1);
+    vec_push(&watch->wds, wd);
+    vec_push(&watch->dir_paths, dir_path);
+
+    DIR *dir_ptr = opendir(dir_name);
+    if (dir_ptr == NULL) {
+        return;
+    }
+
+    struct dirent *entry = NULL;
+    while ((entry = readdir(dir_ptr))) {
+        if ((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) {
+            continue;
+        }
+
+        char file_path[GOLF_FILE_MAX_PATH];
+        _create_file_path(file_path, dir_name, entry->d_name);
+
+        struct stat info;
+        if (stat(file_path, &info) == 0 && S_ISDIR(info.st_mode)) {
+            _dir_watch_add(watch, file_path);
+        }
+    }
+    closedir(dir_ptr);
+}
+
+static void _dir_watch_remove(golf_dir_watch_t *watch, int wd) {
+    for (int i = 0; i < watch->wds.length; i++) {
+        if (watch->wds.data[i] == wd) {
+            golf_free(watch->dir_paths.data[i]);
+            vec_splice(&watch->wds, i, 1);
+            vec_splice(&watch->dir_paths, i, 1);
+            return;
+        }
+    }
+}
+
+static const char *_dir_watch_get_path(golf_dir_watch_t *watch, int wd) {
+    for (int i = 0; i < watch->wds.length; i++) {
+        if (watch->wds.data[i] == wd) {
+            return watch->dir_paths.data[i];
+        }
+    }
+    return NULL;
+}
+
+static void _dir_watch_add_changed(const char *file_path, void *udata) {
+    map_int_t *changed = (map_int_t*)udata;
+    map_set(changed, file_path, 1);
+}
+
+// Returns false if the kernel's event queue overflowed and changes were lost
+static bool _dir_watch_read_events(golf_dir_watch_t *watch, map_int_t *changed) {
+    bool overflowed = false;
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t len = read(watch->fd, buf, sizeof(buf));
+    for (ssize_t i = 0; i < len; ) {
+        const struct inotify_event *event = (const struct inotify_event*)(buf + i);
+        i += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            overflowed = true;
+            continue;
+        }
+        if (event->mask & IN_IGNORED) {
+            _dir_watch_remove(watch, event->wd);
+            continue;
+        }
+
+        const char *dir_path = _dir_watch_get_path(watch, event->wd);
+        if (!dir_path || event->len == 0) {
+            continue;
+        }
+
+        char file_path[GOLF_FILE_MAX_PATH];
+        _create_file_path(file_path, dir_path, event->name);
+        if (event->mask & IN_ISDIR) {
+            // Files can land in a new directory before it is watched, so report everything in it
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                _dir_watch_add(watch, file_path);
+                _directory_recurse(file_path, _dir_watch_add_changed, changed, true);
+            }
+        }
+        else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM)) {
+            map_set(changed, file_path, 1);
+        }
+    }
+    return !overflowed;
+}
+
+bool golf_dir_watch_init(golf_dir_watch_t *watch, const char *dir_name) {
+    watch->fd = inotify_init1(IN_CLOEXEC);
+    if (watch->fd < 0) {
+        return false;
+    }
+
+    snprintf(watch->root, GOLF_FILE_MAX_PATH, "%s", dir_name);
+    vec_init(&watch->wds, "file");
+    vec_init(&watch->dir_paths, "file");
+    _dir_watch_add(watch, dir_name);
+    if (watch->wds.length == 0) {
+        golf_dir_watch_deinit(watch);
+        return false;
+    }
+    return true;
+}
+
+void golf_dir_watch_deinit(golf_dir_watch_t *watch) {
+    for (int i = 0; i < watch->dir_paths.length; i++) {
+        golf_free(watch->dir_paths.data[i]);
+    }
+    vec_deinit(&watch->wds);
+    vec_deinit(&watch->dir_paths);
+    close(watch->fd);
+}
+
+void golf_dir_watch_wait(golf_dir_watch_t *watch, void (*fn)(const char *file_path, void *udata), void *udata) {
+    map_int_t changed;
+    map_init(&changed, "file");
+
+    bool overflowed = false;
+    struct pollfd pfd;
+    pfd.fd = watch->fd;
+    pfd.events = POLLIN;
+    while (changed.base.nnodes == 0 && !overflowed) {
+        if (poll(&pfd, 1, -1) > 0) {
+            overflowed = !_dir_watch_read_events(watch, &changed);
+        }
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (!overflowed) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t elapsed_ms = (int64_t)(now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (elapsed_ms >= GOLF_DIR_WATCH_MAX_BATCH_MS || poll(&pfd, 1, GOLF_DIR_WATCH_SETTLE_MS) <= 0) {
+            break;
+        }
+        overflowed = !_dir_watch_read_events(watch, &changed);
+    }
+
+    if (overflowed) {
+        // Some changes were dropped, so go back to checking every file once
+        golf_dir_recurse(watch->root, fn, udata);
+    }
+    else {
+        const char *key;
+        map_iter_t iter = map_iter(&changed);
+        while ((key = map_next(&changed, &iter))) {
+            fn(key, udata);
+        }
+    }
+
+    map_deinit(&changed);
+}
+
+#else
+
+bool golf_dir_watch_init(golf_dir_watch_t *watch, const char *dir_name) {
+    (void)watch;
+    (void)dir_name;
+    return false;
+}
+
+void golf_dir_watch_deinit(golf_dir_watch_t *watch) {
+    (void)watch;
+}
+
+void golf_dir_watch_wait(golf_dir_watch_t *watch, void (*fn)(const char *file_path, void *udata), void *udata) {
+    (void)watch;
+    (void)fn;
+    (void)udata;
+}
+
+#endif
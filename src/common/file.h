@@ -26,6 +26,26 @@ golf_file_t golf_file_new_ext(golf_file_t *file, const char *ext);
 golf_file_t golf_file_append_extension(const char *path, const char *ext);
 uint64_t golf_file_get_time(const char *path);
 bool golf_file_load_data(const char *path, char **data, int *data_len); 
+// Writes to a temporary file next to path and renames it over path, so readers
+// with the old file mapped never see it truncated
+bool golf_file_save_data(const char *path, const char *data, int data_len);
+
+// A read only view of a whole file, always followed by a null byte. Where POSIX
+// mmap is available the file is memory mapped so nothing is copied, elsewhere
+// it's read into a buffer.
+typedef struct golf_file_view {
+    const char *data;
+    int data_len;
+    // Set when data is memory mapped
+    size_t map_len;
+    // Set when data is a golf_alloc'd buffer that closing the view frees
+    bool owns_data;
+} golf_file_view_t;
+
+bool golf_file_view_open(golf_file_view_t *view, const char *path);
+// Makes an empty view, for when there's no file to look at
+void golf_file_view_empty(golf_file_view_t *view);
+void golf_file_view_close(golf_file_view_t *view);
 const char *golf_file_copy_line(const char *string, char **line_buffer, int *line_buffer_len);
 
 typedef struct golf_dir {
@@ -37,4 +57,23 @@ void golf_dir_recurse(const char *dir_name, void (*fn)(const char *file_path, vo
 void golf_dir_init(golf_dir_t *dir, const char *dir_name, bool recurse);
 void golf_dir_deinit(golf_dir_t *dir);
 
+// Reports files under a directory tree as they are written, using inotify on
+// Linux (not Darwin, even though it defines GOLF_PLATFORM_LINUX).
+// golf_dir_watch_init returns false on other platforms or if the watch can't
+// be set up, callers should fall back to polling with golf_dir_recurse.
+typedef struct golf_dir_watch {
+    int fd;
+    char root[GOLF_FILE_MAX_PATH];
+    // Watch descriptor and path of every watched directory
+    vec_int_t wds;
+    vec_char_ptr_t dir_paths;
+} golf_dir_watch_t;
+
+bool golf_dir_watch_init(golf_dir_watch_t *watch, const char *dir_name);
+void golf_dir_watch_deinit(golf_dir_watch_t *watch);
+// Blocks until something changes, waits for the burst of changes to settle and
+// then calls fn once for each file that was written, created, moved or deleted.
+// Files that were moved away or deleted no longer exist when fn is called.
+void golf_dir_watch_wait(golf_dir_watch_t *watch, void (*fn)(const char *file_path, void *udata), void *udata);
+
 #endif
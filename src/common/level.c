@@ -534,6 +534,9 @@ golf_lightmap_image_t golf_lightmap_image(const char *name, int resolution, int
 }
 
 void golf_lightmap_image_finalize(golf_lightmap_image_t *lightmap) {
+#if GOLF_HEADLESS
+    GOLF_UNUSED(lightmap);
+#else
     for (int s = 0; s < lightmap->num_samples; s++) {
         unsigned char *sg_image_data = golf_alloc(4 * lightmap->width * lightmap->height);
         for (int i = 0; i < 4 * lightmap->width * lightmap->height; i += 4) {
@@ -558,6 +561,7 @@ void golf_lightmap_image_finalize(golf_lightmap_image_t *lightmap) {
         lightmap->sg_image[s] = sg_make_image(&img_desc);
         golf_free(sg_image_data);
     }
+#endif
 }
 
 golf_lightmap_section_t golf_lightmap_section(const char *lightmap_name, vec_vec2_t uvs) {
@@ -568,14 +572,26 @@ golf_lightmap_section_t golf_lightmap_section(const char *lightmap_name, vec_vec
 }
 
 void golf_lightmap_section_finalize(golf_lightmap_section_t *section) {
+#if GOLF_HEADLESS
+    GOLF_UNUSED(section);
+#else
+    // Packed as USHORT2N, the atlas packer keeps lightmap uvs in [0, 1]
+    int num_uvs = section->uvs.length;
+    uint16_t *uvs = golf_alloc(sizeof(uint16_t) * 2 * (num_uvs > 0 ? num_uvs : 1));
+    for (int i = 0; i < num_uvs; i++) {
+        uvs[2 * i + 0] = golf_pack_unorm16(section->uvs.data[i].x);
+        uvs[2 * i + 1] = golf_pack_unorm16(section->uvs.data[i].y);
+    }
     sg_buffer_desc desc = {
         .type = SG_BUFFERTYPE_VERTEXBUFFER,
         .data = {
-            .size = sizeof(vec2) * section->uvs.length,
-            .ptr = section->uvs.data,
+            .size = sizeof(uint16_t) * 2 * num_uvs,
+            .ptr = uvs,
         },
     };
     section->sg_uvs_buf = sg_make_buffer(&desc);
+    golf_free(uvs);
+#endif
 }
 
 static void _stbi_write_func(void *context, void *data, int size) {
@@ -250,11 +250,20 @@ golf_geo_t *golf_entity_get_geo(golf_entity_t *entity);
 vec3 golf_entity_get_velocity(golf_level_t *level, golf_entity_t *entity, float t, vec3 world_point);
 bool golf_level_get_camera_zone(golf_level_t *level, vec3 pos, golf_camera_zone_entity_t *camera_zone);
 
+// A BLAS built when the level was imported, see golf_blas_deserialize
+typedef struct golf_level_bvh {
+    uint32_t hash;
+    int data_len;
+    char *data;
+} golf_level_bvh_t;
+typedef vec_t(golf_level_bvh_t) vec_golf_level_bvh_t;
+
 typedef struct golf_level {
     vec_golf_file_t deps; 
     vec_golf_lightmap_image_t lightmap_images;
     vec_golf_material_t materials;
     vec_golf_entity_t entities;
+    vec_golf_level_bvh_t bvhs;
 } golf_level_t;
 bool golf_level_save(golf_level_t *level, const char *path);
 bool golf_level_get_material(golf_level_t *level, const char *material_name, golf_material_t *out_material);
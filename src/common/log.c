@@ -16,12 +16,18 @@ typedef struct _golf_log_entry {
 typedef struct _golf_log_state {
     int entry_count;
     _golf_log_entry_t entries[32];
+    bool use_stderr;
 } _golf_log_state_t;
 
 _golf_log_state_t _state;
 
 void golf_log_init(void) {
     _state.entry_count = 0;
+    _state.use_stderr = false;
+}
+
+void golf_log_use_stderr(bool use_stderr) {
+    _state.use_stderr = use_stderr;
 }
 
 /*
@@ -51,14 +57,15 @@ static void _log(golf_log_level_t level, const char *fmt, va_list arg) {
     }
     __android_log_vprint(log_level, "golf", fmt, arg);
 #else
+    FILE *out = _state.use_stderr ? stderr : stdout;
     if (level == GOLF_LOG_LEVEL_WARNING) {
-        printf("WARNING: ");
+        fprintf(out, "WARNING: ");
     }
     else if (level == GOLF_LOG_LEVEL_ERROR) {
-        printf("ERROR: ");
+        fprintf(out, "ERROR: ");
     }
-    vprintf(fmt, arg);
-    printf("\n");
+    vfprintf(out, fmt, arg);
+    fprintf(out, "\n");
 #endif
     if (level == GOLF_LOG_LEVEL_WARNING) {
         //_print_callstack();
@@ -1,6 +1,8 @@
 #ifndef _GOLF_LOG_H
 #define _GOLF_LOG_H
 
+#include <stdbool.h>
+
 typedef enum golf_log_level {
     GOLF_LOG_LEVEL_NOTE,
     GOLF_LOG_LEVEL_WARNING,
@@ -8,6 +10,8 @@ typedef enum golf_log_level {
 } golf_log_level_t;
 
 void golf_log_init(void);
+// Keeps stdout clean for tools that print their results there
+void golf_log_use_stderr(bool use_stderr);
 void golf_log(golf_log_level_t level, const char *fmt, ...);
 void golf_log_note(const char *fmt, ...);
 void golf_log_warning(const char *fmt, ...);
@@ -2,6 +2,77 @@
 
 #include <float.h>
 
+// Backend for the batched triangle kernels. Every lane performs exactly the
+// same float operations in the same order as the scalar functions, so the
+// batched results are bit-identical to them.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GOLF_SIMD_WIDTH 8
+typedef __m256 golf_simd_t;
+typedef __m256 golf_simd_mask_t;
+#define _simd_load(p) _mm256_loadu_ps(p)
+#define _simd_store(p, a) _mm256_storeu_ps(p, a)
+#define _simd_set1(f) _mm256_set1_ps(f)
+#define _simd_add(a, b) _mm256_add_ps(a, b)
+#define _simd_sub(a, b) _mm256_sub_ps(a, b)
+#define _simd_mul(a, b) _mm256_mul_ps(a, b)
+#define _simd_div(a, b) _mm256_div_ps(a, b)
+#define _simd_le(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define _simd_ge(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define _simd_lt(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define _simd_gt(a, b) _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define _simd_and(a, b) _mm256_and_ps(a, b)
+#define _simd_or(a, b) _mm256_or_ps(a, b)
+#define _simd_not(a) _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))
+#define _simd_select(m, a, b) _mm256_blendv_ps(b, a, m)
+#define _simd_bits(m) _mm256_movemask_ps(m)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GOLF_SIMD_WIDTH 4
+typedef __m128 golf_simd_t;
+typedef __m128 golf_simd_mask_t;
+#define _simd_load(p) _mm_loadu_ps(p)
+#define _simd_store(p, a) _mm_storeu_ps(p, a)
+#define _simd_set1(f) _mm_set1_ps(f)
+#define _simd_add(a, b) _mm_add_ps(a, b)
+#define _simd_sub(a, b) _mm_sub_ps(a, b)
+#define _simd_mul(a, b) _mm_mul_ps(a, b)
+#define _simd_div(a, b) _mm_div_ps(a, b)
+#define _simd_le(a, b) _mm_cmple_ps(a, b)
+#define _simd_ge(a, b) _mm_cmpge_ps(a, b)
+#define _simd_lt(a, b) _mm_cmplt_ps(a, b)
+#define _simd_gt(a, b) _mm_cmpgt_ps(a, b)
+#define _simd_and(a, b) _mm_and_ps(a, b)
+#define _simd_or(a, b) _mm_or_ps(a, b)
+#define _simd_not(a) _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1)))
+#define _simd_select(m, a, b) _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+#define _simd_bits(m) _mm_movemask_ps(m)
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define GOLF_SIMD_WIDTH 4
+typedef float32x4_t golf_simd_t;
+typedef uint32x4_t golf_simd_mask_t;
+#define _simd_load(p) vld1q_f32(p)
+#define _simd_store(p, a) vst1q_f32(p, a)
+#define _simd_set1(f) vdupq_n_f32(f)
+#define _simd_add(a, b) vaddq_f32(a, b)
+#define _simd_sub(a, b) vsubq_f32(a, b)
+#define _simd_mul(a, b) vmulq_f32(a, b)
+#define _simd_div(a, b) vdivq_f32(a, b)
+#define _simd_le(a, b) vcleq_f32(a, b)
+#define _simd_ge(a, b) vcgeq_f32(a, b)
+#define _simd_lt(a, b) vcltq_f32(a, b)
+#define _simd_gt(a, b) vcgtq_f32(a, b)
+#define _simd_and(a, b) vandq_u32(a, b)
+#define _simd_or(a, b) vorrq_u32(a, b)
+#define _simd_not(a) vmvnq_u32(a)
+#define _simd_select(m, a, b) vbslq_f32(m, a, b)
+static inline int _simd_bits(uint32x4_t m) {
+    static const uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+    return (int)vaddvq_u32(vandq_u32(m, vld1q_u32(lane_bits)));
+}
+#endif
+
 int golf_clampi(int v, int min, int max) {
     if (v < min) {
         v = min;
@@ -22,6 +93,14 @@ float golf_clampf(float v, float min, float max) {
     return v;
 }
 
+int16_t golf_pack_snorm16(float v) {
+    return (int16_t)roundf(golf_clampf(v, -1, 1) * 32767.0f);
+}
+
+uint16_t golf_pack_unorm16(float v) {
+    return (uint16_t)roundf(golf_clampf(v, 0, 1) * 65535.0f);
+}
+
 float golf_snapf(float v, float s) {
     if (s == 0) {
         return v;
@@ -1155,20 +1234,32 @@ bool ray_intersect_triangles_with_transform(vec3 ro, vec3 rd, vec3 *points, int
 }
 
 bool ray_intersect_triangles(vec3 ro, vec3 rd, vec3 *points, int num_points, float *t, int *idx) {
+    // Gather into SoA chunks so the batched kernel can be used
     float min_t = FLT_MAX;
-
-    for (int i = 0; i < num_points; i += 3) {
-        vec3 tp0 = points[i + 0];
-        vec3 tp1 = points[i + 1];
-        vec3 tp2 = points[i + 2];
-
-        float t0 = FLT_MAX;
-        if (intersect_segment_triangle(ro, vec3_add(ro, rd), tp0, tp1, tp2, &t0)) {
-            if (t0 < min_t) {
-                min_t = t0;
-                *idx = (i / 3);
+    int num_triangles = num_points / 3;
+    for (int start = 0; start < num_triangles; start += 64) {
+        float x[9][64];
+        int count = num_triangles - start < 64 ? num_triangles - start : 64;
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < 3; j++) {
+                vec3 tp = points[3 * (start + i) + j];
+                x[3 * j + 0][i] = tp.x;
+                x[3 * j + 1][i] = tp.y;
+                x[3 * j + 2][i] = tp.z;
             }
         }
+
+        triangle_soa_t triangles = {
+            x[0], x[1], x[2],
+            x[3], x[4], x[5],
+            x[6], x[7], x[8],
+        };
+        float t0;
+        int idx0;
+        if (ray_intersect_triangles_soa(ro, rd, triangles, count, &t0, &idx0) && t0 < min_t) {
+            min_t = t0;
+            *idx = start + idx0;
+        }
     }
 
     *t = min_t;
@@ -1308,6 +1399,82 @@ bool sphere_intersect_aabb(vec3 sp, float sr, vec3 aabb_min, vec3 aabb_max) {
     return distance_squared < sr * sr;
 }
 
+// Earliest t in [0, 1] at which the ray ro + t * rd enters the infinite
+// cylinder (a = 0 excluded) or sphere described by a, b and c
+static bool _swept_sphere_quadratic(float a, float b, float c, float *t) {
+    if (a == 0.0f) {
+        return false;
+    }
+    float disc = b * b - 4.0f * a * c;
+    if (disc < 0.0f) {
+        return false;
+    }
+    float t0 = (-b - sqrtf(disc)) / (2.0f * a);
+    if (t0 < 0.0f || t0 > 1.0f) {
+        return false;
+    }
+    *t = t0;
+    return true;
+}
+
+bool swept_sphere_intersect_triangle(vec3 sp, float sr, vec3 d, vec3 a, vec3 b, vec3 c, float *t) {
+    // The sphere first touches either the face of the triangle or, failing that,
+    // the capsules around its edges
+    vec3 n = vec3_cross(vec3_sub(b, a), vec3_sub(c, a));
+    if (vec3_length_squared(n) > 0.0f) {
+        n = vec3_normalize(n);
+        float dist = vec3_dot(vec3_sub(sp, a), n);
+        if (dist < 0.0f) {
+            n = vec3_scale(n, -1.0f);
+            dist = -dist;
+        }
+
+        float speed = -vec3_dot(d, n);
+        if (speed > 0.0f && dist >= sr) {
+            float t0 = (dist - sr) / speed;
+            if (t0 <= 1.0f) {
+                vec3 q = vec3_sub(vec3_add(sp, vec3_scale(d, t0)), vec3_scale(n, sr));
+                triangle_contact_type_t type;
+                closest_point_point_triangle(q, a, b, c, &type);
+                if (type == TRIANGLE_CONTACT_FACE) {
+                    *t = t0;
+                    return true;
+                }
+            }
+        }
+    }
+
+    float min_t = FLT_MAX;
+    vec3 edges[3][2] = { { a, b }, { b, c }, { c, a } };
+    for (int i = 0; i < 3; i++) {
+        vec3 p0 = edges[i][0];
+        vec3 e = vec3_sub(edges[i][1], p0);
+        vec3 m = vec3_sub(sp, p0);
+        float ee = vec3_dot(e, e);
+        float t0;
+
+        // Vertex
+        if (_swept_sphere_quadratic(vec3_dot(d, d), 2.0f * vec3_dot(m, d), vec3_dot(m, m) - sr * sr, &t0) && t0 < min_t) {
+            min_t = t0;
+        }
+
+        // Edge, only counted if the contact is between the two vertices
+        if (ee > 0.0f) {
+            vec3 d_perp = vec3_sub(d, vec3_scale(e, vec3_dot(d, e) / ee));
+            vec3 m_perp = vec3_sub(m, vec3_scale(e, vec3_dot(m, e) / ee));
+            if (_swept_sphere_quadratic(vec3_dot(d_perp, d_perp), 2.0f * vec3_dot(m_perp, d_perp), vec3_dot(m_perp, m_perp) - sr * sr, &t0) && t0 < min_t) {
+                float s = vec3_dot(vec3_add(m, vec3_scale(d, t0)), e) / ee;
+                if (s >= 0.0f && s <= 1.0f) {
+                    min_t = t0;
+                }
+            }
+        }
+    }
+
+    *t = min_t;
+    return min_t < FLT_MAX;
+}
+
 bool sphere_intersect_triangles_with_transform(vec3 sp, float sr, vec3 *points, int num_points, mat4 transform, triangle_contact_type_t *type, bool *hit) {
     bool has_hit = false;
     for (int i = 0; i < num_points; i += 3) {
@@ -1536,6 +1703,252 @@ vec3 closest_point_point_triangle(vec3 p, vec3 a, vec3 b, vec3 c, triangle_conta
     return vec3_add(vec3_add(a, vec3_scale(ab, v)), vec3_scale(ac, w));
 }
 
+triangle_soa_t triangle_soa_offset(triangle_soa_t triangles, int offset) {
+    triangle_soa_t t = {
+        triangles.ax + offset, triangles.ay + offset, triangles.az + offset,
+        triangles.bx + offset, triangles.by + offset, triangles.bz + offset,
+        triangles.cx + offset, triangles.cy + offset, triangles.cz + offset,
+    };
+    return t;
+}
+
+#if defined(GOLF_SIMD_WIDTH)
+
+typedef struct _simd_vec3 {
+    golf_simd_t x, y, z;
+} _simd_vec3_t;
+
+typedef struct _simd_triangles {
+    _simd_vec3_t a, b, c;
+} _simd_triangles_t;
+
+static _simd_vec3_t _simd_vec3_set1(vec3 v) {
+    _simd_vec3_t r = { _simd_set1(v.x), _simd_set1(v.y), _simd_set1(v.z) };
+    return r;
+}
+
+static _simd_vec3_t _simd_vec3_sub(_simd_vec3_t a, _simd_vec3_t b) {
+    _simd_vec3_t r = { _simd_sub(a.x, b.x), _simd_sub(a.y, b.y), _simd_sub(a.z, b.z) };
+    return r;
+}
+
+static _simd_vec3_t _simd_vec3_add(_simd_vec3_t a, _simd_vec3_t b) {
+    _simd_vec3_t r = { _simd_add(a.x, b.x), _simd_add(a.y, b.y), _simd_add(a.z, b.z) };
+    return r;
+}
+
+static _simd_vec3_t _simd_vec3_scale(_simd_vec3_t v, golf_simd_t s) {
+    _simd_vec3_t r = { _simd_mul(s, v.x), _simd_mul(s, v.y), _simd_mul(s, v.z) };
+    return r;
+}
+
+static golf_simd_t _simd_vec3_dot(_simd_vec3_t a, _simd_vec3_t b) {
+    return _simd_add(_simd_add(_simd_mul(a.x, b.x), _simd_mul(a.y, b.y)), _simd_mul(a.z, b.z));
+}
+
+static _simd_vec3_t _simd_vec3_cross(_simd_vec3_t a, _simd_vec3_t b) {
+    _simd_vec3_t r = {
+        _simd_sub(_simd_mul(a.y, b.z), _simd_mul(a.z, b.y)),
+        _simd_sub(_simd_mul(a.z, b.x), _simd_mul(a.x, b.z)),
+        _simd_sub(_simd_mul(a.x, b.y), _simd_mul(a.y, b.x)),
+    };
+    return r;
+}
+
+static _simd_vec3_t _simd_vec3_select(golf_simd_mask_t m, _simd_vec3_t a, _simd_vec3_t b) {
+    _simd_vec3_t r = { _simd_select(m, a.x, b.x), _simd_select(m, a.y, b.y), _simd_select(m, a.z, b.z) };
+    return r;
+}
+
+// Loads up to GOLF_SIMD_WIDTH triangles, padding the unused lanes with zeros
+static _simd_triangles_t _simd_load_triangles(triangle_soa_t triangles, int start, int count) {
+    const float *src[9] = {
+        triangles.ax, triangles.ay, triangles.az,
+        triangles.bx, triangles.by, triangles.bz,
+        triangles.cx, triangles.cy, triangles.cz,
+    };
+    golf_simd_t v[9];
+    for (int i = 0; i < 9; i++) {
+        if (count == GOLF_SIMD_WIDTH) {
+            v[i] = _simd_load(src[i] + start);
+        }
+        else {
+            float padded[GOLF_SIMD_WIDTH] = { 0 };
+            for (int j = 0; j < count; j++) {
+                padded[j] = src[i][start + j];
+            }
+            v[i] = _simd_load(padded);
+        }
+    }
+
+    _simd_triangles_t r = {
+        { v[0], v[1], v[2] },
+        { v[3], v[4], v[5] },
+        { v[6], v[7], v[8] },
+    };
+    return r;
+}
+
+bool ray_intersect_triangles_soa(vec3 ro, vec3 rd, triangle_soa_t triangles, int num_triangles, float *t, int *idx) {
+    // Same as intersect_segment_triangle with p = ro, q = ro + rd
+    vec3 qp = vec3_subtract(ro, vec3_add(ro, rd));
+    _simd_vec3_t p4 = _simd_vec3_set1(ro);
+    _simd_vec3_t qp4 = _simd_vec3_set1(qp);
+    golf_simd_t zero = _simd_set1(0.0f);
+    golf_simd_t one = _simd_set1(1.0f);
+
+    float min_t = FLT_MAX;
+    for (int start = 0; start < num_triangles; start += GOLF_SIMD_WIDTH) {
+        int count = num_triangles - start;
+        if (count > GOLF_SIMD_WIDTH) count = GOLF_SIMD_WIDTH;
+        _simd_triangles_t tri = _simd_load_triangles(triangles, start, count);
+
+        _simd_vec3_t ab = _simd_vec3_sub(tri.b, tri.a);
+        _simd_vec3_t ac = _simd_vec3_sub(tri.c, tri.a);
+        _simd_vec3_t n = _simd_vec3_cross(ab, ac);
+        golf_simd_t d = _simd_vec3_dot(qp4, n);
+        _simd_vec3_t ap = _simd_vec3_sub(p4, tri.a);
+        golf_simd_t t4 = _simd_vec3_dot(ap, n);
+        _simd_vec3_t e = _simd_vec3_cross(qp4, ap);
+        golf_simd_t v = _simd_vec3_dot(ac, e);
+        // w = -dot(ab, e), so w < 0 is nw > 0 and v + w is v - nw
+        golf_simd_t nw = _simd_vec3_dot(ab, e);
+
+        golf_simd_mask_t fail = _simd_le(d, zero);
+        fail = _simd_or(fail, _simd_lt(t4, zero));
+        fail = _simd_or(fail, _simd_lt(v, zero));
+        fail = _simd_or(fail, _simd_gt(v, d));
+        fail = _simd_or(fail, _simd_gt(nw, zero));
+        fail = _simd_or(fail, _simd_gt(_simd_sub(v, nw), d));
+        int hit_bits = _simd_bits(_simd_not(fail));
+        if (!hit_bits) continue;
+
+        float lane_t[GOLF_SIMD_WIDTH];
+        t4 = _simd_mul(t4, _simd_div(one, d));
+        _simd_store(lane_t, t4);
+        for (int i = 0; i < count; i++) {
+            if ((hit_bits & (1 << i)) && lane_t[i] < min_t) {
+                min_t = lane_t[i];
+                *idx = start + i;
+            }
+        }
+    }
+
+    *t = min_t;
+    return min_t < FLT_MAX;
+}
+
+void closest_point_point_triangles_soa(vec3 p, triangle_soa_t triangles, int num_triangles, vec3 *closest_points, triangle_contact_type_t *types) {
+    // Evaluates every region of closest_point_point_triangle and blends the
+    // results from the lowest to the highest priority region
+    _simd_vec3_t p4 = _simd_vec3_set1(p);
+    golf_simd_t zero = _simd_set1(0.0f);
+    golf_simd_t one = _simd_set1(1.0f);
+
+    for (int start = 0; start < num_triangles; start += GOLF_SIMD_WIDTH) {
+        int count = num_triangles - start;
+        if (count > GOLF_SIMD_WIDTH) count = GOLF_SIMD_WIDTH;
+        _simd_triangles_t tri = _simd_load_triangles(triangles, start, count);
+
+        _simd_vec3_t ab = _simd_vec3_sub(tri.b, tri.a);
+        _simd_vec3_t ac = _simd_vec3_sub(tri.c, tri.a);
+        _simd_vec3_t ap = _simd_vec3_sub(p4, tri.a);
+        golf_simd_t d1 = _simd_vec3_dot(ab, ap);
+        golf_simd_t d2 = _simd_vec3_dot(ac, ap);
+        golf_simd_mask_t in_a = _simd_and(_simd_le(d1, zero), _simd_le(d2, zero));
+
+        _simd_vec3_t bp = _simd_vec3_sub(p4, tri.b);
+        golf_simd_t d3 = _simd_vec3_dot(ab, bp);
+        golf_simd_t d4 = _simd_vec3_dot(ac, bp);
+        golf_simd_mask_t in_b = _simd_and(_simd_ge(d3, zero), _simd_le(d4, d3));
+
+        golf_simd_t vc = _simd_sub(_simd_mul(d1, d4), _simd_mul(d3, d2));
+        golf_simd_mask_t in_ab = _simd_and(_simd_and(_simd_le(vc, zero), _simd_ge(d1, zero)), _simd_le(d3, zero));
+        golf_simd_t v_ab = _simd_div(d1, _simd_sub(d1, d3));
+        _simd_vec3_t p_ab = _simd_vec3_add(tri.a, _simd_vec3_scale(ab, v_ab));
+
+        _simd_vec3_t cp = _simd_vec3_sub(p4, tri.c);
+        golf_simd_t d5 = _simd_vec3_dot(ab, cp);
+        golf_simd_t d6 = _simd_vec3_dot(ac, cp);
+        golf_simd_mask_t in_c = _simd_and(_simd_ge(d6, zero), _simd_le(d5, d6));
+
+        golf_simd_t vb = _simd_sub(_simd_mul(d5, d2), _simd_mul(d1, d6));
+        golf_simd_mask_t in_ac = _simd_and(_simd_and(_simd_le(vb, zero), _simd_ge(d2, zero)), _simd_le(d6, zero));
+        golf_simd_t w_ac = _simd_div(d2, _simd_sub(d2, d6));
+        _simd_vec3_t p_ac = _simd_vec3_add(tri.a, _simd_vec3_scale(ac, w_ac));
+
+        golf_simd_t va = _simd_sub(_simd_mul(d3, d6), _simd_mul(d5, d4));
+        golf_simd_t d43 = _simd_sub(d4, d3);
+        golf_simd_t d56 = _simd_sub(d5, d6);
+        golf_simd_mask_t in_bc = _simd_and(_simd_and(_simd_le(va, zero), _simd_ge(d43, zero)), _simd_ge(d56, zero));
+        golf_simd_t w_bc = _simd_div(d43, _simd_add(d43, d56));
+        _simd_vec3_t p_bc = _simd_vec3_add(tri.b, _simd_vec3_scale(_simd_vec3_sub(tri.c, tri.b), w_bc));
+
+        golf_simd_t denom = _simd_div(one, _simd_add(_simd_add(va, vb), vc));
+        golf_simd_t v_face = _simd_mul(vb, denom);
+        golf_simd_t w_face = _simd_mul(vc, denom);
+        _simd_vec3_t closest = _simd_vec3_add(_simd_vec3_add(tri.a, _simd_vec3_scale(ab, v_face)), _simd_vec3_scale(ac, w_face));
+
+        closest = _simd_vec3_select(in_bc, p_bc, closest);
+        closest = _simd_vec3_select(in_ac, p_ac, closest);
+        closest = _simd_vec3_select(in_c, tri.c, closest);
+        closest = _simd_vec3_select(in_ab, p_ab, closest);
+        closest = _simd_vec3_select(in_b, tri.b, closest);
+        closest = _simd_vec3_select(in_a, tri.a, closest);
+
+        float x[GOLF_SIMD_WIDTH], y[GOLF_SIMD_WIDTH], z[GOLF_SIMD_WIDTH];
+        _simd_store(x, closest.x);
+        _simd_store(y, closest.y);
+        _simd_store(z, closest.z);
+        int bits_a = _simd_bits(in_a), bits_b = _simd_bits(in_b), bits_ab = _simd_bits(in_ab);
+        int bits_c = _simd_bits(in_c), bits_ac = _simd_bits(in_ac), bits_bc = _simd_bits(in_bc);
+        for (int i = 0; i < count; i++) {
+            int bit = 1 << i;
+            closest_points[start + i] = V3(x[i], y[i], z[i]);
+            if (bits_a & bit) types[start + i] = TRIANGLE_CONTACT_A;
+            else if (bits_b & bit) types[start + i] = TRIANGLE_CONTACT_B;
+            else if (bits_ab & bit) types[start + i] = TRIANGLE_CONTACT_AB;
+            else if (bits_c & bit) types[start + i] = TRIANGLE_CONTACT_C;
+            else if (bits_ac & bit) types[start + i] = TRIANGLE_CONTACT_AC;
+            else if (bits_bc & bit) types[start + i] = TRIANGLE_CONTACT_BC;
+            else types[start + i] = TRIANGLE_CONTACT_FACE;
+        }
+    }
+}
+
+#else
+
+bool ray_intersect_triangles_soa(vec3 ro, vec3 rd, triangle_soa_t triangles, int num_triangles, float *t, int *idx) {
+    float min_t = FLT_MAX;
+    for (int i = 0; i < num_triangles; i++) {
+        vec3 a = V3(triangles.ax[i], triangles.ay[i], triangles.az[i]);
+        vec3 b = V3(triangles.bx[i], triangles.by[i], triangles.bz[i]);
+        vec3 c = V3(triangles.cx[i], triangles.cy[i], triangles.cz[i]);
+
+        float t0 = FLT_MAX;
+        if (intersect_segment_triangle(ro, vec3_add(ro, rd), a, b, c, &t0)) {
+            if (t0 < min_t) {
+                min_t = t0;
+                *idx = i;
+            }
+        }
+    }
+
+    *t = min_t;
+    return min_t < FLT_MAX;
+}
+
+void closest_point_point_triangles_soa(vec3 p, triangle_soa_t triangles, int num_triangles, vec3 *closest_points, triangle_contact_type_t *types) {
+    for (int i = 0; i < num_triangles; i++) {
+        vec3 a = V3(triangles.ax[i], triangles.ay[i], triangles.az[i]);
+        vec3 b = V3(triangles.bx[i], triangles.by[i], triangles.bz[i]);
+        vec3 c = V3(triangles.cx[i], triangles.cy[i], triangles.cz[i]);
+        closest_points[i] = closest_point_point_triangle(p, a, b, c, &types[i]);
+    }
+}
+
+#endif
+
 vec3 closest_point_point_obb(vec3 p, vec3 bc, vec3 bx, vec3 by, vec3 bz, float bex, float bey, float bez) {
     vec3 bu[3] = {bx, by, bz};
     float be[3] = {bex, bey, bez};
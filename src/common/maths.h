@@ -5,6 +5,7 @@
 #include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -17,6 +18,9 @@
 
 int golf_clampi(int v, int min, int max);
 float golf_clampf(float v, float min, float max);
+// Packs into the range the SHORT*N and USHORT*N vertex formats expand back from
+int16_t golf_pack_snorm16(float v);
+uint16_t golf_pack_unorm16(float v);
 float golf_snapf(float v, float s);
 float golf_randf(float min, float max);
 
@@ -229,14 +233,25 @@ typedef enum triangle_contact_type {
     TRIANGLE_CONTACT_FACE,
 } triangle_contact_type_t;
 
+// Triangles stored as one array per vertex component, used by the batched
+// triangle tests which process several triangles at a time
+typedef struct triangle_soa {
+    const float *ax, *ay, *az;
+    const float *bx, *by, *bz;
+    const float *cx, *cy, *cz;
+} triangle_soa_t;
+triangle_soa_t triangle_soa_offset(triangle_soa_t triangles, int offset);
+
 void ray_intersect_triangles_all(vec3 ro, vec3 rd, vec3 *points, int num_points, mat4 transform, float *t);
 bool ray_intersect_triangles_with_transform(vec3 ro, vec3 rd, vec3 *points, int num_points, mat4 transform, float *t, int *idx);
 bool ray_intersect_triangles(vec3 ro, vec3 rd, vec3 *points, int num_points, float *t, int *idx);
+bool ray_intersect_triangles_soa(vec3 ro, vec3 rd, triangle_soa_t triangles, int num_triangles, float *t, int *idx);
 bool ray_intersect_spheres(vec3 ro, vec3 rd, vec3 *center, float *radius, int num_spheres, float *t, int *idx);
 bool ray_intersect_segments(vec3 ro, vec3 rd, vec3 *p0, vec3 *p1, float *radius, int num_segments, float *t, int *idx);
 bool ray_intersect_planes(vec3 ro, vec3 rd, vec3 *p, vec3 *n, int num_planes, float *t, int *idx);
 bool ray_intersect_aabb(vec3 ro, vec3 rd, vec3 aabb_min, vec3 aabb_max, float *t);
 bool sphere_intersect_aabb(vec3 sp, float sr, vec3 aabb_min, vec3 aabb_max);
+bool swept_sphere_intersect_triangle(vec3 sp, float sr, vec3 d, vec3 a, vec3 b, vec3 c, float *t);
 bool sphere_intersect_triangles_with_transform(vec3 sp, float sr, vec3 *points, int num_points, mat4 transform, triangle_contact_type_t *type, bool *hit);
 void triangles_inside_box(vec3 *triangle_points, int num_triangles, vec3 box_center, vec3 box_half_lengths,
         bool *is_inside);
@@ -246,6 +261,7 @@ vec3 closest_point_point_plane(vec3 point, vec3 plane_point, vec3 plane_normal);
 vec3 closest_point_point_circle(vec3 point, vec3 circle_center, vec3 circle_plane, float circle_radius);
 
 vec3 closest_point_point_triangle(vec3 p, vec3 a, vec3 b, vec3 c, enum triangle_contact_type *type);
+void closest_point_point_triangles_soa(vec3 p, triangle_soa_t triangles, int num_triangles, vec3 *closest_points, triangle_contact_type_t *types);
 vec3 closest_point_point_obb(vec3 p, vec3 bc, vec3 bx, vec3 by, vec3 bz, float bex, float bey, float bez);
 float closest_point_ray_segment(vec3 p1, vec3 q1, vec3 p2, vec3 q2, float *s, float *t, vec3 *c1, vec3 *c2);
 float closest_point_ray_ray(vec3 p1, vec3 q1, vec3 p2, vec3 q2, float *s, float *t, vec3 *c1, vec3 *c2);
@@ -0,0 +1,119 @@
+#include "common/pack.h"
+
+#include <string.h>
+
+#include "miniz/miniz.h"
+#include "common/alloc.h"
+#include "common/log.h"
+
+// FNV-1a, tools/golf_pack computes the same hash when it builds the index
+uint32_t golf_pack_hash_path(const char *path) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char*)path; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool _golf_pack_has_range(int data_len, uint32_t offset, uint64_t size) {
+    return (uint64_t)offset + size <= (uint64_t)data_len;
+}
+
+bool golf_pack_init(golf_pack_t *pack, const char *data, int data_len) {
+    memset(pack, 0, sizeof(golf_pack_t));
+    if ((uintptr_t)data % sizeof(uint32_t) != 0 || data_len < (int)sizeof(golf_pack_header_t)) {
+        return false;
+    }
+
+    const golf_pack_header_t *header = (const golf_pack_header_t*)data;
+    if (memcmp(header->magic, GOLF_PACK_MAGIC, 4) != 0 || header->version != GOLF_PACK_VERSION ||
+            header->data_len != (uint32_t)data_len) {
+        return false;
+    }
+    if (header->num_slots == 0 || (header->num_slots & (header->num_slots - 1)) != 0 ||
+            header->num_slots < header->num_entries ||
+            !_golf_pack_has_range(data_len, header->entries_offset, (uint64_t)header->num_entries * sizeof(golf_pack_entry_t)) ||
+            !_golf_pack_has_range(data_len, header->slots_offset, (uint64_t)header->num_slots * sizeof(uint32_t)) ||
+            !_golf_pack_has_range(data_len, header->paths_offset, 0)) {
+        return false;
+    }
+
+    // Check every entry once here so lookups don't have to
+    const golf_pack_entry_t *entries = (const golf_pack_entry_t*)(data + header->entries_offset);
+    for (uint32_t i = 0; i < header->num_entries; i++) {
+        const golf_pack_entry_t *entry = &entries[i];
+        uint64_t stored_size = entry->stored_size;
+        if (!(entry->flags & GOLF_PACK_ENTRY_COMPRESSED)) {
+            if (entry->stored_size != entry->size) {
+                return false;
+            }
+            stored_size++;
+        }
+        if (entry->path_offset < header->paths_offset || !_golf_pack_has_range(data_len, entry->path_offset, 1) ||
+                !memchr(data + entry->path_offset, 0, data_len - entry->path_offset) ||
+                entry->data_offset % GOLF_PACK_ALIGNMENT != 0 ||
+                !_golf_pack_has_range(data_len, entry->data_offset, stored_size) ||
+                entry->size > INT32_MAX - 1) {
+            return false;
+        }
+    }
+
+    pack->data = data;
+    pack->header = header;
+    pack->entries = entries;
+    pack->slots = (const uint32_t*)(data + header->slots_offset);
+    return true;
+}
+
+const golf_pack_entry_t *golf_pack_find(golf_pack_t *pack, const char *path) {
+    if (!pack->header) {
+        return NULL;
+    }
+
+    uint32_t hash = golf_pack_hash_path(path);
+    uint32_t mask = pack->header->num_slots - 1;
+    for (uint32_t i = 0; i < pack->header->num_slots; i++) {
+        uint32_t entry_idx = pack->slots[(hash + i) & mask];
+        if (entry_idx == GOLF_PACK_EMPTY_SLOT || entry_idx >= pack->header->num_entries) {
+            return NULL;
+        }
+
+        const golf_pack_entry_t *entry = &pack->entries[entry_idx];
+        if (entry->path_hash == hash && strcmp(pack->data + entry->path_offset, path) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+const char *golf_pack_get_path(golf_pack_t *pack, const golf_pack_entry_t *entry) {
+    return pack->data + entry->path_offset;
+}
+
+bool golf_pack_open(golf_pack_t *pack, const golf_pack_entry_t *entry, golf_file_view_t *view) {
+    const char *stored = pack->data + entry->data_offset;
+    if (!(entry->flags & GOLF_PACK_ENTRY_COMPRESSED)) {
+        view->data = stored;
+        view->data_len = (int)entry->size;
+        view->map_len = 0;
+        view->owns_data = false;
+        return true;
+    }
+
+    char *data = golf_alloc(entry->size + 1);
+    size_t size = tinfl_decompress_mem_to_mem(data, entry->size, stored, entry->stored_size,
+            TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    if (size != entry->size) {
+        golf_log_warning("Unable to inflate %s from the data pack", golf_pack_get_path(pack, entry));
+        golf_free(data);
+        return false;
+    }
+    data[entry->size] = 0;
+
+    view->data = data;
+    view->data_len = (int)entry->size;
+    view->map_len = 0;
+    view->owns_data = true;
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef _GOLF_PACK_H
+#define _GOLF_PACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/file.h"
+
+// Data pack layout, all values little endian and every offset from the start of the pack:
+//   header, entries sorted by path, hash slots, null terminated paths, entry data
+// Each entry's data starts on a GOLF_PACK_ALIGNMENT boundary. Entries that didn't
+// compress well are stored as is with a null byte after them, so they can be
+// used straight out of the pack. Compressed entries are raw deflate.
+#define GOLF_PACK_MAGIC "GPAK"
+#define GOLF_PACK_VERSION 1
+#define GOLF_PACK_ALIGNMENT 16
+#define GOLF_PACK_EMPTY_SLOT 0xFFFFFFFFu
+
+#define GOLF_PACK_ENTRY_COMPRESSED 1
+
+typedef struct golf_pack_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_entries;
+    // A power of two, the slot for a path is its hash masked by num_slots - 1
+    // and collisions probe linearly from there
+    uint32_t num_slots;
+    uint32_t entries_offset, slots_offset, paths_offset;
+    uint32_t data_len;
+} golf_pack_header_t;
+
+typedef struct golf_pack_entry {
+    uint32_t path_hash;
+    uint32_t path_offset;
+    uint32_t data_offset;
+    // Bytes in the pack, less than size when the entry is compressed
+    uint32_t stored_size;
+    uint32_t size;
+    uint32_t flags;
+} golf_pack_entry_t;
+
+typedef struct golf_pack {
+    const char *data;
+    const golf_pack_header_t *header;
+    const golf_pack_entry_t *entries;
+    const uint32_t *slots;
+} golf_pack_t;
+
+// The data has to stay around for as long as the pack is used
+bool golf_pack_init(golf_pack_t *pack, const char *data, int data_len);
+uint32_t golf_pack_hash_path(const char *path);
+const golf_pack_entry_t *golf_pack_find(golf_pack_t *pack, const char *path);
+const char *golf_pack_get_path(golf_pack_t *pack, const golf_pack_entry_t *entry);
+// Uncompressed entries are viewed in place, compressed ones are inflated into a new buffer
+bool golf_pack_open(golf_pack_t *pack, const golf_pack_entry_t *entry, golf_file_view_t *view);
+
+#endif
@@ -0,0 +1,122 @@
+#include "common/shader_uniforms.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define MEMBER(type, field) { #field, (int)offsetof(type, field), (int)sizeof(((type*)0)->field) }
+
+static const golf_shader_uniform_layout_t _layouts[GOLF_UNIFORMS_COUNT] = {
+    [GOLF_UNIFORMS_AIM_LINE_VS_PARAMS] = { "data/shaders/aim_line.glsl", true, "aim_line_vs_params", sizeof(golf_aim_line_vs_params_t), 1, {
+        MEMBER(golf_aim_line_vs_params_t, mvp_mat),
+    } },
+    [GOLF_UNIFORMS_AIM_LINE_FS_PARAMS] = { "data/shaders/aim_line.glsl", false, "aim_line_fs_params", sizeof(golf_aim_line_fs_params_t), 6, {
+        MEMBER(golf_aim_line_fs_params_t, color),
+        MEMBER(golf_aim_line_fs_params_t, texture_coord_offset),
+        MEMBER(golf_aim_line_fs_params_t, texture_coord_scale),
+        MEMBER(golf_aim_line_fs_params_t, length0),
+        MEMBER(golf_aim_line_fs_params_t, length1),
+        MEMBER(golf_aim_line_fs_params_t, total_length),
+    } },
+    [GOLF_UNIFORMS_BALL_VS_PARAMS] = { "data/shaders/ball.glsl", true, "ball_vs_params", sizeof(golf_ball_vs_params_t), 2, {
+        MEMBER(golf_ball_vs_params_t, proj_view_mat),
+        MEMBER(golf_ball_vs_params_t, model_mat),
+    } },
+    [GOLF_UNIFORMS_BALL_FS_PARAMS] = { "data/shaders/ball.glsl", false, "ball_fs_params", sizeof(golf_ball_fs_params_t), 1, {
+        MEMBER(golf_ball_fs_params_t, color),
+    } },
+    [GOLF_UNIFORMS_BALL_HIDDEN_VS_PARAMS] = { "data/shaders/ball_hidden.glsl", true, "vs_params", sizeof(golf_ball_hidden_vs_params_t), 2, {
+        MEMBER(golf_ball_hidden_vs_params_t, model_mat),
+        MEMBER(golf_ball_hidden_vs_params_t, proj_view_mat),
+    } },
+    [GOLF_UNIFORMS_BALL_HIDDEN_FS_PARAMS] = { "data/shaders/ball_hidden.glsl", false, "fs_params", sizeof(golf_ball_hidden_fs_params_t), 2, {
+        MEMBER(golf_ball_hidden_fs_params_t, ball_position),
+        MEMBER(golf_ball_hidden_fs_params_t, cam_position),
+    } },
+    [GOLF_UNIFORMS_DIFFUSE_COLOR_MATERIAL_VS_PARAMS] = { "data/shaders/diffuse_color_material.glsl", true, "diffuse_color_material_vs_params", sizeof(golf_diffuse_color_material_vs_params_t), 2, {
+        MEMBER(golf_diffuse_color_material_vs_params_t, proj_view_mat),
+        MEMBER(golf_diffuse_color_material_vs_params_t, model_mat),
+    } },
+    [GOLF_UNIFORMS_DIFFUSE_COLOR_MATERIAL_FS_PARAMS] = { "data/shaders/diffuse_color_material.glsl", false, "diffuse_color_material_fs_params", sizeof(golf_diffuse_color_material_fs_params_t), 1, {
+        MEMBER(golf_diffuse_color_material_fs_params_t, color),
+    } },
+    [GOLF_UNIFORMS_EDITOR_WATER_VS_PARAMS] = { "data/shaders/editor_water.glsl", true, "editor_water_vs_params", sizeof(golf_editor_water_vs_params_t), 2, {
+        MEMBER(golf_editor_water_vs_params_t, proj_view_mat),
+        MEMBER(golf_editor_water_vs_params_t, model_mat),
+    } },
+    [GOLF_UNIFORMS_EDITOR_WATER_FS_PARAMS] = { "data/shaders/editor_water.glsl", false, "editor_water_fs_params", sizeof(golf_editor_water_fs_params_t), 2, {
+        MEMBER(golf_editor_water_fs_params_t, draw_type),
+        MEMBER(golf_editor_water_fs_params_t, t),
+    } },
+    [GOLF_UNIFORMS_ENVIRONMENT_MATERIAL_VS_PARAMS] = { "data/shaders/environment_material.glsl", true, "environment_material_vs_params", sizeof(golf_environment_material_vs_params_t), 2, {
+        MEMBER(golf_environment_material_vs_params_t, model_mat),
+        MEMBER(golf_environment_material_vs_params_t, proj_view_mat),
+    } },
+    [GOLF_UNIFORMS_ENVIRONMENT_MATERIAL_FS_PARAMS] = { "data/shaders/environment_material.glsl", false, "environment_material_fs_params", sizeof(golf_environment_material_fs_params_t), 3, {
+        MEMBER(golf_environment_material_fs_params_t, ball_position),
+        MEMBER(golf_environment_material_fs_params_t, lightmap_texture_a),
+        MEMBER(golf_environment_material_fs_params_t, uv_scale),
+    } },
+    [GOLF_UNIFORMS_PASS_THROUGH_VS_PARAMS] = { "data/shaders/pass_through.glsl", true, "pass_through_vs_params", sizeof(golf_pass_through_vs_params_t), 1, {
+        MEMBER(golf_pass_through_vs_params_t, mvp_mat),
+    } },
+    [GOLF_UNIFORMS_SOLID_COLOR_MATERIAL_VS_PARAMS] = { "data/shaders/solid_color_material.glsl", true, "solid_color_material_vs_params", sizeof(golf_solid_color_material_vs_params_t), 1, {
+        MEMBER(golf_solid_color_material_vs_params_t, mvp_mat),
+    } },
+    [GOLF_UNIFORMS_SOLID_COLOR_MATERIAL_FS_PARAMS] = { "data/shaders/solid_color_material.glsl", false, "solid_color_material_fs_params", sizeof(golf_solid_color_material_fs_params_t), 1, {
+        MEMBER(golf_solid_color_material_fs_params_t, color),
+    } },
+    [GOLF_UNIFORMS_TEXTURE_MATERIAL_VS_PARAMS] = { "data/shaders/texture_material.glsl", true, "texture_material_vs_params", sizeof(golf_texture_material_vs_params_t), 2, {
+        MEMBER(golf_texture_material_vs_params_t, model_mat),
+        MEMBER(golf_texture_material_vs_params_t, proj_view_mat),
+    } },
+    [GOLF_UNIFORMS_TEXTURE_MATERIAL_FS_PARAMS] = { "data/shaders/texture_material.glsl", false, "fs_params", sizeof(golf_texture_material_fs_params_t), 1, {
+        MEMBER(golf_texture_material_fs_params_t, alpha),
+    } },
+    [GOLF_UNIFORMS_UI_VS_PARAMS] = { "data/shaders/ui.glsl", true, "ui_vs_params", sizeof(golf_ui_vs_params_t), 1, {
+        MEMBER(golf_ui_vs_params_t, mvp_mat),
+    } },
+    [GOLF_UNIFORMS_UI_FS_PARAMS] = { "data/shaders/ui.glsl", false, "ui_fs_params", sizeof(golf_ui_fs_params_t), 7, {
+        MEMBER(golf_ui_fs_params_t, color),
+        MEMBER(golf_ui_fs_params_t, alpha),
+        MEMBER(golf_ui_fs_params_t, tex_x),
+        MEMBER(golf_ui_fs_params_t, tex_y),
+        MEMBER(golf_ui_fs_params_t, tex_dx),
+        MEMBER(golf_ui_fs_params_t, tex_dy),
+        MEMBER(golf_ui_fs_params_t, is_font),
+    } },
+    [GOLF_UNIFORMS_WATER_VS_PARAMS] = { "data/shaders/water.glsl", true, "water_vs_params", sizeof(golf_water_vs_params_t), 2, {
+        MEMBER(golf_water_vs_params_t, proj_view_mat),
+        MEMBER(golf_water_vs_params_t, model_mat),
+    } },
+    [GOLF_UNIFORMS_WATER_FS_PARAMS] = { "data/shaders/water.glsl", false, "water_fs_params", sizeof(golf_water_fs_params_t), 1, {
+        MEMBER(golf_water_fs_params_t, t),
+    } },
+    [GOLF_UNIFORMS_WATER_AROUND_BALL_VS_PARAMS] = { "data/shaders/water_around_ball.glsl", true, "vs_params", sizeof(golf_water_around_ball_vs_params_t), 1, {
+        MEMBER(golf_water_around_ball_vs_params_t, mvp_mat),
+    } },
+    [GOLF_UNIFORMS_WATER_AROUND_BALL_FS_PARAMS] = { "data/shaders/water_around_ball.glsl", false, "fs_params", sizeof(golf_water_around_ball_fs_params_t), 1, {
+        MEMBER(golf_water_around_ball_fs_params_t, t),
+    } },
+    [GOLF_UNIFORMS_WATER_RIPPLE_VS_PARAMS] = { "data/shaders/water_ripple.glsl", true, "vs_params", sizeof(golf_water_ripple_vs_params_t), 1, {
+        MEMBER(golf_water_ripple_vs_params_t, mvp_mat),
+    } },
+    [GOLF_UNIFORMS_WATER_RIPPLE_FS_PARAMS] = { "data/shaders/water_ripple.glsl", false, "fs_params", sizeof(golf_water_ripple_fs_params_t), 2, {
+        MEMBER(golf_water_ripple_fs_params_t, t),
+        MEMBER(golf_water_ripple_fs_params_t, uniform_color),
+    } },
+};
+
+const golf_shader_uniform_layout_t *golf_shader_uniform_layout_get(golf_shader_uniform_block_type_t type) {
+    return &_layouts[type];
+}
+
+const golf_shader_uniform_layout_t *golf_shader_uniform_layout_find(const char *shader_path, bool is_vs, const char *name, golf_shader_uniform_block_type_t *type) {
+    for (int i = 0; i < GOLF_UNIFORMS_COUNT; i++) {
+        const golf_shader_uniform_layout_t *layout = &_layouts[i];
+        if (layout->is_vs == is_vs && strcmp(layout->shader_path, shader_path) == 0 && strcmp(layout->name, name) == 0) {
+            *type = (golf_shader_uniform_block_type_t)i;
+            return layout;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,194 @@
+#ifndef _GOLF_SHADER_UNIFORMS_H
+#define _GOLF_SHADER_UNIFORMS_H
+
+#include <stdbool.h>
+
+#include "common/maths.h"
+
+// C versions of the uniform blocks in data/shaders, laid out to match the std140
+// offsets in each shader's .golf_data reflection. A shader checks its blocks against
+// these when it loads, so draws can fill in a struct and apply it by handle rather
+// than setting each member by name. Keep them in step with the shaders.
+
+typedef enum golf_shader_uniform_block_type {
+    GOLF_UNIFORMS_AIM_LINE_VS_PARAMS,
+    GOLF_UNIFORMS_AIM_LINE_FS_PARAMS,
+    GOLF_UNIFORMS_BALL_VS_PARAMS,
+    GOLF_UNIFORMS_BALL_FS_PARAMS,
+    GOLF_UNIFORMS_BALL_HIDDEN_VS_PARAMS,
+    GOLF_UNIFORMS_BALL_HIDDEN_FS_PARAMS,
+    GOLF_UNIFORMS_DIFFUSE_COLOR_MATERIAL_VS_PARAMS,
+    GOLF_UNIFORMS_DIFFUSE_COLOR_MATERIAL_FS_PARAMS,
+    GOLF_UNIFORMS_EDITOR_WATER_VS_PARAMS,
+    GOLF_UNIFORMS_EDITOR_WATER_FS_PARAMS,
+    GOLF_UNIFORMS_ENVIRONMENT_MATERIAL_VS_PARAMS,
+    GOLF_UNIFORMS_ENVIRONMENT_MATERIAL_FS_PARAMS,
+    GOLF_UNIFORMS_PASS_THROUGH_VS_PARAMS,
+    GOLF_UNIFORMS_SOLID_COLOR_MATERIAL_VS_PARAMS,
+    GOLF_UNIFORMS_SOLID_COLOR_MATERIAL_FS_PARAMS,
+    GOLF_UNIFORMS_TEXTURE_MATERIAL_VS_PARAMS,
+    GOLF_UNIFORMS_TEXTURE_MATERIAL_FS_PARAMS,
+    GOLF_UNIFORMS_UI_VS_PARAMS,
+    GOLF_UNIFORMS_UI_FS_PARAMS,
+    GOLF_UNIFORMS_WATER_VS_PARAMS,
+    GOLF_UNIFORMS_WATER_FS_PARAMS,
+    GOLF_UNIFORMS_WATER_AROUND_BALL_VS_PARAMS,
+    GOLF_UNIFORMS_WATER_AROUND_BALL_FS_PARAMS,
+    GOLF_UNIFORMS_WATER_RIPPLE_VS_PARAMS,
+    GOLF_UNIFORMS_WATER_RIPPLE_FS_PARAMS,
+    GOLF_UNIFORMS_COUNT,
+} golf_shader_uniform_block_type_t;
+
+typedef struct golf_aim_line_vs_params {
+    mat4 mvp_mat;
+} golf_aim_line_vs_params_t;
+
+typedef struct golf_aim_line_fs_params {
+    vec4 color;
+    vec2 texture_coord_offset;
+    vec2 texture_coord_scale;
+    float length0;
+    float length1;
+    float total_length;
+    float _pad0[1];
+} golf_aim_line_fs_params_t;
+
+typedef struct golf_ball_vs_params {
+    mat4 proj_view_mat;
+    mat4 model_mat;
+} golf_ball_vs_params_t;
+
+typedef struct golf_ball_fs_params {
+    vec4 color;
+} golf_ball_fs_params_t;
+
+typedef struct golf_ball_hidden_vs_params {
+    mat4 model_mat;
+    mat4 proj_view_mat;
+} golf_ball_hidden_vs_params_t;
+
+typedef struct golf_ball_hidden_fs_params {
+    vec4 ball_position;
+    vec4 cam_position;
+} golf_ball_hidden_fs_params_t;
+
+typedef struct golf_diffuse_color_material_vs_params {
+    mat4 proj_view_mat;
+    mat4 model_mat;
+} golf_diffuse_color_material_vs_params_t;
+
+typedef struct golf_diffuse_color_material_fs_params {
+    vec3 color;
+    float _pad0[1];
+} golf_diffuse_color_material_fs_params_t;
+
+typedef struct golf_editor_water_vs_params {
+    mat4 proj_view_mat;
+    mat4 model_mat;
+} golf_editor_water_vs_params_t;
+
+typedef struct golf_editor_water_fs_params {
+    float draw_type;
+    float t;
+    float _pad0[2];
+} golf_editor_water_fs_params_t;
+
+typedef struct golf_environment_material_vs_params {
+    mat4 model_mat;
+    mat4 proj_view_mat;
+} golf_environment_material_vs_params_t;
+
+typedef struct golf_environment_material_fs_params {
+    vec4 ball_position;
+    float lightmap_texture_a;
+    float uv_scale;
+    float _pad0[2];
+} golf_environment_material_fs_params_t;
+
+typedef struct golf_pass_through_vs_params {
+    mat4 mvp_mat;
+} golf_pass_through_vs_params_t;
+
+typedef struct golf_solid_color_material_vs_params {
+    mat4 mvp_mat;
+} golf_solid_color_material_vs_params_t;
+
+typedef struct golf_solid_color_material_fs_params {
+    vec4 color;
+} golf_solid_color_material_fs_params_t;
+
+typedef struct golf_texture_material_vs_params {
+    mat4 model_mat;
+    mat4 proj_view_mat;
+} golf_texture_material_vs_params_t;
+
+typedef struct golf_texture_material_fs_params {
+    float alpha;
+    float _pad0[3];
+} golf_texture_material_fs_params_t;
+
+typedef struct golf_ui_vs_params {
+    mat4 mvp_mat;
+} golf_ui_vs_params_t;
+
+typedef struct golf_ui_fs_params {
+    vec4 color;
+    float alpha;
+    float tex_x;
+    float tex_y;
+    float tex_dx;
+    float tex_dy;
+    float is_font;
+    float _pad0[2];
+} golf_ui_fs_params_t;
+
+typedef struct golf_water_vs_params {
+    mat4 proj_view_mat;
+    mat4 model_mat;
+} golf_water_vs_params_t;
+
+typedef struct golf_water_fs_params {
+    float t;
+    float _pad0[3];
+} golf_water_fs_params_t;
+
+typedef struct golf_water_around_ball_vs_params {
+    mat4 mvp_mat;
+} golf_water_around_ball_vs_params_t;
+
+typedef struct golf_water_around_ball_fs_params {
+    float t;
+    float _pad0[3];
+} golf_water_around_ball_fs_params_t;
+
+typedef struct golf_water_ripple_vs_params {
+    mat4 mvp_mat;
+} golf_water_ripple_vs_params_t;
+
+typedef struct golf_water_ripple_fs_params {
+    float t;
+    float _pad0[3];
+    vec4 uniform_color;
+} golf_water_ripple_fs_params_t;
+
+#define GOLF_SHADER_UNIFORM_MAX_MEMBERS 8
+
+typedef struct golf_shader_uniform_layout_member {
+    const char *name;
+    int offset, size;
+} golf_shader_uniform_layout_member_t;
+
+typedef struct golf_shader_uniform_layout {
+    const char *shader_path;
+    bool is_vs;
+    const char *name;
+    int size;
+    int num_members;
+    golf_shader_uniform_layout_member_t members[GOLF_SHADER_UNIFORM_MAX_MEMBERS];
+} golf_shader_uniform_layout_t;
+
+const golf_shader_uniform_layout_t *golf_shader_uniform_layout_get(golf_shader_uniform_block_type_t type);
+// Returns the layout for the block with that name in the shader, or NULL if there isn't one
+const golf_shader_uniform_layout_t *golf_shader_uniform_layout_find(const char *shader_path, bool is_vs, const char *name, golf_shader_uniform_block_type_t *type);
+
+#endif
@@ -8,9 +8,9 @@
 #define _CRT_NONSTDC_NO_DEPRECATE 
 #define _CRT_SECURE_NO_WARNINGS
 
-#if !defined( _WIN32_WINNT ) || _WIN32_WINNT < 0x0501 
+#if !defined( _WIN32_WINNT ) || _WIN32_WINNT < 0x0600 
     #undef _WIN32_WINNT
-    #define _WIN32_WINNT 0x501// requires Windows XP minimum
+    #define _WIN32_WINNT 0x600// requires Windows Vista minimum for condition variables
 #endif
 
 #define _WINSOCKAPI_
@@ -37,6 +37,7 @@ typedef struct tagTHREADNAME_INFO
 #include <stdint.h>
 #include <pthread.h>
 #include <sys/time.h>
+#include <unistd.h>
 #include <errno.h>
 
 #else
@@ -90,8 +91,42 @@ void golf_thread_destroy(golf_thread_t thread) {
 }
 
 int golf_thread_join(golf_thread_t thread) {
-    GOLF_UNUSED(thread);
+#if GOLF_PLATFORM_WINDOWS
+
+    WaitForSingleObject( (HANDLE) thread, INFINITE );
+    DWORD retval;
+    GetExitCodeThread( (HANDLE) thread, &retval );
+    CloseHandle( (HANDLE) thread );
+    return (int) retval;
+
+#elif GOLF_PLATFORM_LINUX || GOLF_PLATFORM_IOS || GOLF_PLATFORM_ANDROID || GOLF_PLATFORM_EMSCRIPTEN
+
+    void* retval;
+    pthread_join( (pthread_t) thread, &retval );
+    return (int)(uintptr_t) retval;
+
+#else
+#error Unknown platform
     return 0;
+#endif
+}
+
+int golf_thread_get_num_cores(void) {
+#if GOLF_PLATFORM_WINDOWS
+
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return (int) info.dwNumberOfProcessors;
+
+#elif GOLF_PLATFORM_LINUX || GOLF_PLATFORM_IOS || GOLF_PLATFORM_ANDROID || GOLF_PLATFORM_EMSCRIPTEN
+
+    long num_cores = sysconf( _SC_NPROCESSORS_ONLN );
+    return num_cores > 0 ? (int) num_cores : 1;
+
+#else
+#error Unknown platform
+    return 1;
+#endif
 }
 
 void golf_mutex_init(golf_mutex_t *mutex) {
@@ -159,6 +194,86 @@ void golf_mutex_unlock(golf_mutex_t *mutex) {
 #endif
 }
 
+void golf_cond_init(golf_cond_t *cond) {
+#if GOLF_PLATFORM_WINDOWS
+
+    // Compile-time size check
+#pragma warning( push )
+#pragma warning( disable: 4214 ) // nonstandard extension used: bit field types other than int
+    struct x { char cond_type_too_small : ( sizeof( golf_cond_t ) < sizeof( CONDITION_VARIABLE ) ? 0 : 1 ); }; 
+#pragma warning( pop )
+
+    InitializeConditionVariable( (CONDITION_VARIABLE*) cond );
+
+#elif GOLF_PLATFORM_LINUX || GOLF_PLATFORM_IOS || GOLF_PLATFORM_ANDROID || GOLF_PLATFORM_EMSCRIPTEN
+
+    // Compile-time size check
+    struct x { char cond_type_too_small : ( sizeof( golf_cond_t ) < sizeof( pthread_cond_t ) ? 0 : 1 ); };
+
+    pthread_cond_init( (pthread_cond_t*) cond, NULL );
+
+#else
+#error Unknown platform.
+#endif
+}
+
+void golf_cond_deinit(golf_cond_t *cond) {
+#if GOLF_PLATFORM_WINDOWS
+    GOLF_UNUSED(cond);
+
+    // Nothing
+
+#elif GOLF_PLATFORM_LINUX || GOLF_PLATFORM_IOS || GOLF_PLATFORM_ANDROID || GOLF_PLATFORM_EMSCRIPTEN
+
+    pthread_cond_destroy( (pthread_cond_t*) cond );
+
+#else
+#error Unknown platform.
+#endif
+}
+
+void golf_cond_wait(golf_cond_t *cond, golf_mutex_t *mutex) {
+#if GOLF_PLATFORM_WINDOWS
+
+    SleepConditionVariableCS( (CONDITION_VARIABLE*) cond, (CRITICAL_SECTION*) mutex, INFINITE );
+
+#elif GOLF_PLATFORM_LINUX || GOLF_PLATFORM_IOS || GOLF_PLATFORM_ANDROID || GOLF_PLATFORM_EMSCRIPTEN
+
+    pthread_cond_wait( (pthread_cond_t*) cond, (pthread_mutex_t*) mutex );
+
+#else
+#error Unknown platform.
+#endif
+}
+
+void golf_cond_signal(golf_cond_t *cond) {
+#if GOLF_PLATFORM_WINDOWS
+
+    WakeConditionVariable( (CONDITION_VARIABLE*) cond );
+
+#elif GOLF_PLATFORM_LINUX || GOLF_PLATFORM_IOS || GOLF_PLATFORM_ANDROID || GOLF_PLATFORM_EMSCRIPTEN
+
+    pthread_cond_signal( (pthread_cond_t*) cond );
+
+#else
+#error Unknown platform.
+#endif
+}
+
+void golf_cond_broadcast(golf_cond_t *cond) {
+#if GOLF_PLATFORM_WINDOWS
+
+    WakeAllConditionVariable( (CONDITION_VARIABLE*) cond );
+
+#elif GOLF_PLATFORM_LINUX || GOLF_PLATFORM_IOS || GOLF_PLATFORM_ANDROID || GOLF_PLATFORM_EMSCRIPTEN
+
+    pthread_cond_broadcast( (pthread_cond_t*) cond );
+
+#else
+#error Unknown platform.
+#endif
+}
+
 void golf_thread_timer_init(golf_thread_timer_t* timer) {
 #if GOLF_PLATFORM_WINDOWS
 
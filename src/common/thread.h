@@ -22,6 +22,7 @@ typedef void* golf_thread_result_t;
 golf_thread_t golf_thread_create(golf_thread_result_t (*proc)(void*), void *user_data, const char *name);
 void golf_thread_destroy(golf_thread_t thread);
 int golf_thread_join(golf_thread_t thread);
+int golf_thread_get_num_cores(void);
 
 typedef union golf_mutex {
     void *align;
@@ -33,6 +34,18 @@ void golf_mutex_deinit(golf_mutex_t *mutex);
 void golf_mutex_lock(golf_mutex_t *mutex);
 void golf_mutex_unlock(golf_mutex_t *mutex);
 
+typedef union golf_cond {
+    void *align;
+    char data[64];
+} golf_cond_t;
+
+void golf_cond_init(golf_cond_t *cond);
+void golf_cond_deinit(golf_cond_t *cond);
+// The mutex must be locked, it is unlocked while waiting and locked again before returning
+void golf_cond_wait(golf_cond_t *cond, golf_mutex_t *mutex);
+void golf_cond_signal(golf_cond_t *cond);
+void golf_cond_broadcast(golf_cond_t *cond);
+
 typedef union golf_thread_timer_t {
     void *data;
     char d[8];
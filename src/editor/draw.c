@@ -20,7 +20,7 @@ static void _golf_renderer_draw_environment_material(golf_model_t *model, int st
 
     golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "environment_material_vs_params");
     golf_shader_uniform_set_mat4(vs_uniform, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-    golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(model_mat));
+    golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(mat4_multiply(model_mat, golf_model_get_pack_mat(model))));
     sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
 
     int num_samples = lightmap_image->num_samples;
@@ -80,7 +80,7 @@ static void _golf_renderer_draw_solid_color_material(golf_model_t *model, int st
     sg_apply_pipeline(pipeline->sg_pipeline);
 
     golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "solid_color_material_vs_params");
-    golf_shader_uniform_set_mat4(vs_uniform, "mvp_mat", mat4_transpose(mat4_multiply(graphics->proj_view_mat, model_mat)));
+    golf_shader_uniform_set_mat4(vs_uniform, "mvp_mat", mat4_transpose(mat4_multiply_n(3, graphics->proj_view_mat, model_mat, golf_model_get_pack_mat(model))));
     sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
 
     golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "solid_color_material_fs_params");
@@ -181,7 +181,7 @@ static void _draw_level(void) {
 
                 golf_shader_uniform_t *vs_uniforms = golf_shader_get_vs_uniform(shader, "texture_material_vs_params");
                 golf_shader_uniform_set_mat4(vs_uniforms, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(model_mat));
+                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(mat4_multiply(model_mat, golf_model_get_pack_mat(model))));
                 sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniforms->data, vs_uniforms->size });
 
                 golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "fs_params");
@@ -210,7 +210,7 @@ static void _draw_level(void) {
                         mat4_translation(V3(1, 0.5f, 0)));
                 
                 golf_shader_uniform_set_mat4(vs_uniforms, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(model_mat));
+                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(mat4_multiply(model_mat, golf_model_get_pack_mat(model))));
                 sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniforms->data, vs_uniforms->size });
 
                 golf_shader_uniform_set_float(fs_uniform, "alpha", 1);
@@ -239,7 +239,7 @@ static void _draw_level(void) {
                         mat4_scale(V3(0.2f, 0.2f, 0.2f)));
 
                 golf_shader_uniform_set_mat4(vs_uniforms, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(model_mat));
+                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(mat4_multiply(model_mat, golf_model_get_pack_mat(model))));
                 sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniforms->data, vs_uniforms->size });
 
                 golf_shader_uniform_set_float(fs_uniform, "alpha", 1);
@@ -270,7 +270,7 @@ static void _draw_level(void) {
 
                 golf_shader_uniform_t *vs_uniforms = golf_shader_get_vs_uniform(shader, "texture_material_vs_params");
                 golf_shader_uniform_set_mat4(vs_uniforms, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(model_mat));
+                golf_shader_uniform_set_mat4(vs_uniforms, "model_mat", mat4_transpose(mat4_multiply(model_mat, golf_model_get_pack_mat(model))));
                 sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniforms->data, vs_uniforms->size });
 
                 golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "fs_params");
@@ -317,7 +317,7 @@ static void _draw_level(void) {
             sg_apply_bindings(&bindings);
 
             golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "editor_water_vs_params");
-            golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(model_mat));
+            golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(mat4_multiply(model_mat, golf_model_get_pack_mat(model))));
             golf_shader_uniform_set_mat4(vs_uniform, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
             sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
 
@@ -354,7 +354,7 @@ static void _draw_level(void) {
                     golf_model_t *model = golf_data_get_model("data/models/hole-cover.obj");
 
                     golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "pass_through_vs_params");
-                    golf_shader_uniform_set_mat4(vs_uniform, "mvp_mat", mat4_transpose(mat4_multiply(graphics->proj_view_mat, model_mat)));
+                    golf_shader_uniform_set_mat4(vs_uniform, "mvp_mat", mat4_transpose(mat4_multiply_n(3, graphics->proj_view_mat, model_mat, golf_model_get_pack_mat(model))));
                     sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
 
                     sg_bindings bindings = {
@@ -396,7 +396,7 @@ static void _draw_level(void) {
 
                     golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "texture_material_vs_params");
                     golf_shader_uniform_set_mat4(vs_uniform, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-                    golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(model_mat));
+                    golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(mat4_multiply(model_mat, golf_model_get_pack_mat(model))));
                     sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
 
                     golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "fs_params");
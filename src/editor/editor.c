@@ -120,6 +120,11 @@ void golf_editor_init(void) {
 
     editor.t = 0;
 
+    golf_tlas_init(&editor.picking_tlas);
+    editor.num_modifications = 0;
+    editor.picking_num_modifications = -1;
+    editor.picking_data_version = -1;
+
     editor.open_save_as_popup = false;
     vec_init(&editor.copied_entities, "editor");
 }
@@ -224,6 +229,7 @@ static void _golf_editor_start_action(golf_editor_action_t action) {
 
     editor.started_action = true;
     editor.cur_action = action;
+    editor.num_modifications++;
 }
 
 static void _golf_editor_start_action_with_data(void *data, int data_len, const char *name) {
@@ -240,6 +246,7 @@ static void _golf_editor_commit_action(void) {
     }
 
     editor.started_action = false;
+    editor.num_modifications++;
     vec_push(&editor.undo_actions, editor.cur_action);
     for (int i = 0; i < editor.redo_actions.length; i++) {
         _golf_editor_action_deinit(&editor.redo_actions.data[i]);
@@ -255,6 +262,7 @@ static void _golf_editor_decommit_action(void) {
 
     _golf_editor_action_deinit(&editor.cur_action);
     editor.started_action = false;
+    editor.num_modifications++;
 }
 
 // Assumes you just pushed a new entity onto the level's entities vec
@@ -319,6 +327,7 @@ static void _golf_editor_undo_action(void) {
     }
     vec_push(&editor.redo_actions, redo_action);
     _golf_editor_action_deinit(undo_action);
+    editor.num_modifications++;
 }
 
 static void _golf_editor_redo_action(void) {
@@ -336,6 +345,7 @@ static void _golf_editor_redo_action(void) {
     }
     vec_push(&editor.undo_actions, undo_action);
     _golf_editor_action_deinit(redo_action);
+    editor.num_modifications++;
 }
 
 static void _golf_editor_undoable_igInputText(const char *label, char *buf, int buf_len, bool *edit_done, void *additional_buf, int additional_buf_len, const char *action_name) {
@@ -2589,7 +2599,7 @@ void golf_editor_update(float dt) {
         if (igButton("Save", (ImVec2){0, 0})) {
             golf_log_note("Saving...");
             golf_level_save(editor.level, editor.level_path);
-            golf_data_force_remount();
+            golf_data_add_file(editor.level_path);
             golf_data_load(editor.level_path, false);
             editor.level = golf_data_get_level(editor.level_path);
             igCloseCurrentPopup();
@@ -2813,9 +2823,19 @@ void golf_editor_update(float dt) {
         vec_deinit(&point_idxs);
     }
     else {
-        vec_golf_bvh_node_info_t node_infos;
-        vec_init(&node_infos, "editor");
-
+        // BLASes are keyed by model pointer, which can be reused for different geometry
+        // once entities are created, deleted or edited, so drop them all when that happens
+        golf_tlas_t *tlas = &editor.picking_tlas;
+        if (editor.picking_num_modifications != editor.num_modifications ||
+                editor.picking_data_version != golf_data_get_version()) {
+            editor.picking_num_modifications = editor.num_modifications;
+            editor.picking_data_version = golf_data_get_version();
+            golf_tlas_clear(tlas);
+        }
+
+        // The instances are cheap, so they're redone every frame to pick up transforms
+        // being dragged around and entities moving
+        tlas->instances.length = 0;
         for (int i = 0; i < editor.level->entities.length; i++) {
             golf_entity_t *entity = &editor.level->entities.data[i];
             if (!entity->active) continue;
@@ -2823,16 +2843,20 @@ void golf_editor_update(float dt) {
             golf_model_t *model = golf_entity_get_model(entity);
             golf_transform_t *transform = golf_entity_get_transform(entity);
             if (model && transform) {
-                vec_push(&node_infos, golf_bvh_node_info(&editor.bvh, i, editor.level, entity, editor.t));
+                // Geos are regenerated every frame, so one being dragged changes before its action is committed
+                if (golf_entity_get_geo(entity)) {
+                    golf_tlas_update_blas(tlas, editor.level, model);
+                }
+                golf_tlas_add_entity(tlas, i, editor.level, entity);
             }
         }
+        golf_tlas_construct(tlas, editor.t);
 
         {
-            golf_bvh_construct(&editor.bvh, node_infos);
             editor.hovered_idx = -1;
             float t = FLT_MAX;
             int idx = -1;
-            if (golf_bvh_ray_test(&editor.bvh, inputs->mouse_ray_orig, inputs->mouse_ray_dir, &t, &idx, NULL)) {
+            if (golf_tlas_ray_test(tlas, inputs->mouse_ray_orig, inputs->mouse_ray_dir, &t, &idx, NULL)) {
                 editor.hovered_idx = idx;
             }
         }
@@ -2840,8 +2864,6 @@ void golf_editor_update(float dt) {
         if (!IO->WantCaptureMouse && !editor.mouse_down_in_imgui && inputs->mouse_clicked[SAPP_MOUSEBUTTON_LEFT]) {
             _golf_editor_select_entity(editor.hovered_idx);
         }
-
-        vec_deinit(&node_infos);
     }
 
     if (editor.gi_running) {
@@ -49,7 +49,10 @@ typedef struct golf_editor {
 
     bool mouse_down, mouse_down_in_imgui;
 
-    golf_bvh_t bvh;
+    // Hover picking goes through a TLAS over the entities. The model BLASes are only
+    // rebuilt when an action touches the level, data gets loaded or a geo changes.
+    golf_tlas_t picking_tlas;
+    int num_modifications, picking_num_modifications, picking_data_version;
     int hovered_idx;
     vec_int_t selected_idxs;
 
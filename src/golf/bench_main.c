@@ -0,0 +1,383 @@
+#include <float.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The tools don't link the sokol library, so they build sokol_time themselves
+#define SOKOL_TIME_IMPL
+#include "sokol/sokol_time.h"
+#include "common/alloc.h"
+#include "common/common.h"
+#include "common/data.h"
+#include "common/log.h"
+#include "golf/sim.h"
+
+// Times the physics on every level so changes to the BVH, the maths kernels or
+// the tick can be compared between builds.
+//
+//   golf_bench [-o json_path] [-queries n] [-builds n] [level_path...]
+//
+// Each level gets the BLAS of every model built a few times with the SAH builder,
+// its TLAS assembled a few times from the BLASes, a fixed set of random ray
+// and ball queries against it, and a fixed fan of shots through golf_sim. The
+// results go to stdout as JSON (or to json_path), log messages go to stderr.
+// The query hit counts and the shot checksum only change when the physics
+// does, so they double as a check that an optimization didn't change results.
+
+#define BENCH_VERSION 2
+
+static const float _bench_shot_powers[] = { 0.25f, 0.5f, 0.9f };
+#define BENCH_NUM_SHOT_POWERS ((int)(sizeof(_bench_shot_powers) / sizeof(_bench_shot_powers[0])))
+#define BENCH_NUM_SHOT_ANGLES 16
+#define BENCH_MAX_SHOT_TIME 20.0f
+
+typedef struct _options {
+    const char *json_path;
+    int num_queries;
+    int num_builds;
+} _options_t;
+
+typedef struct _level_result {
+    double bvh_build_min_ms, bvh_build_mean_ms;
+    double tlas_build_min_ms, tlas_build_mean_ms;
+    int num_ray_hits;
+    double rays_per_sec;
+    int num_ball_hits, num_ball_contacts;
+    double ball_queries_per_sec;
+    int num_shots, num_shots_in_hole;
+    int64_t num_ticks;
+    double shot_time, ticks_per_sec;
+    uint32_t shot_checksum;
+    size_t peak_alloc;
+} _level_result_t;
+
+static void _print_usage(void) {
+    fprintf(stderr, "usage: golf_bench [-o json_path] [-queries n] [-builds n] [level_path...]\n");
+}
+
+static void _print_json_string(FILE *out, const char *str) {
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char*)str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        }
+        else if (*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        }
+        else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static uint32_t _bench_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static float _bench_random_float(uint32_t *state) {
+    return (float)(_bench_random(state) >> 8) / (float)(1 << 24);
+}
+
+static vec3 _bench_random_dir(uint32_t *state) {
+    float z = 2 * _bench_random_float(state) - 1;
+    float a = 2 * MF_PI * _bench_random_float(state);
+    float r = sqrtf(fmaxf(0, 1 - z * z));
+    return V3(r * cosf(a), r * sinf(a), z);
+}
+
+static uint32_t _bench_hash(uint32_t hash, const void *data, int len) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    for (int i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void _bench_level(golf_sim_t *sim, golf_level_t *level, _options_t *options, _level_result_t *result) {
+    memset(result, 0, sizeof(_level_result_t));
+
+    // TLAS assembly, which uses the level's prebuilt BLASes when they're valid. The
+    // fastest run is the one least disturbed by the machine.
+    double build_total = 0;
+    result->tlas_build_min_ms = DBL_MAX;
+    for (int i = 0; i < options->num_builds; i++) {
+        uint64_t start_time = stm_now();
+        golf_sim_start_level(sim, level);
+        double ms = stm_ms(stm_since(start_time));
+        build_total += ms;
+        if (ms < result->tlas_build_min_ms) {
+            result->tlas_build_min_ms = ms;
+        }
+    }
+    result->tlas_build_mean_ms = build_total / options->num_builds;
+
+    golf_tlas_t *bvh = &sim->bvh;
+
+    // The SAH builder itself, run on every model the TLAS uses
+    build_total = 0;
+    result->bvh_build_min_ms = DBL_MAX;
+    for (int i = 0; i < options->num_builds; i++) {
+        double ms = 0;
+        for (int j = 0; j < bvh->blases.length; j++) {
+            golf_blas_t blas;
+            uint64_t start_time = stm_now();
+            golf_blas_construct(&blas, level, bvh->blases.data[j].model);
+            ms += stm_ms(stm_since(start_time));
+            golf_bvh_deinit(&blas.bvh);
+        }
+        build_total += ms;
+        if (ms < result->bvh_build_min_ms) {
+            result->bvh_build_min_ms = ms;
+        }
+    }
+    result->bvh_build_mean_ms = build_total / options->num_builds;
+
+    if (bvh->parent < 0) {
+        return;
+    }
+
+    // Rays start anywhere in the level's bounds and go in any direction, the
+    // generation is done up front so only the queries are timed
+    golf_bvh_node_t *root = &bvh->nodes.data[bvh->parent];
+    vec3 aabb_min = root->aabb_min;
+    vec3 aabb_size = vec3_sub(root->aabb_max, root->aabb_min);
+    int num_queries = options->num_queries;
+    vec3 *ray_origins = golf_alloc(sizeof(vec3) * num_queries);
+    vec3 *ray_dirs = golf_alloc(sizeof(vec3) * num_queries);
+    vec3 *ball_positions = golf_alloc(sizeof(vec3) * num_queries);
+    vec3 *ball_vels = golf_alloc(sizeof(vec3) * num_queries);
+    uint32_t random_state = 1;
+    for (int i = 0; i < num_queries; i++) {
+        vec3 r = V3(_bench_random_float(&random_state), _bench_random_float(&random_state), _bench_random_float(&random_state));
+        ray_origins[i] = vec3_add(aabb_min, vec3_multiply(aabb_size, r));
+        ray_dirs[i] = _bench_random_dir(&random_state);
+        ball_vels[i] = vec3_scale(_bench_random_dir(&random_state), 5 * _bench_random_float(&random_state));
+    }
+
+    {
+        uint64_t start_time = stm_now();
+        for (int i = 0; i < num_queries; i++) {
+            float t = FLT_MAX;
+            int idx;
+            golf_bvh_face_t face;
+            golf_tlas_ray_test(bvh, ray_origins[i], ray_dirs[i], &t, &idx, &face);
+
+            // Balls are placed just short of where the rays hit so most of them
+            // touch something, which is the case the tick cares about
+            if (t < FLT_MAX) {
+                result->num_ray_hits++;
+                ball_positions[i] = vec3_add(ray_origins[i], vec3_scale(ray_dirs[i], fmaxf(0, t - 0.5f * GOLF_SIM_BALL_RADIUS)));
+            }
+            else {
+                ball_positions[i] = ray_origins[i];
+            }
+        }
+        double elapsed = stm_sec(stm_since(start_time));
+        result->rays_per_sec = elapsed > 0 ? num_queries / elapsed : 0;
+    }
+
+    {
+        uint64_t start_time = stm_now();
+        for (int i = 0; i < num_queries; i++) {
+            int num_contacts = 0;
+            golf_ball_contact_t contacts[MAX_NUM_CONTACTS];
+            if (golf_tlas_ball_test(bvh, ball_positions[i], GOLF_SIM_BALL_RADIUS, ball_vels[i], contacts, &num_contacts, MAX_NUM_CONTACTS)) {
+                result->num_ball_hits++;
+            }
+            result->num_ball_contacts += num_contacts;
+        }
+        double elapsed = stm_sec(stm_since(start_time));
+        result->ball_queries_per_sec = elapsed > 0 ? num_queries / elapsed : 0;
+    }
+
+    golf_free(ray_origins);
+    golf_free(ray_dirs);
+    golf_free(ball_positions);
+    golf_free(ball_vels);
+
+    // Shots through the full tick
+    vec3 ball_start_pos = golf_sim_get_ball_start_pos(level);
+    int64_t start_ticks = sim->num_ticks;
+    uint32_t checksum = 2166136261u;
+    uint64_t start_time = stm_now();
+    for (int i = 0; i < BENCH_NUM_SHOT_POWERS; i++) {
+        for (int j = 0; j < BENCH_NUM_SHOT_ANGLES; j++) {
+            float angle = 2 * MF_PI * j / BENCH_NUM_SHOT_ANGLES;
+            vec3 direction = V3(cosf(angle), 0, sinf(angle));
+
+            golf_sim_reset(sim);
+            golf_sim_ball_t ball;
+            golf_sim_ball_init(&ball, ball_start_pos);
+            golf_sim_shot_t shot = golf_sim_run_shot(sim, &ball, direction, _bench_shot_powers[i], BENCH_MAX_SHOT_TIME);
+
+            result->num_shots++;
+            if (shot.result == GOLF_SIM_SHOT_IN_HOLE) {
+                result->num_shots_in_hole++;
+            }
+            checksum = _bench_hash(checksum, &shot.result, sizeof(shot.result));
+            checksum = _bench_hash(checksum, &shot.end_pos, sizeof(shot.end_pos));
+        }
+    }
+    result->shot_time = stm_sec(stm_since(start_time));
+    result->num_ticks = sim->num_ticks - start_ticks;
+    result->ticks_per_sec = result->shot_time > 0 ? result->num_ticks / result->shot_time : 0;
+    result->shot_checksum = checksum;
+}
+
+int main(int argc, char *argv[]) {
+    _options_t options;
+    options.json_path = NULL;
+    options.num_queries = 100000;
+    options.num_builds = 10;
+
+    golf_alloc_init();
+    golf_log_init();
+    golf_log_use_stderr(true);
+    stm_setup();
+
+    int first_level_arg = argc;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_val = i + 1 < argc;
+        if (strcmp(arg, "-o") == 0 && has_val) {
+            options.json_path = argv[++i];
+        }
+        else if (strcmp(arg, "-queries") == 0 && has_val) {
+            options.num_queries = atoi(argv[++i]);
+        }
+        else if (strcmp(arg, "-builds") == 0 && has_val) {
+            options.num_builds = atoi(argv[++i]);
+        }
+        else if (arg[0] == '-') {
+            _print_usage();
+            return 1;
+        }
+        else {
+            first_level_arg = i;
+            break;
+        }
+    }
+    if (options.num_queries <= 0 || options.num_builds <= 0) {
+        _print_usage();
+        return 1;
+    }
+
+    golf_data_set_headless(true);
+    golf_data_init();
+
+    golf_data_load("data/config/game.cfg", false);
+    golf_config_t *cfg = golf_data_get_config("data/config/game.cfg");
+
+    vec_golf_file_t level_files;
+    vec_init(&level_files, "bench");
+    if (first_level_arg == argc) {
+        golf_data_get_all_matching(GOLF_DATA_LEVEL, "data/levels/", &level_files);
+    }
+    else {
+        for (int i = first_level_arg; i < argc; i++) {
+            vec_push(&level_files, golf_file(argv[i]));
+        }
+    }
+
+    FILE *out = stdout;
+    if (options.json_path) {
+        out = fopen(options.json_path, "w");
+        if (!out) {
+            golf_log_warning("Unable to open %s", options.json_path);
+            return 1;
+        }
+    }
+
+    golf_sim_t sim;
+    golf_sim_init(&sim, cfg);
+
+    // Written by hand rather than through parson, its number format rounds to 5 digits
+    fprintf(out, "{\n");
+    fprintf(out, "    \"version\": %d,\n", BENCH_VERSION);
+    fprintf(out, "    \"num_queries\": %d,\n", options.num_queries);
+    fprintf(out, "    \"num_builds\": %d,\n", options.num_builds);
+    fprintf(out, "    \"levels\": [");
+
+    bool all_loaded = true;
+    int num_levels_written = 0;
+    int64_t total_ticks = 0;
+    double total_shot_time = 0;
+    size_t max_peak_alloc = 0;
+    for (int i = 0; i < level_files.length; i++) {
+        const char *level_path = level_files.data[i].path;
+
+        // Peak is measured from what was allocated before the level was loaded
+        size_t base_alloc, peak_alloc;
+        golf_alloc_get_debug_info(&base_alloc, &peak_alloc);
+        golf_alloc_reset_peak();
+
+        golf_data_load(level_path, false);
+        if (golf_data_get_load_state(level_path) != GOLF_DATA_LOADED) {
+            golf_log_warning("Unable to load level %s", level_path);
+            all_loaded = false;
+            continue;
+        }
+        golf_level_t *level = golf_data_get_level(level_path);
+
+        _level_result_t result;
+        _bench_level(&sim, level, &options, &result);
+
+        size_t total_alloc;
+        golf_alloc_get_debug_info(&total_alloc, &peak_alloc);
+        result.peak_alloc = peak_alloc - base_alloc;
+
+        total_ticks += result.num_ticks;
+        total_shot_time += result.shot_time;
+        if (result.peak_alloc > max_peak_alloc) {
+            max_peak_alloc = result.peak_alloc;
+        }
+
+        fprintf(out, "%s\n        {\n", num_levels_written > 0 ? "," : "");
+        fprintf(out, "            \"path\": ");
+        _print_json_string(out, level_path);
+        fprintf(out, ",\n");
+        fprintf(out, "            \"bvh_build_min_ms\": %0.4f,\n", result.bvh_build_min_ms);
+        fprintf(out, "            \"bvh_build_mean_ms\": %0.4f,\n", result.bvh_build_mean_ms);
+        fprintf(out, "            \"tlas_build_min_ms\": %0.4f,\n", result.tlas_build_min_ms);
+        fprintf(out, "            \"tlas_build_mean_ms\": %0.4f,\n", result.tlas_build_mean_ms);
+        fprintf(out, "            \"rays_per_sec\": %0.0f,\n", result.rays_per_sec);
+        fprintf(out, "            \"ray_hits\": %d,\n", result.num_ray_hits);
+        fprintf(out, "            \"ball_queries_per_sec\": %0.0f,\n", result.ball_queries_per_sec);
+        fprintf(out, "            \"ball_hits\": %d,\n", result.num_ball_hits);
+        fprintf(out, "            \"ball_contacts\": %d,\n", result.num_ball_contacts);
+        fprintf(out, "            \"shots\": %d,\n", result.num_shots);
+        fprintf(out, "            \"shots_in_hole\": %d,\n", result.num_shots_in_hole);
+        fprintf(out, "            \"ticks\": %lld,\n", (long long)result.num_ticks);
+        fprintf(out, "            \"ticks_per_sec\": %0.0f,\n", result.ticks_per_sec);
+        fprintf(out, "            \"shot_checksum\": \"%08x\",\n", result.shot_checksum);
+        fprintf(out, "            \"peak_alloc_bytes\": %llu\n", (unsigned long long)result.peak_alloc);
+        fprintf(out, "        }");
+        num_levels_written++;
+
+        golf_log_note("%s: bvh %0.2fms, tlas %0.2fms, %0.0f rays/s, %0.0f balls/s, %0.0f ticks/s", level_path,
+                result.bvh_build_min_ms, result.tlas_build_min_ms, result.rays_per_sec, result.ball_queries_per_sec, result.ticks_per_sec);
+    }
+
+    fprintf(out, "\n    ],\n");
+    fprintf(out, "    \"totals\": {\n");
+    fprintf(out, "        \"ticks\": %lld,\n", (long long)total_ticks);
+    fprintf(out, "        \"ticks_per_sec\": %0.0f,\n", total_shot_time > 0 ? total_ticks / total_shot_time : 0);
+    fprintf(out, "        \"max_peak_alloc_bytes\": %llu\n", (unsigned long long)max_peak_alloc);
+    fprintf(out, "    }\n");
+    fprintf(out, "}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    golf_sim_deinit(&sim);
+    vec_deinit(&level_files);
+    return all_loaded ? 0 : 1;
+}
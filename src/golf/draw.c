@@ -11,10 +11,72 @@
 #include "golf/golf.h"
 #include "golf/ui.h"
 
+// A geo or model entity drawn with the environment material
+typedef struct _env_entity {
+    golf_model_t *model;
+    golf_lightmap_section_t *lightmap_section;
+    // NULL for entities that don't move, their model_mat is only worked out once
+    golf_movement_t *movement;
+    golf_transform_t world_transform;
+    float uv_scale;
+    // Transposed with the model's pack mat folded in, ready for the uniform block
+    mat4 model_mat;
+} _env_entity_t;
+typedef vec_t(_env_entity_t) vec_env_entity_t;
+
+typedef struct _env_lightmap {
+    golf_lightmap_image_t *image;
+    // Which samples to blend between this frame
+    int sample0, sample1;
+    float t;
+} _env_lightmap_t;
+typedef vec_t(_env_lightmap_t) vec_env_lightmap_t;
+
+// A run of vertices that share a texture and lightmap. Moving entities get a draw
+// for each of their own runs, static ones are merged into batches in the static
+// buffer and have an entity_idx of -1. Static batches are indexed, so their elements
+// are indices rather than vertices. The sort key orders draws by pipeline, then
+// texture, then lightmap, then entity so state only changes when it has to.
+typedef struct _env_draw {
+    uint64_t sort_key;
+    golf_texture_t *texture;
+    int lightmap_idx, entity_idx;
+    int base_element, num_elements;
+} _env_draw_t;
+typedef vec_t(_env_draw_t) vec_env_draw_t;
+
+// Layout of the environment_material_interleaved pipeline, 32 bytes instead of 40 unpacked.
+// Normals are SHORT4N and lightmap uvs USHORT2N, the GPU expands them back to floats so the
+// shader is the same one used for the per-model buffers. Positions stay float, they're in
+// world space and a level is too big for 16 bits.
+typedef struct _env_vertex {
+    vec3 position;
+    vec2 texcoord;
+    int16_t normal[4];
+    uint16_t lightmap_uv[2];
+} _env_vertex_t;
+typedef vec_t(_env_vertex_t) vec_env_vertex_t;
+typedef vec_t(golf_texture_t*) vec_texture_ptr_t;
+
 typedef struct golf_draw {
     vec2 game_draw_pass_size;
     sg_image game_draw_pass_image, game_draw_pass_depth_image;
     sg_pass game_draw_pass;
+
+    // Built from the level the first time it's drawn and again whenever the level
+    // changes or any data is reloaded
+    golf_level_t *env_level;
+    int env_data_version;
+    vec_env_entity_t env_entities;
+    vec_env_lightmap_t env_lightmaps;
+    vec_texture_ptr_t env_textures;
+    vec_env_draw_t env_draws;
+    // Static geometry in world space with uv_scale applied, shared by all the static batches.
+    // Identical vertices are only stored once, env_static_slots is the hash table used to find them.
+    vec_env_vertex_t env_static_vertices;
+    vec_int_t env_static_indices;
+    vec_int_t env_static_slots;
+    sg_buffer env_static_buf, env_static_index_buf;
 } golf_draw_t;
 
 static golf_draw_t draw;
@@ -23,6 +85,303 @@ static golf_t *golf = NULL;
 static golf_graphics_t *graphics = NULL;
 static golf_ui_t *ui = NULL;
 
+static int _env_draw_cmp(const void *a, const void *b) {
+    uint64_t key_a = ((const _env_draw_t*)a)->sort_key;
+    uint64_t key_b = ((const _env_draw_t*)b)->sort_key;
+    if (key_a < key_b) return -1;
+    if (key_a > key_b) return 1;
+    return 0;
+}
+
+static int _env_find_lightmap(golf_level_t *level, const char *name) {
+    for (int i = 0; i < draw.env_lightmaps.length; i++) {
+        if (strcmp(draw.env_lightmaps.data[i].image->name, name) == 0) {
+            return i;
+        }
+    }
+    for (int i = 0; i < level->lightmap_images.length; i++) {
+        golf_lightmap_image_t *image = &level->lightmap_images.data[i];
+        if (image->active && strcmp(image->name, name) == 0) {
+            _env_lightmap_t lightmap;
+            lightmap.image = image;
+            lightmap.sample0 = 0;
+            lightmap.sample1 = 0;
+            lightmap.t = 0;
+            vec_push(&draw.env_lightmaps, lightmap);
+            return draw.env_lightmaps.length - 1;
+        }
+    }
+    return -1;
+}
+
+static int _env_find_texture(golf_texture_t *texture) {
+    for (int i = 0; i < draw.env_textures.length; i++) {
+        if (draw.env_textures.data[i] == texture) {
+            return i;
+        }
+    }
+    vec_push(&draw.env_textures, texture);
+    return draw.env_textures.length - 1;
+}
+
+static uint64_t _env_sort_key(bool is_static, int texture_idx, int lightmap_idx, int entity_idx, int order) {
+    return ((uint64_t)(is_static ? 0 : 1) << 63) | ((uint64_t)texture_idx << 48) | ((uint64_t)lightmap_idx << 32) |
+        ((uint64_t)(entity_idx & 0xFFFF) << 16) | (uint64_t)(order & 0xFFFF);
+}
+
+static uint32_t _env_hash_vertex(const _env_vertex_t *vertex) {
+    uint32_t hash = 2166136261u;
+    const unsigned char *bytes = (const unsigned char*)vertex;
+    for (int i = 0; i < (int)sizeof(_env_vertex_t); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Returns the index of the vertex in the static buffer, adding it if it isn't there yet
+static int _env_add_static_vertex(const _env_vertex_t *vertex) {
+    int mask = draw.env_static_slots.length - 1;
+    int slot = (int)(_env_hash_vertex(vertex) & (uint32_t)mask);
+    while (draw.env_static_slots.data[slot] >= 0) {
+        int idx = draw.env_static_slots.data[slot];
+        if (memcmp(&draw.env_static_vertices.data[idx], vertex, sizeof(_env_vertex_t)) == 0) {
+            return idx;
+        }
+        slot = (slot + 1) & mask;
+    }
+    int idx = draw.env_static_vertices.length;
+    vec_push(&draw.env_static_vertices, *vertex);
+    draw.env_static_slots.data[slot] = idx;
+    return idx;
+}
+
+static void _env_build_static_batches(vec_env_draw_t *static_runs) {
+    vec_sort(static_runs, _env_draw_cmp);
+
+    draw.env_static_vertices.length = 0;
+    draw.env_static_indices.length = 0;
+
+    // Keep the hash table at most half full
+    int num_vertices = 0;
+    for (int i = 0; i < static_runs->length; i++) {
+        num_vertices += static_runs->data[i].num_elements;
+    }
+    int num_slots = 1;
+    while (num_slots < 2 * num_vertices) {
+        num_slots *= 2;
+    }
+    draw.env_static_slots.length = 0;
+    vec_reserve(&draw.env_static_slots, num_slots);
+    draw.env_static_slots.length = num_slots;
+    memset(draw.env_static_slots.data, 0xFF, sizeof(int) * num_slots);
+
+    _env_draw_t *batch = NULL;
+    for (int i = 0; i < static_runs->length; i++) {
+        _env_draw_t *run = &static_runs->data[i];
+        _env_entity_t *entity = &draw.env_entities.data[run->entity_idx];
+        golf_model_t *model = entity->model;
+        mat4 model_mat = golf_transform_get_model_mat(entity->world_transform);
+
+        if (!batch || batch->texture != run->texture || batch->lightmap_idx != run->lightmap_idx) {
+            _env_draw_t env_draw;
+            env_draw.texture = run->texture;
+            env_draw.lightmap_idx = run->lightmap_idx;
+            env_draw.entity_idx = -1;
+            env_draw.base_element = draw.env_static_indices.length;
+            env_draw.num_elements = 0;
+            env_draw.sort_key = _env_sort_key(true, _env_find_texture(run->texture), run->lightmap_idx, 0, draw.env_draws.length);
+            vec_push(&draw.env_draws, env_draw);
+            batch = &vec_last(&draw.env_draws);
+        }
+
+        for (int j = run->base_element; j < run->base_element + run->num_elements; j++) {
+            _env_vertex_t vertex;
+            vertex.position = vec3_apply_mat4(model->positions.data[j], 1, model_mat);
+            vertex.texcoord = vec2_scale(model->texcoords.data[j], entity->uv_scale);
+            // Normals go through untransformed, same as when the entity is drawn on its own
+            vec3 normal = model->normals.data[j];
+            vertex.normal[0] = golf_pack_snorm16(normal.x);
+            vertex.normal[1] = golf_pack_snorm16(normal.y);
+            vertex.normal[2] = golf_pack_snorm16(normal.z);
+            vertex.normal[3] = 0;
+            // Lightmap uvs come out of the atlas packer in [0, 1]
+            vec2 lightmap_uv = entity->lightmap_section->uvs.data[j];
+            vertex.lightmap_uv[0] = golf_pack_unorm16(lightmap_uv.x);
+            vertex.lightmap_uv[1] = golf_pack_unorm16(lightmap_uv.y);
+            vec_push(&draw.env_static_indices, _env_add_static_vertex(&vertex));
+        }
+        batch->num_elements += run->num_elements;
+    }
+
+    if (draw.env_static_vertices.length > 0) {
+        sg_buffer_desc desc = {
+            .type = SG_BUFFERTYPE_VERTEXBUFFER,
+            .usage = SG_USAGE_IMMUTABLE,
+            .data = {
+                .ptr = draw.env_static_vertices.data,
+                .size = sizeof(_env_vertex_t) * draw.env_static_vertices.length,
+            },
+        };
+        draw.env_static_buf = sg_make_buffer(&desc);
+
+        sg_buffer_desc index_desc = {
+            .type = SG_BUFFERTYPE_INDEXBUFFER,
+            .usage = SG_USAGE_IMMUTABLE,
+            .data = {
+                .ptr = draw.env_static_indices.data,
+                .size = sizeof(int) * draw.env_static_indices.length,
+            },
+        };
+        draw.env_static_index_buf = sg_make_buffer(&index_desc);
+    }
+}
+
+// Versions only go up, so the newest of the level and the files it references
+// changes whenever any of them load or reload
+static int _env_get_data_version(golf_level_t *level) {
+    int version = golf_data_get_file_version(golf->level_loading_path);
+    for (int i = 0; i < level->deps.length; i++) {
+        int dep_version = golf_data_get_file_version(level->deps.data[i].path);
+        if (dep_version > version) {
+            version = dep_version;
+        }
+    }
+    return version;
+}
+
+static void _env_build(golf_level_t *level, int data_version) {
+    draw.env_level = level;
+    draw.env_data_version = data_version;
+    draw.env_entities.length = 0;
+    draw.env_lightmaps.length = 0;
+    draw.env_textures.length = 0;
+    draw.env_draws.length = 0;
+    if (draw.env_static_buf.id != SG_INVALID_ID) {
+        sg_destroy_buffer(draw.env_static_buf);
+        sg_destroy_buffer(draw.env_static_index_buf);
+        draw.env_static_buf.id = SG_INVALID_ID;
+        draw.env_static_index_buf.id = SG_INVALID_ID;
+    }
+
+    vec_env_draw_t static_runs;
+    vec_init(&static_runs, "draw");
+
+    for (int i = 0; i < level->entities.length; i++) {
+        golf_entity_t *entity = &level->entities.data[i];
+        if (entity->type != GEO_ENTITY && entity->type != MODEL_ENTITY) {
+            continue;
+        }
+
+        golf_lightmap_section_t *lightmap_section = golf_entity_get_lightmap_section(entity);
+        int lightmap_idx = _env_find_lightmap(level, lightmap_section->lightmap_name);
+        if (lightmap_idx < 0) {
+            golf_log_warning("Could not find lightmap %s", lightmap_section->lightmap_name);
+            continue;
+        }
+
+        _env_entity_t env_entity;
+        env_entity.model = golf_entity_get_model(entity);
+        env_entity.lightmap_section = lightmap_section;
+        env_entity.movement = golf_entity_get_movement(entity);
+        if (env_entity.movement && env_entity.movement->type == GOLF_MOVEMENT_NONE) {
+            env_entity.movement = NULL;
+        }
+        env_entity.world_transform = golf_entity_get_world_transform(level, entity);
+        env_entity.uv_scale = entity->type == MODEL_ENTITY ? entity->model.uv_scale : 1;
+        env_entity.model_mat = mat4_transpose(mat4_multiply(golf_transform_get_model_mat(env_entity.world_transform),
+                    golf_model_get_pack_mat(env_entity.model)));
+        vec_push(&draw.env_entities, env_entity);
+        int entity_idx = draw.env_entities.length - 1;
+
+        // Static entities are merged into the static buffer, which needs a lightmap uv for every vertex
+        golf_model_t *model = env_entity.model;
+        bool is_static = !env_entity.movement && lightmap_section->uvs.length >= model->positions.length;
+        vec_env_draw_t *runs = is_static ? &static_runs : &draw.env_draws;
+        int first_run = runs->length;
+        for (int j = 0; j < model->groups.length; j++) {
+            golf_model_group_t *group = &model->groups.data[j];
+            golf_material_t material;
+            if (!golf_level_get_material(level, group->material_name, &material)) {
+                golf_log_warning("Could not find material %s", group->material_name);
+                continue;
+            }
+            if (material.type != GOLF_MATERIAL_ENVIRONMENT) {
+                continue;
+            }
+
+            // Neighbouring groups with the same texture can go in one run
+            _env_draw_t *prev = runs->length > first_run ? &vec_last(runs) : NULL;
+            if (prev && prev->texture == material.texture &&
+                    prev->base_element + prev->num_elements == group->start_vertex) {
+                prev->num_elements += group->vertex_count;
+                continue;
+            }
+
+            _env_draw_t env_draw;
+            env_draw.texture = material.texture;
+            env_draw.lightmap_idx = lightmap_idx;
+            env_draw.entity_idx = entity_idx;
+            env_draw.base_element = group->start_vertex;
+            env_draw.num_elements = group->vertex_count;
+            env_draw.sort_key = _env_sort_key(is_static, _env_find_texture(material.texture), lightmap_idx, entity_idx, runs->length);
+            vec_push(runs, env_draw);
+        }
+    }
+
+    _env_build_static_batches(&static_runs);
+    vec_deinit(&static_runs);
+
+    vec_sort(&draw.env_draws, _env_draw_cmp);
+}
+
+static void _env_update(golf_level_t *level) {
+    int data_version = _env_get_data_version(level);
+    if (draw.env_level != level || draw.env_data_version != data_version) {
+        _env_build(level, data_version);
+    }
+
+    for (int i = 0; i < draw.env_lightmaps.length; i++) {
+        _env_lightmap_t *lightmap = &draw.env_lightmaps.data[i];
+        golf_lightmap_image_t *image = lightmap->image;
+        int num_samples = image->num_samples;
+        lightmap->sample0 = 0;
+        lightmap->sample1 = 0;
+        lightmap->t = 0;
+        if (image->time_length > 0 && image->num_samples > 1) {
+            // Lightmaps follow the moving geometry, so use the sim clock
+            float t = fmodf(game->physics.sim.t, image->time_length) / image->time_length;
+            if (image->repeats) {
+                t = 2.0f * t;
+                if (t > 1.0f) {
+                    t = 2.0f - t;
+                }
+            }
+            for (int j = 1; j < num_samples; j++) {
+                if (t < j / ((float) (num_samples - 1))) {
+                    lightmap->sample0 = j - 1;
+                    lightmap->sample1 = j;
+                    break;
+                }
+            }
+
+            float lightmap_t0 = lightmap->sample0 / ((float) num_samples - 1);
+            float lightmap_t1 = lightmap->sample1 / ((float) num_samples - 1);
+            lightmap->t = (t - lightmap_t0) / (lightmap_t1 - lightmap_t0);
+            lightmap->t = golf_clampf(lightmap->t, 0, 1);
+        }
+    }
+
+    for (int i = 0; i < draw.env_entities.length; i++) {
+        _env_entity_t *entity = &draw.env_entities.data[i];
+        if (entity->movement) {
+            golf_transform_t transform = golf_transform_apply_movement(entity->world_transform, *entity->movement, game->physics.sim.t);
+            entity->model_mat = mat4_transpose(mat4_multiply(golf_transform_get_model_mat(transform),
+                        golf_model_get_pack_mat(entity->model)));
+        }
+    }
+}
+
 static void _draw_game(void) {
     golf_level_t *level = golf->level;
 
@@ -39,97 +398,70 @@ static void _draw_game(void) {
         {
             golf_shader_t *shader = golf_data_get_shader("data/shaders/environment_material.glsl");
             golf_shader_pipeline_t *pipeline = golf_shader_get_pipeline(shader, "environment_material");
-            sg_apply_pipeline(pipeline->sg_pipeline);
-
-            for (int i = 0; i < level->entities.length; i++) {
-                golf_entity_t *entity = &level->entities.data[i];
-                if (entity->type != GEO_ENTITY && entity->type != MODEL_ENTITY) {
-                    continue;
-                }
+            golf_shader_pipeline_t *static_pipeline = golf_shader_get_pipeline(shader, "environment_material_interleaved");
+            mat4 proj_view_mat = mat4_transpose(graphics->proj_view_mat);
+            vec3 ball_pos = game->ball.draw_pos;
 
-                float uv_scale = 1;
-                if (entity->type == MODEL_ENTITY) {
-                    uv_scale = entity->model.uv_scale;
+            _env_update(level);
+
+            bool last_is_static = false;
+            int last_entity_idx = -1, last_lightmap_idx = -1;
+            golf_texture_t *last_texture = NULL;
+            for (int i = 0; i < draw.env_draws.length; i++) {
+                _env_draw_t *env_draw = &draw.env_draws.data[i];
+                _env_lightmap_t *lightmap = &draw.env_lightmaps.data[env_draw->lightmap_idx];
+                bool is_static = env_draw->entity_idx < 0;
+                _env_entity_t *entity = is_static ? NULL : &draw.env_entities.data[env_draw->entity_idx];
+
+                // Applying a pipeline resets the uniforms and bindings too
+                bool pipeline_changed = i == 0 || is_static != last_is_static;
+                bool entity_changed = pipeline_changed || env_draw->entity_idx != last_entity_idx;
+                bool lightmap_changed = pipeline_changed || env_draw->lightmap_idx != last_lightmap_idx;
+                if (pipeline_changed) {
+                    sg_apply_pipeline(is_static ? static_pipeline->sg_pipeline : pipeline->sg_pipeline);
                 }
 
-                golf_model_t *model = golf_entity_get_model(entity);
-                golf_transform_t world_transform = golf_entity_get_world_transform(level, entity);
-                golf_movement_t *movement = golf_entity_get_movement(entity);
-                if (movement) {
-                    world_transform = golf_transform_apply_movement(world_transform, *movement, game->t);
+                if (entity_changed) {
+                    golf_environment_material_vs_params_t vs_params = {
+                        .model_mat = is_static ? mat4_identity() : entity->model_mat,
+                        .proj_view_mat = proj_view_mat,
+                    };
+                    golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_ENVIRONMENT_MATERIAL_VS_PARAMS, &vs_params);
                 }
-                mat4 model_mat = golf_transform_get_model_mat(world_transform);
 
-                golf_lightmap_section_t *lightmap_section = golf_entity_get_lightmap_section(entity);
-                golf_lightmap_image_t lightmap_image;
-                if (!golf_level_get_lightmap_image(level, lightmap_section->lightmap_name, &lightmap_image)) {
-                    golf_log_warning("Could not find lightmap %s", lightmap_section->lightmap_name);
-                    continue;
+                if (entity_changed || lightmap_changed) {
+                    golf_environment_material_fs_params_t fs_params = {
+                        .ball_position = V4(ball_pos.x, ball_pos.y, ball_pos.z, 0),
+                        .lightmap_texture_a = lightmap->t,
+                        .uv_scale = is_static ? 1 : entity->uv_scale,
+                    };
+                    golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_ENVIRONMENT_MATERIAL_FS_PARAMS, &fs_params);
                 }
 
-                for (int i = 0; i < model->groups.length; i++) {
-                    golf_model_group_t group = model->groups.data[i];
-                    golf_material_t material;
-                    if (!golf_level_get_material(level, group.material_name, &material)) {
-                        golf_log_warning("Could not find material %s", group.material_name);
-                        material = golf_material_texture("", 0, 0, 0, "data/textures/fallback.png");
-                    }
-                    if (material.type != GOLF_MATERIAL_ENVIRONMENT) {
-                        continue;
-                    }
-
-                    int num_samples = lightmap_image.num_samples;
-                    int sample0 = 0;
-                    int sample1 = 0;
-                    float lightmap_t = 0;
-                    if (lightmap_image.time_length > 0 && lightmap_image.num_samples > 1) {
-                        float t = fmodf(game->t, lightmap_image.time_length) / lightmap_image.time_length;
-                        if (lightmap_image.repeats) {
-                            t = 2.0f * t;
-                            if (t > 1.0f) {
-                                t = 2.0f - t;
-                            }
-                        }
-                        for (int i = 1; i < num_samples; i++) {
-                            if (t < i / ((float) (num_samples - 1))) {
-                                sample0 = i - 1;
-                                sample1 = i;
-                                break;
-                            }
-                        }
-
-                        float lightmap_t0 = sample0 / ((float) num_samples - 1);
-                        float lightmap_t1 = sample1 / ((float) num_samples - 1);
-                        lightmap_t = (t - lightmap_t0) / (lightmap_t1 - lightmap_t0);
-                        lightmap_t = golf_clampf(lightmap_t, 0, 1);
-                    }
-
-                    vec3 ball_pos = game->ball.draw_pos;
-
-                    golf_shader_uniform_t *vs_uniform = golf_shader_vs_uniform_setup(shader, "environment_material_vs_params", 2,
-                            UNIFORM_MAT4("proj_view_mat", mat4_transpose(graphics->proj_view_mat)),
-                            UNIFORM_MAT4("model_mat", mat4_transpose(model_mat)));
-                    sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
-
-                    golf_shader_uniform_t *fs_uniform = golf_shader_fs_uniform_setup(shader, "environment_material_fs_params", 3,
-                            UNIFORM_VEC4("ball_position", V4(ball_pos.x, ball_pos.y, ball_pos.z, 0)),
-                            UNIFORM_FLOAT("lightmap_texture_a", lightmap_t),
-                            UNIFORM_FLOAT("uv_scale", uv_scale));
-                    sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
-
+                if (entity_changed || lightmap_changed || env_draw->texture != last_texture) {
                     sg_bindings bindings = {
-                        .vertex_buffers[0] = model->sg_positions_buf,
-                        .vertex_buffers[1] = model->sg_texcoords_buf,
-                        .vertex_buffers[2] = model->sg_normals_buf,
-                        .vertex_buffers[3] = lightmap_section->sg_uvs_buf,
-                        .fs_images[0] = material.texture->sg_image,
-                        .fs_images[1] = lightmap_image.sg_image[sample0],
-                        .fs_images[2] = lightmap_image.sg_image[sample1],
+                        .fs_images[0] = env_draw->texture->sg_image,
+                        .fs_images[1] = lightmap->image->sg_image[lightmap->sample0],
+                        .fs_images[2] = lightmap->image->sg_image[lightmap->sample1],
                     };
+                    if (is_static) {
+                        bindings.vertex_buffers[0] = draw.env_static_buf;
+                        bindings.index_buffer = draw.env_static_index_buf;
+                    }
+                    else {
+                        bindings.vertex_buffers[0] = entity->model->sg_positions_buf;
+                        bindings.vertex_buffers[1] = entity->model->sg_texcoords_buf;
+                        bindings.vertex_buffers[2] = entity->model->sg_normals_buf;
+                        bindings.vertex_buffers[3] = entity->lightmap_section->sg_uvs_buf;
+                    }
                     sg_apply_bindings(&bindings);
-
-                    sg_draw(group.start_vertex, group.vertex_count, 1);
                 }
+
+                last_is_static = is_static;
+                last_entity_idx = env_draw->entity_idx;
+                last_lightmap_idx = env_draw->lightmap_idx;
+                last_texture = env_draw->texture;
+                sg_draw(env_draw->base_element, env_draw->num_elements, 1);
             }
         }
 
@@ -142,10 +474,11 @@ static void _draw_game(void) {
             vec3 ball_pos = game->ball.draw_pos;
             vec3 ball_scale = V3(game->ball.radius, game->ball.radius, game->ball.radius);
             golf_model_t *model = golf_data_get_model("data/models/golf_ball.obj");
-            mat4 model_mat = mat4_multiply_n(3,
+            mat4 model_mat = mat4_multiply_n(4,
                     mat4_translation(ball_pos),
                     mat4_scale(ball_scale),
-                    mat4_from_quat(game->ball.orientation));
+                    mat4_from_quat(game->ball.orientation),
+                    golf_model_get_pack_mat(model));
             golf_texture_t *texture = golf_data_get_texture("data/textures/golf_ball_normal_map.jpg");
             vec4 color = V4(1, 1, 1, 1);
 
@@ -157,14 +490,16 @@ static void _draw_game(void) {
             };
             sg_apply_bindings(&bindings);
 
-            golf_shader_uniform_t *vs_uniform = golf_shader_vs_uniform_setup(shader, "ball_vs_params", 2,
-                    UNIFORM_MAT4("proj_view_mat", mat4_transpose(graphics->proj_view_mat)),
-                    UNIFORM_MAT4("model_mat", mat4_transpose(model_mat)));
-            sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
+            golf_ball_vs_params_t vs_params = {
+                .proj_view_mat = mat4_transpose(graphics->proj_view_mat),
+                .model_mat = mat4_transpose(model_mat),
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_BALL_VS_PARAMS, &vs_params);
 
-            golf_shader_uniform_t *fs_uniform = golf_shader_fs_uniform_setup(shader, "ball_fs_params", 1,
-                    UNIFORM_VEC4("color", color));
-            sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
+            golf_ball_fs_params_t fs_params = {
+                .color = color,
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_BALL_FS_PARAMS, &fs_params);
 
             sg_draw(0, model->positions.length, 1);
         }
@@ -178,10 +513,11 @@ static void _draw_game(void) {
             vec3 cam_pos = graphics->cam_pos;
             vec3 ball_pos = game->ball.draw_pos;
             float ball_radius = game->ball.radius;
-            mat4 model_mat = mat4_multiply_n(2,
-                    mat4_translation(ball_pos),
-                    mat4_scale(V3(ball_radius + 0.001f, ball_radius + 0.001f, ball_radius + 0.001f)));
             golf_model_t *model = golf_data_get_model("data/models/golf_ball.obj");
+            mat4 model_mat = mat4_multiply_n(3,
+                    mat4_translation(ball_pos),
+                    mat4_scale(V3(ball_radius + 0.001f, ball_radius + 0.001f, ball_radius + 0.001f)),
+                    golf_model_get_pack_mat(model));
 
             sg_bindings bindings = {
                 .vertex_buffers[0] = model->sg_positions_buf,
@@ -189,15 +525,17 @@ static void _draw_game(void) {
             };
             sg_apply_bindings(&bindings);
 
-            golf_shader_uniform_t *vs_uniform = golf_shader_vs_uniform_setup(shader, "vs_params", 2,
-                    UNIFORM_MAT4("model_mat", mat4_transpose(model_mat)),
-                    UNIFORM_MAT4("proj_view_mat", mat4_transpose(graphics->proj_view_mat)));
-            sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
+            golf_ball_hidden_vs_params_t vs_params = {
+                .model_mat = mat4_transpose(model_mat),
+                .proj_view_mat = mat4_transpose(graphics->proj_view_mat),
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_BALL_HIDDEN_VS_PARAMS, &vs_params);
 
-            golf_shader_uniform_t *fs_uniform = golf_shader_fs_uniform_setup(shader, "fs_params", 2,
-                    UNIFORM_VEC4("ball_position", V4(ball_pos.x, ball_pos.y, ball_pos.z, 0)),
-                    UNIFORM_VEC4("cam_position", V4(cam_pos.x, cam_pos.y, cam_pos.z, 0)));
-            sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
+            golf_ball_hidden_fs_params_t fs_params = {
+                .ball_position = V4(ball_pos.x, ball_pos.y, ball_pos.z, 0),
+                .cam_position = V4(cam_pos.x, cam_pos.y, cam_pos.z, 0),
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_BALL_HIDDEN_FS_PARAMS, &fs_params);
 
             sg_draw(0, model->positions.length, 1);
         }
@@ -228,7 +566,7 @@ static void _draw_game(void) {
 
                 golf_model_t *model = golf_entity_get_model(entity);
                 golf_transform_t world_transform = golf_entity_get_world_transform(level, entity);
-                mat4 model_mat = golf_transform_get_model_mat(world_transform);
+                mat4 model_mat = mat4_multiply(golf_transform_get_model_mat(world_transform), golf_model_get_pack_mat(model));
                 golf_texture_t *noise_tex0 = golf_data_get_texture("data/textures/water_noise_1.png");
                 golf_texture_t *noise_tex1 = golf_data_get_texture("data/textures/water_noise_2.png");
 
@@ -249,14 +587,16 @@ static void _draw_game(void) {
                 };
                 sg_apply_bindings(&bindings);
 
-                golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "water_vs_params");
-                golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(model_mat));
-                golf_shader_uniform_set_mat4(vs_uniform, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-                sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
+                golf_water_vs_params_t vs_params = {
+                    .proj_view_mat = mat4_transpose(graphics->proj_view_mat),
+                    .model_mat = mat4_transpose(model_mat),
+                };
+                golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_WATER_VS_PARAMS, &vs_params);
 
-                golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "water_fs_params");
-                golf_shader_uniform_set_float(fs_uniform, "t", game->t);
-                sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
+                golf_water_fs_params_t fs_params = {
+                    .t = game->t,
+                };
+                golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_WATER_FS_PARAMS, &fs_params);
 
                 sg_draw(0, model->positions.length, 1);
             }
@@ -277,18 +617,21 @@ static void _draw_game(void) {
             };
             sg_apply_bindings(&bindings);
 
-            golf_shader_uniform_t *vs_params = golf_shader_get_vs_uniform(shader, "vs_params");
-            golf_shader_uniform_set_mat4(vs_params, "mvp_mat", mat4_transpose(
-                        mat4_multiply_n(4, 
+            golf_water_around_ball_vs_params_t vs_params = {
+                .mvp_mat = mat4_transpose(
+                        mat4_multiply_n(5, 
                             graphics->proj_view_mat,
                             mat4_translation(vec3_sub(game->ball.draw_pos, V3(0.0f, 0.02f, 0.0f))),
                             mat4_scale(V3(0.4f, 0.4f, 0.4f)),
-                            mat4_rotation_x(-0.5f * MF_PI))));
-            sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_params->data, vs_params->size });
+                            mat4_rotation_x(-0.5f * MF_PI),
+                            golf_model_get_pack_mat(model))),
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_WATER_AROUND_BALL_VS_PARAMS, &vs_params);
 
-            golf_shader_uniform_t *fs_params = golf_shader_get_fs_uniform(shader, "fs_params");
-            golf_shader_uniform_set_float(fs_params, "t", game->t);
-            sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_params->data, fs_params->size });
+            golf_water_around_ball_fs_params_t fs_params = {
+                .t = game->t,
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_WATER_AROUND_BALL_FS_PARAMS, &fs_params);
 
             sg_draw(0, model->positions.length, 1);
         }
@@ -316,19 +659,22 @@ static void _draw_game(void) {
                 };
                 sg_apply_bindings(&bindings);
 
-                mat4 mvp_mat = mat4_multiply_n(4, 
+                mat4 mvp_mat = mat4_multiply_n(5, 
                         graphics->proj_view_mat,
                         mat4_translation(pos),
                         mat4_scale(V3(0.4f, 0.4f, 0.4f)),
-                        mat4_rotation_x(-0.5f * MF_PI));
-                golf_shader_uniform_t *vs_params = golf_shader_get_vs_uniform(shader, "vs_params");
-                golf_shader_uniform_set_mat4(vs_params, "mvp_mat", mat4_transpose(mvp_mat));
-                sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_params->data, vs_params->size });
+                        mat4_rotation_x(-0.5f * MF_PI),
+                        golf_model_get_pack_mat(model));
+                golf_water_ripple_vs_params_t vs_params = {
+                    .mvp_mat = mat4_transpose(mvp_mat),
+                };
+                golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_WATER_RIPPLE_VS_PARAMS, &vs_params);
 
-                golf_shader_uniform_t *fs_params = golf_shader_get_fs_uniform(shader, "fs_params");
-                golf_shader_uniform_set_float(fs_params, "t", dt);
-                golf_shader_uniform_set_vec4(fs_params, "uniform_color", color);
-                sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_params->data, fs_params->size });
+                golf_water_ripple_fs_params_t fs_params = {
+                    .t = dt,
+                    .uniform_color = color,
+                };
+                golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_WATER_RIPPLE_FS_PARAMS, &fs_params);
 
                 sg_draw(0, model->positions.length, 1);
             }
@@ -386,26 +732,29 @@ static void _draw_game(void) {
                 float z_rotation = asinf(dir.y);
                 float y_rotation = acosf(dir2.x);
                 if (dir2.y > 0) y_rotation *= -1;
-                mat4 model_mat = mat4_multiply_n(6,
+                mat4 model_mat = mat4_multiply_n(7,
                         mat4_translation(p0),
                         mat4_rotation_y(y_rotation),
                         mat4_rotation_z(z_rotation),
                         mat4_scale(V3(0.5f * len, 1.0f, 0.1f)),
                         mat4_translation(V3(1, 0, 0)),
-                        mat4_rotation_x(0.5f * MF_PI));
+                        mat4_rotation_x(0.5f * MF_PI),
+                        golf_model_get_pack_mat(square));
 
-                golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "aim_line_vs_params");
-                golf_shader_uniform_set_mat4(vs_uniform, "mvp_mat", mat4_transpose(mat4_multiply(graphics->proj_view_mat, model_mat)));
-                sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
-
-                golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "aim_line_fs_params");
-                golf_shader_uniform_set_vec4(fs_uniform, "color", V4(1, 1, 1, 1));
-                golf_shader_uniform_set_vec2(fs_uniform, "texture_coord_offset", offset);
-                golf_shader_uniform_set_vec2(fs_uniform, "texture_coord_scale", V2(4 * len, 1));
-                golf_shader_uniform_set_float(fs_uniform, "length0", len0);
-                golf_shader_uniform_set_float(fs_uniform, "length1", len1);
-                golf_shader_uniform_set_float(fs_uniform, "total_length", total_length);
-                sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
+                golf_aim_line_vs_params_t vs_params = {
+                    .mvp_mat = mat4_transpose(mat4_multiply(graphics->proj_view_mat, model_mat)),
+                };
+                golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_AIM_LINE_VS_PARAMS, &vs_params);
+
+                golf_aim_line_fs_params_t fs_params = {
+                    .color = V4(1, 1, 1, 1),
+                    .texture_coord_offset = offset,
+                    .texture_coord_scale = V2(4 * len, 1),
+                    .length0 = len0,
+                    .length1 = len1,
+                    .total_length = total_length,
+                };
+                golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_AIM_LINE_FS_PARAMS, &fs_params);
 
                 sg_draw(0, square->positions.length, 1);
 
@@ -449,12 +798,13 @@ static void _draw_game(void) {
                     case HOLE_ENTITY: {
                         golf_transform_t transform = entity->hole.transform;
                         transform.position.y += 0.001f;
-                        mat4 model_mat = golf_transform_get_model_mat(transform);
                         golf_model_t *model = golf_data_get_model("data/models/hole-cover.obj");
+                        mat4 model_mat = mat4_multiply(golf_transform_get_model_mat(transform), golf_model_get_pack_mat(model));
 
-                        golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "pass_through_vs_params");
-                        golf_shader_uniform_set_mat4(vs_uniform, "mvp_mat", mat4_transpose(mat4_multiply(graphics->proj_view_mat, model_mat)));
-                        sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
+                        golf_pass_through_vs_params_t vs_params = {
+                            .mvp_mat = mat4_transpose(mat4_multiply(graphics->proj_view_mat, model_mat)),
+                        };
+                        golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_PASS_THROUGH_VS_PARAMS, &vs_params);
 
                         sg_bindings bindings = {
                             .vertex_buffers[0] = model->sg_positions_buf,
@@ -506,18 +856,20 @@ static void _draw_game(void) {
                     case HOLE_ENTITY: {
                         golf_transform_t transform = entity->hole.transform;
                         transform.position.y += 0.001f;
-                        mat4 model_mat = golf_transform_get_model_mat(transform);
                         golf_model_t *model = golf_data_get_model("data/models/hole.obj");
+                        mat4 model_mat = mat4_multiply(golf_transform_get_model_mat(transform), golf_model_get_pack_mat(model));
                         golf_texture_t *texture = golf_data_get_texture("data/textures/hole_lightmap.png");
 
-                        golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "texture_material_vs_params");
-                        golf_shader_uniform_set_mat4(vs_uniform, "proj_view_mat", mat4_transpose(graphics->proj_view_mat));
-                        golf_shader_uniform_set_mat4(vs_uniform, "model_mat", mat4_transpose(model_mat));
-                        sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
+                        golf_texture_material_vs_params_t vs_params = {
+                            .model_mat = mat4_transpose(model_mat),
+                            .proj_view_mat = mat4_transpose(graphics->proj_view_mat),
+                        };
+                        golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_TEXTURE_MATERIAL_VS_PARAMS, &vs_params);
 
-                        golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "fs_params");
-                        golf_shader_uniform_set_float(fs_uniform, "alpha", 1);
-                        sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
+                        golf_texture_material_fs_params_t fs_params = {
+                            .alpha = 1,
+                        };
+                        golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_TEXTURE_MATERIAL_FS_PARAMS, &fs_params);
 
                         sg_bindings bindings = {
                             .vertex_buffers[0] = model->sg_positions_buf,
@@ -542,10 +894,11 @@ static void _draw_game(void) {
             vec3 ball_pos = game->ball.draw_pos;
             vec3 ball_scale = V3(game->ball.radius, game->ball.radius, game->ball.radius);
             golf_model_t *model = golf_data_get_model("data/models/golf_ball.obj");
-            mat4 model_mat = mat4_multiply_n(3,
+            mat4 model_mat = mat4_multiply_n(4,
                     mat4_translation(ball_pos),
                     mat4_scale(ball_scale),
-                    mat4_from_quat(game->ball.orientation));
+                    mat4_from_quat(game->ball.orientation),
+                    golf_model_get_pack_mat(model));
             golf_texture_t *texture = golf_data_get_texture("data/textures/golf_ball_normal_map.jpg");
             vec4 color = V4(1, 1, 1, 1);
 
@@ -557,14 +910,16 @@ static void _draw_game(void) {
             };
             sg_apply_bindings(&bindings);
 
-            golf_shader_uniform_t *vs_uniform = golf_shader_vs_uniform_setup(shader, "ball_vs_params", 2,
-                    UNIFORM_MAT4("proj_view_mat", mat4_transpose(graphics->proj_view_mat)),
-                    UNIFORM_MAT4("model_mat", mat4_transpose(model_mat)));
-            sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size });
+            golf_ball_vs_params_t vs_params = {
+                .proj_view_mat = mat4_transpose(graphics->proj_view_mat),
+                .model_mat = mat4_transpose(model_mat),
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_BALL_VS_PARAMS, &vs_params);
 
-            golf_shader_uniform_t *fs_uniform = golf_shader_fs_uniform_setup(shader, "ball_fs_params", 1,
-                    UNIFORM_VEC4("color", color));
-            sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
+            golf_ball_fs_params_t fs_params = {
+                .color = color,
+            };
+            golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_BALL_FS_PARAMS, &fs_params);
 
             sg_draw(0, model->positions.length, 1);
         }
@@ -610,25 +965,28 @@ static void _draw_ui(void) {
                     };
                     sg_apply_bindings(&bindings);
 
-                    mat4 mvp_mat = mat4_transpose(mat4_multiply_n(4,
+                    mat4 mvp_mat = mat4_transpose(mat4_multiply_n(5,
                                 ui_proj_mat,
                                 mat4_translation(translate),
                                 mat4_rotation_z(angle),
-                                mat4_scale(scale)));
-
-                    golf_shader_uniform_t *vs_uniform = golf_shader_get_vs_uniform(shader, "ui_vs_params");
-                    golf_shader_uniform_set_mat4(vs_uniform, "mvp_mat", mvp_mat);
-                    sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &(sg_range) { vs_uniform->data, vs_uniform->size } );
-
-                    golf_shader_uniform_t *fs_uniform = golf_shader_get_fs_uniform(shader, "ui_fs_params");
-                    golf_shader_uniform_set_float(fs_uniform, "tex_x", draw.uv0.x);
-                    golf_shader_uniform_set_float(fs_uniform, "tex_y", draw.uv0.y);
-                    golf_shader_uniform_set_float(fs_uniform, "tex_dx", draw.uv1.x - draw.uv0.x);
-                    golf_shader_uniform_set_float(fs_uniform, "tex_dy", draw.uv1.y - draw.uv0.y);
-                    golf_shader_uniform_set_float(fs_uniform, "is_font", draw.is_font);
-                    golf_shader_uniform_set_vec4(fs_uniform, "color", draw.overlay_color);
-                    golf_shader_uniform_set_float(fs_uniform, "alpha", draw.alpha);
-                    sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &(sg_range) { fs_uniform->data, fs_uniform->size });
+                                mat4_scale(scale),
+                                golf_model_get_pack_mat(square)));
+
+                    golf_ui_vs_params_t vs_params = {
+                        .mvp_mat = mvp_mat,
+                    };
+                    golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_UI_VS_PARAMS, &vs_params);
+
+                    golf_ui_fs_params_t fs_params = {
+                        .color = draw.overlay_color,
+                        .alpha = draw.alpha,
+                        .tex_x = draw.uv0.x,
+                        .tex_y = draw.uv0.y,
+                        .tex_dx = draw.uv1.x - draw.uv0.x,
+                        .tex_dy = draw.uv1.y - draw.uv0.y,
+                        .is_font = draw.is_font,
+                    };
+                    golf_shader_apply_uniforms(shader, GOLF_UNIFORMS_UI_FS_PARAMS, &fs_params);
 
                     sg_draw(0, square->positions.length, 1);
                     break;
@@ -694,6 +1052,13 @@ void golf_draw_init(void) {
 
     memset(&draw, 0, sizeof(draw));
     draw.game_draw_pass_size = graphics->viewport_size;
+    vec_init(&draw.env_entities, "draw");
+    vec_init(&draw.env_lightmaps, "draw");
+    vec_init(&draw.env_textures, "draw");
+    vec_init(&draw.env_draws, "draw");
+    vec_init(&draw.env_static_vertices, "draw");
+    vec_init(&draw.env_static_indices, "draw");
+    vec_init(&draw.env_static_slots, "draw");
     _golf_draw_update_create_draw_pass();
 }
 
@@ -724,6 +1089,7 @@ void golf_draw(void) {
             golf_shader_pipeline_t *pipeline = golf_shader_get_pipeline(shader, "fxaa");
 
             sg_apply_pipeline(pipeline->sg_pipeline);
+            // The square spans [-1, 1], so its packed positions are already in clip space
             golf_model_t *square = golf_data_get_model("data/models/render_image_square.obj");
             sg_bindings bindings = {
                 .vertex_buffers[0] = square->sg_positions_buf,
@@ -15,6 +15,7 @@
 #include "common/log.h"
 #include "common/storage.h"
 #include "golf/golf.h"
+#include "golf/sim.h"
 
 static golf_game_t game;
 static golf_t *golf;
@@ -22,6 +23,26 @@ static golf_graphics_t *graphics;
 static golf_inputs_t *inputs;
 static golf_config_t *game_cfg;
 
+static const golf_config_binding_t _game_param_bindings[] = {
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, aim_line_min_length, "aim_line_min_length"),
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, aim_line_max_length, "aim_line_max_length"),
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, begin_camera_animation_length0, "begin_camera_animation_length0"),
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, begin_camera_animation_length1, "begin_camera_animation_length1"),
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, cam_auto_rotate_speed, "cam_auto_rotate_speed"),
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, celebration_length, "celebration_length"),
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, water_ripple_frequency, "water_ripple_frequency"),
+    GOLF_CONFIG_BIND_NUM(golf_game_params_t, water_ripple_time_length, "water_ripple_time_length"),
+};
+
+static void _golf_game_update_params(void) {
+    if (game.params.cfg_version == game_cfg->version) {
+        return;
+    }
+
+    golf_config_bind(game_cfg, _game_param_bindings, (int)(sizeof(_game_param_bindings) / sizeof(_game_param_bindings[0])), &game.params);
+    game.params.cfg_version = game_cfg->version;
+}
+
 golf_game_t *golf_game_get(void) {
     return &game;
 }
@@ -33,9 +54,25 @@ static void _golf_game_debug_tab(void) {
         "Face",
     };
 
+    {
+        static char replay_path[GOLF_FILE_MAX_PATH] = "last.golf_replay";
+        igInputText("Replay path", replay_path, GOLF_FILE_MAX_PATH, ImGuiInputTextFlags_None, NULL, NULL);
+        if (igButton("Save Replay", (ImVec2){0, 0})) {
+            golf_game_save_replay(replay_path);
+        }
+        igSameLine(0, -1);
+        if (igButton("Play Replay", (ImVec2){0, 0})) {
+            golf_game_play_replay(replay_path);
+        }
+        igText("Recorded frames: %d", game.replay.recording.frame_dts.length);
+        if (game.replay.is_playing) {
+            igText("Playing frame %d / %d", game.replay.player.frame, game.replay.playback.frame_dts.length);
+        }
+    }
+
     igCheckbox("Debug draw collisions", &game.physics.debug_draw_collisions);
-    for (int i = 0; i < game.physics.collision_history.length; i++) {
-        golf_collision_data_t *collision = &game.physics.collision_history.data[i]; 
+    for (int i = 0; i < game.physics.sim.collision_history.length; i++) {
+        golf_collision_data_t *collision = &game.physics.sim.collision_history.data[i]; 
         collision->is_highlighted = false;
         if (igTreeNodeEx_Ptr((void*)(intptr_t)i, ImGuiTreeNodeFlags_None, "Collision %d", i)) {
             collision->is_highlighted = true;
@@ -104,33 +141,27 @@ void golf_game_init(void) {
     graphics = golf_graphics_get();
     inputs = golf_inputs_get();
     game_cfg = golf_data_get_config("data/config/game.cfg");
+    _golf_game_update_params();
 
     game.state = GOLF_GAME_STATE_MAIN_MENU;
     game.cam.auto_rotate = true;
     game.cam.angle = 0;
     game.cam.angle_velocity = 0;
 
-    game.ball.pos = V3(0, 0, 0);
-    game.ball.draw_pos = V3(0, 0, 0);
-    game.ball.vel = V3(0, 0, 0);
-    game.ball.rot_vec = V3(0, 0, 0);
-    game.ball.orientation = QUAT(0, 0, 0, 1);
-    game.ball.radius = 0.12f;
-    game.ball.time_going_slow = 0;
-    game.ball.time_since_water_ripple = 0;
-    game.ball.rot_vel = 0;
-    game.ball.is_moving = false;
-    game.ball.is_out_of_bounds = false;
-    game.ball.is_in_hole = false;
-    game.ball.time_since_impact_sound = 0;
-    game.ball.time_out_of_water = 1;
-
-    game.physics.time_behind = 0;
+    golf_sim_ball_init(&game.ball, V3(0, 0, 0));
+    game.ball_effects.time_since_water_ripple = 0;
+    game.ball_effects.time_since_impact_sound = 0;
+    game.ball_effects.time_out_of_water = 1;
+
+    golf_sim_init(&game.physics.sim, game_cfg);
+    game.physics.sim.record_collisions = true;
     game.physics.debug_draw_collisions = false;
-    vec_init(&game.physics.collision_history, "physics");
 
-    golf_bvh_init(&game.physics.static_bvh);
-    golf_bvh_init(&game.physics.dynamic_bvh);
+    game.replay.is_recording = false;
+    game.replay.is_playing = false;
+    game.replay.is_replay_attempt = false;
+    golf_replay_init(&game.replay.recording);
+    golf_replay_init(&game.replay.playback);
 
     game.aim_line.power = 0;
     game.aim_line.aim_delta = V2(0, 0);
@@ -187,8 +218,8 @@ static void _golf_game_update_state_aiming(float dt) {
         game.aim_line.num_points = 0;
         vec3 cur_point = game.ball.pos;
         vec3 cur_dir = aim_direction;
-        float min_length = CFG_NUM(game_cfg, "aim_line_min_length");
-        float max_length = CFG_NUM(game_cfg, "aim_line_max_length");
+        float min_length = game.params.aim_line_min_length;
+        float max_length = game.params.aim_line_max_length;
         max_length = min_length + game.aim_line.power * (max_length - min_length);
         float t = 0;
         while (true) {
@@ -197,27 +228,10 @@ static void _golf_game_update_state_aiming(float dt) {
             game.aim_line.points[idx] = cur_point;
             if (t >= max_length) break;
 
-            golf_bvh_face_t static_hit_face;
-            float static_hit_t = FLT_MAX;
-            int static_hit_idx;
-            golf_bvh_ray_test(&game.physics.static_bvh, cur_point, cur_dir, &static_hit_t, &static_hit_idx, &static_hit_face);
-
-            golf_bvh_face_t dynamic_hit_face;
-            float dynamic_hit_t = FLT_MAX;
-            int dynamic_hit_idx;
-            golf_bvh_ray_test(&game.physics.dynamic_bvh, cur_point, cur_dir, &dynamic_hit_t, &dynamic_hit_idx, &dynamic_hit_face);
-
             golf_bvh_face_t hit_face;
             float hit_t = FLT_MAX;
-
-            if (static_hit_t < dynamic_hit_t) {
-                hit_face = static_hit_face;
-                hit_t = static_hit_t;
-            }
-            else if (dynamic_hit_t < static_hit_t) {
-                hit_face = dynamic_hit_face;
-                hit_t = dynamic_hit_t;
-            }
+            int hit_idx;
+            golf_tlas_ray_test(&game.physics.sim.bvh, cur_point, cur_dir, &hit_t, &hit_idx, &hit_face);
 
             if (hit_t < FLT_MAX) {
                 if (t + hit_t > max_length) {
@@ -249,6 +263,9 @@ static void _golf_game_update_state_watching_ball(float dt) {
     if (game.ball.is_in_hole) {
         game.ball.vel = V3(0, 0, 0);
         game.ball.is_moving = false;
+        if (game.replay.is_recording) {
+            golf_replay_add_ball(&game.replay.recording, &game.ball);
+        }
 
         game.state = GOLF_GAME_STATE_CELEBRATION;
         game.celebration.t = 0;
@@ -257,7 +274,7 @@ static void _golf_game_update_state_watching_ball(float dt) {
         game.celebration.cam_pos1 = vec3_add(graphics->cam_pos, vec3_scale(graphics->cam_dir, -1.5f));
         game.celebration.cam_dir1 = vec3_normalize(vec3_sub(game.ball.draw_pos, game.celebration.cam_pos1));
 
-        {
+        if (!game.replay.is_replay_attempt) {
             char storage_key[256];
             snprintf(storage_key, 256, "stroke_count_level_%d", golf->level_num);
 
@@ -279,6 +296,9 @@ static void _golf_game_update_state_watching_ball(float dt) {
         game.ball.rot_vel = 0;
         game.ball.orientation = QUAT(0, 0, 0, 1);
         game.ball.is_out_of_bounds = 0;
+        if (game.replay.is_recording) {
+            golf_replay_add_ball(&game.replay.recording, &game.ball);
+        }
         game.cam.angle = game.cam.start_angle;
         game.cam.auto_rotate = false;
         game.state = GOLF_GAME_STATE_WAITING_FOR_AIM;
@@ -289,391 +309,22 @@ static void _golf_game_update_state_watching_ball(float dt) {
     }
 }
 
-int _ball_contact_cmp(const void *a, const void *b) {
-    const golf_ball_contact_t *bc0 = (golf_ball_contact_t*)a;
-    const golf_ball_contact_t *bc1 = (golf_ball_contact_t*)b;
-
-    if (bc1->distance > bc0->distance) {
-        return -1;
-    }
-    else if (bc1->distance < bc0->distance) {
-        return 1;
-    }
-    else if (bc1->vel_scale > bc0->vel_scale) {
-        return 1;
-    }
-    else if (bc1->vel_scale < bc0->vel_scale) {
-        return -1;
-    }
-    else if (bc1->restitution > bc0->restitution) {
-        return -1;
-    }
-    else if (bc1->restitution < bc0->restitution) {
-        return 1;
-    }
-    else {
-        return 0;
-    }
-}
-
-static void _physics_tick(float dt) {
-    float EPS = 0.001f;
-
-    vec3 bp = game.ball.pos;
-    float br = game.ball.radius;
-    vec3 bv = game.ball.vel;
-    float bs = vec3_length(bv);
-    vec3 bp0 = bp;
-    vec3 bv0 = bv;
-
-    float dist_to_hole = FLT_MAX;
-    vec3 dir_to_hole = V3(0, 0, 0);
-    vec3 hole_pos = V3(0, 0, 0);
-    golf_entity_t *close_hole = NULL;
-    for (int i = 0; i < golf->level->entities.length; i++) {
-        golf_entity_t *entity = &golf->level->entities.data[i];
-        if (entity->type == HOLE_ENTITY) {
-            vec3 hp = entity->hole.transform.position;
-            vec3 hs = entity->hole.transform.scale;
-            float dist = vec3_distance(hp, bp);
-            if (dist <= hs.x) {
-                close_hole = entity;
-            }
-            if (dist < dist_to_hole) {
-                dist_to_hole = dist;
-                dir_to_hole = vec3_normalize(vec3_sub(hp, bp));
-                hole_pos = hp;
-            }
-        }
-    }
-
-    // Create the BVH for entities that move
-    {
-        golf_bvh_t *bvh = &game.physics.dynamic_bvh;
-        bvh->node_infos.length = 0;
-        for (int i = 0; i < golf->level->entities.length; i++) {
-            golf_entity_t *entity = &golf->level->entities.data[i];
-
-            switch (entity->type) {
-                case BEGIN_ANIMATION_ENTITY:
-                case CAMERA_ZONE_ENTITY:
-                case MODEL_ENTITY:
-                case WATER_ENTITY:
-                case GEO_ENTITY: {
-                    golf_movement_t *movement = golf_entity_get_movement(entity);
-                    if (movement && movement->type != GOLF_MOVEMENT_NONE) {
-                        vec_push(&bvh->node_infos, golf_bvh_node_info(bvh, i, golf->level, entity, game.t));
-                    }
-                    break;
-                }
-                case BALL_START_ENTITY:
-                case HOLE_ENTITY:
-                case GROUP_ENTITY:
-                    break;
-            }
-        }
-        golf_bvh_construct(bvh, bvh->node_infos);
-    }
-
-    int num_contacts = 0;
-    golf_ball_contact_t contacts[MAX_NUM_CONTACTS];
-    if (close_hole) {
-        golf_model_t *model = golf_entity_get_model(close_hole);
-        golf_transform_t transform = golf_entity_get_world_transform(golf->level, close_hole);
-        mat4 model_mat = golf_transform_get_model_mat(transform);
-        for (int i = 0; i < model->positions.length; i += 3) {
-            vec3 a = vec3_apply_mat4(model->positions.data[i + 0], 1, model_mat);
-            vec3 b = vec3_apply_mat4(model->positions.data[i + 1], 1, model_mat);
-            vec3 c = vec3_apply_mat4(model->positions.data[i + 2], 1, model_mat);
-            triangle_contact_type_t type;
-            vec3 cp = closest_point_point_triangle(bp, a, b, c, &type);
-            float dist = vec3_distance(bp, cp);
-            if (dist < br) {
-                float restitution, friction, vel_scale;
-                if (type == TRIANGLE_CONTACT_AB || type == TRIANGLE_CONTACT_AC || type == TRIANGLE_CONTACT_BC) {
-                    restitution = 0.4f;
-                    if (bs > 2) {
-                        friction = 1;
-                        vel_scale = 0.95f;
-                    }
-                    else {
-                        friction = 0;
-                        vel_scale = 1;
-                    }
-                }
-                else {
-                    restitution = 0.5f;
-                    friction = 0.5f;
-                    vel_scale = 1;
-                }
-                if (num_contacts < MAX_NUM_CONTACTS) {
-                    vec3 vel = V3(0, 0, 0);
-                    golf_ball_contact_t contact = golf_ball_contact(a, b, c, vel, bp, br, cp, dist, restitution, friction, vel_scale, type, false, V3(0, 0, 0), false);
-                    contacts[num_contacts] = contact;
-                    num_contacts = num_contacts + 1;
-                }
-            }
-        }
-    }
-    else {
-        golf_bvh_ball_test(&game.physics.static_bvh, bp, br, bv, contacts, &num_contacts, MAX_NUM_CONTACTS);
-        golf_bvh_ball_test(&game.physics.dynamic_bvh, bp, br, bv, contacts, &num_contacts, MAX_NUM_CONTACTS);
-    }
-    qsort(contacts, num_contacts, sizeof(golf_ball_contact_t), _ball_contact_cmp);
-
-    // Apply a force to pull the ball towards the hole
-    if (dist_to_hole < CFG_NUM(game_cfg, "physics_hole_force_distance") && num_contacts > 0) {
-        float hole_force = CFG_NUM(game_cfg, "physics_hole_force");
-        bv = vec3_add(bv, vec3_scale(dir_to_hole, hole_force));
-    }
-
-    // Filter out the contacts
-    {
-        int num_processed_vertices = 0;
-        vec3 processed_vertices[9 * MAX_NUM_CONTACTS];
-
-        // All face contacts are used
-        for (int i = 0; i < num_contacts; i++) {
-            golf_ball_contact_t *contact = &contacts[i];
-            if (contact->is_ignored || contact->type != TRIANGLE_CONTACT_FACE) {
-                continue;
-            }
-
-            processed_vertices[num_processed_vertices++] = contact->triangle_a;
-            processed_vertices[num_processed_vertices++] = contact->triangle_b;
-            processed_vertices[num_processed_vertices++] = contact->triangle_c;
-        }
-
-        // Remove unecessary edge contacts
-        for (int i = 0; i < num_contacts; i++) {
-            golf_ball_contact_t *contact = &contacts[i];
-            if (contact->is_ignored || 
-                    (contact->type != TRIANGLE_CONTACT_AB && 
-                     contact->type != TRIANGLE_CONTACT_AC &&
-                     contact->type != TRIANGLE_CONTACT_BC)) {
-                continue;
-            }
-
-            vec3 e0 = V3(0, 0, 0);
-            vec3 e1 = V3(0, 0, 0);
-            if (contact->type == TRIANGLE_CONTACT_AB) {
-                e0 = contact->triangle_a;
-                e1 = contact->triangle_b;
-            }
-            else if (contact->type == TRIANGLE_CONTACT_AC) {
-                e0 = contact->triangle_a;
-                e1 = contact->triangle_c;
-            }
-            else if (contact->type == TRIANGLE_CONTACT_BC) {
-                e0 = contact->triangle_b;
-                e1 = contact->triangle_c;
-            }
-
-            for (int j = 0; j < num_processed_vertices; j += 3) {
-                vec3 a = processed_vertices[j + 0];
-                vec3 b = processed_vertices[j + 1];
-                vec3 c = processed_vertices[j + 2];
-                if (vec3_line_segments_on_same_line(a, b, e0, e1, EPS) ||
-                        vec3_line_segments_on_same_line(a, c, e0, e1, EPS) ||
-                        vec3_line_segments_on_same_line(b, c, e0, e1, EPS)) {
-                    contact->is_ignored = true;
-                    break;
-                }
-            }
-
-            processed_vertices[num_processed_vertices++] = contact->triangle_a;
-            processed_vertices[num_processed_vertices++] = contact->triangle_b;
-            processed_vertices[num_processed_vertices++] = contact->triangle_c;
-        }
-
-        // Remove uncessary point contacts
-        for (int i = 0; i < num_contacts; i++) {
-            golf_ball_contact_t *contact = &contacts[i];
-            if (contact->is_ignored ||
-                    (contact->type != TRIANGLE_CONTACT_A && 
-                     contact->type != TRIANGLE_CONTACT_B &&
-                     contact->type != TRIANGLE_CONTACT_C)) {
-                continue;
-            }
-
-            vec3 p = V3(0, 0, 0);
-            if (contact->type == TRIANGLE_CONTACT_A) {
-                p = contact->triangle_a;
-            }
-            else if (contact->type == TRIANGLE_CONTACT_B) {
-                p = contact->triangle_b;
-            }
-            else if (contact->type == TRIANGLE_CONTACT_C) {
-                p = contact->triangle_c;
-            }
-
-            for (int j = 0; j < num_processed_vertices; j++) {
-                vec3 a = processed_vertices[j + 0];
-                vec3 b = processed_vertices[j + 1];
-                vec3 c = processed_vertices[j + 2];
-                if (vec3_point_on_line_segment(p, a, b, EPS) ||
-                        vec3_point_on_line_segment(p, a, c, EPS) ||
-                        vec3_point_on_line_segment(p, b, c, EPS)) {
-                    contact->is_ignored = true;
-                    break;
-                }
-            }
-
-            processed_vertices[num_processed_vertices++] = contact->triangle_a;
-            processed_vertices[num_processed_vertices++] = contact->triangle_b;
-            processed_vertices[num_processed_vertices++] = contact->triangle_c;
-        }
-    }
-
-    for (int i = 0; i < num_contacts; i++) {
-        golf_ball_contact_t *contact = &contacts[i];
-        if (contact->is_ignored) {
-            continue;
-        }
-        if (contact->is_water) {
-            continue;
-        }
-
-        vec3 n = contact->normal;
-        vec3 vr = vec3_sub(bv, contact->velocity);
-        contact->cull_dot = vec3_dot(n, vec3_normalize(vr));
-        if (contact->cull_dot > EPS) {
-            contact->is_ignored = true;
-            continue;
-        }
-
-        float e = contact->restitution;
-        float v_scale = contact->vel_scale;
-        float imp = -(1 + e) * vec3_dot(vr, n);
-
-        contact->impulse_mag = imp; 
-        contact->impulse = vec3_scale(n, imp);
-        contact->v0 = bv0;
-
-        bv = vec3_add(bv, contact->impulse);
-        bv = vec3_scale(bv, v_scale);
-
-        game.ball.rot_vel = vec3_length(bv) / (MF_PI * game.ball.radius);
-        game.ball.rot_vec = vec3_normalize(vec3_cross(n, bv));
-
-        vec3 t = vec3_sub(bv, vec3_scale(n, vec3_dot(bv, n)));
-        if (vec3_length(t) > EPS) {
-            t = vec3_normalize(t);
-
-            float jt = -vec3_dot(vr, t);
-            if (fabsf(jt) > EPS) {
-                float friction = contact->friction;
-                if (jt > imp * friction) {
-                    jt = imp * friction;
-                }
-                else if (jt < -imp * friction) {
-                    jt = -imp * friction;
-                }
-
-                bv = vec3_add(bv, vec3_scale(t, jt));
-            }
-        }
-
-        contact->v1 = bv;
-
-        if (contact->impulse_mag > 1 && contact->cull_dot < -0.15f) {
-            if (game.ball.time_since_impact_sound > 0.1f) {
-                golf_audio_start_sound("ball_impact", "data/audio/footstep_grass_004.ogg", 1, false, true);
-                game.ball.time_since_impact_sound = 0;
-            }
-        }
-    }
-    game.ball.time_since_impact_sound += dt;
-
-    float gravity = -9.8f;
-    bv = vec3_add(bv, V3(0, gravity * dt, 0));
-    bp = vec3_add(bp, vec3_scale(bv, dt));
-
-    for (int i = 0; i < num_contacts; i++) {
-        golf_ball_contact_t *contact = &contacts[i];
-        if (contact->is_ignored) {
-            continue;
-        }
-        if (contact->is_water) {
-            continue;
-        }
-
-        float pen = fmaxf(contact->penetration, 0);
-        vec3 correction = vec3_scale(contact->normal, pen * 0.5f);
-        bp = vec3_add(bp, correction);
-    }
-
-    game.ball.is_in_water = false;
-    for (int i = 0; i < num_contacts; i++) {
-        golf_ball_contact_t *contact = &contacts[i];
-        if (contact->is_ignored) {
-            continue;
-        }
-        if (!contact->is_water) {
-            continue;
-        }
-
-        vec3 water_dir = contact->water_dir;
-        vec3 water_vel = vec3_scale(water_dir, CFG_NUM(game_cfg, "physics_water_max_speed"));
-        bv = vec3_add(bv, vec3_scale(vec3_sub(water_vel, bv), CFG_NUM(game_cfg, "physics_water_speed") * dt));
-        game.ball.is_in_water = true;
-    }
-
-    if (game.ball.is_moving && num_contacts > 0) {
-        golf_collision_data_t collision;
-        collision.num_contacts = num_contacts;
-        for (int i = 0; i < num_contacts; i++) {
-            collision.contacts[i] = contacts[i];
-        }
-        collision.ball_pos = bp0;
-        collision.is_highlighted = false;
-        vec_push(&game.physics.collision_history, collision);
-    }
-
-    if (vec3_length(bv) < 0.1f) {
-        game.ball.time_going_slow += dt;
-    }
-    else {
-        game.ball.time_going_slow = 0.0f;
-    }
-
-    if (!game.ball.is_moving && vec3_length(bv) > 0.1f) {
-        game.ball.is_moving = true;
-    }
-    if (game.ball.is_moving) {
-        game.ball.pos = bp;
-        game.ball.vel = bv;
-        game.ball.rot_vel = game.ball.rot_vel - dt * game.ball.rot_vel * CFG_NUM(game_cfg, "physics_ball_rot_scale");
-        game.ball.orientation = quat_multiply(
-                quat_create_from_axis_angle(game.ball.rot_vec, game.ball.rot_vel * dt),
-                game.ball.orientation);
-        if (game.ball.time_going_slow > 0.5f) {
-            game.ball.is_moving = false;
-        }
-    }
-
-    {
-        // Check to see if the ball ended up in the hole
-        vec3 p = vec3_add(hole_pos, CFG_VEC3(game_cfg, "physics_in_hole_delta"));
-        if (vec3_distance(p, bp) < CFG_NUM(game_cfg, "physics_in_hole_radius")) {
-            game.ball.is_in_hole = true;
-        }
-
-        // Check to see if the ball ended up out of bounds
-        for (int i = 0; i < num_contacts; i++) {
-            golf_ball_contact_t *contact = &contacts[i];
-            if (contact->is_out_of_bounds) {
-                game.ball.time_out_of_bounds = game.t;
-                game.ball.is_out_of_bounds = true;
-            }
+// Sounds and ripples are driven by the frame rather than the physics ticks
+static void _golf_game_update_ball_effects(float dt) {
+    if (game.physics.sim.had_impact) {
+        game.physics.sim.had_impact = false;
+        if (game.ball_effects.time_since_impact_sound > 0.1f) {
+            golf_audio_start_sound("ball_impact", "data/audio/footstep_grass_004.ogg", 1, false, true);
+            game.ball_effects.time_since_impact_sound = 0;
         }
     }
+    game.ball_effects.time_since_impact_sound += dt;
 
     if (game.ball.is_in_water) {
-        game.ball.time_out_of_water = 0;
-        game.ball.time_since_water_ripple += dt;
-        if (game.ball.time_since_water_ripple > CFG_NUM(game_cfg, "water_ripple_frequency")) {
-            game.ball.time_since_water_ripple = 0;
+        game.ball_effects.time_out_of_water = 0;
+        game.ball_effects.time_since_water_ripple += dt;
+        if (game.ball_effects.time_since_water_ripple > game.params.water_ripple_frequency) {
+            game.ball_effects.time_since_water_ripple = 0;
             
             vec3 pos = game.ball.draw_pos;
             pos.y -= game.ball.radius;
@@ -691,15 +342,10 @@ static void _physics_tick(float dt) {
         }
     }
     else {
-        game.ball.time_out_of_water += dt;
-    }
-
-    if (game.ball.pos.y < CFG_NUM(game_cfg, "physics_kill_y")) {
-        game.ball.time_out_of_bounds = game.t;
-        game.ball.is_out_of_bounds = true;
+        game.ball_effects.time_out_of_water += dt;
     }
 
-    if (game.ball.time_out_of_water < 0.1f) {
+    if (game.ball_effects.time_out_of_water < 0.1f) {
         golf_audio_start_sound("ball_in_water", "data/audio/in_water.ogg", 0.1f, true, false);
     }
     else {
@@ -713,6 +359,7 @@ void golf_game_update(float dt) {
     }
 
     game.t += dt;
+    _golf_game_update_params();
 
     switch (game.state) {
         case GOLF_GAME_STATE_MAIN_MENU:
@@ -736,7 +383,7 @@ void golf_game_update(float dt) {
 
     {
         // Remove any water ripples that have finished
-        float time_length = CFG_NUM(game_cfg, "water_ripple_time_length"); 
+        float time_length = game.params.water_ripple_time_length; 
         for (int i = 0; i < MAX_NUM_WATER_RIPPLES; i++) {
             if (game.water_ripples[i].t0 == FLT_MAX) {
                 continue;
@@ -750,23 +397,26 @@ void golf_game_update(float dt) {
     }
 
     if (game.state > GOLF_GAME_STATE_MAIN_MENU) {
-        float physics_dt = 1.0f/120.0f;
-        game.physics.time_behind += dt;
-
-        vec3 bp_prev = game.ball.pos;
-        int num_ticks = 0;
-        while (game.physics.time_behind >= 0 && num_ticks < 5) {
-            bp_prev = game.ball.pos;
-            _physics_tick(physics_dt);
-            game.physics.time_behind -= physics_dt;
-            num_ticks++;
-        }
-        while (game.physics.time_behind >= 0) {
-            game.physics.time_behind -= physics_dt;
+        float sim_dt = dt;
+        if (game.replay.is_playing) {
+            bool hit_ball = false;
+            if (!golf_replay_player_next_frame(&game.replay.player, &game.physics.sim, &game.ball, &sim_dt, &hit_ball)) {
+                golf_log_note("Finished playing replay");
+                game.replay.is_playing = false;
+            }
+            if (hit_ball) {
+                game.state = GOLF_GAME_STATE_WATCHING_BALL;
+                game.stroke_count++;
+                game.cam.start_angle = game.cam.angle;
+                golf_audio_start_sound("hit_ball", "data/audio/impactPlank_medium_000.ogg", 1, false, true);
+            }
         }
 
-        float alpha = (float)(-game.physics.time_behind / physics_dt);
-        game.ball.draw_pos = vec3_add(vec3_scale(game.ball.pos, 1.0f - alpha), vec3_scale(bp_prev, alpha));
+        golf_sim_update(&game.physics.sim, &game.ball, sim_dt);
+        if (game.replay.is_recording) {
+            golf_replay_add_frame(&game.replay.recording, sim_dt);
+        }
+        _golf_game_update_ball_effects(dt);
     }
 
     // Move around the camera
@@ -777,8 +427,8 @@ void golf_game_update(float dt) {
             vec3 cam_dir0 = game.begin_camera_animation.cam_dir0;
             vec3 cam_dir1 = game.begin_camera_animation.cam_dir1;
             float t = game.begin_camera_animation.t;
-            float length0 = CFG_NUM(game_cfg, "begin_camera_animation_length0");
-            float length1 = CFG_NUM(game_cfg, "begin_camera_animation_length1");
+            float length0 = game.params.begin_camera_animation_length0;
+            float length1 = game.params.begin_camera_animation_length1;
 
             if (t >= length0) {
                 t = t - length0;
@@ -804,7 +454,7 @@ void golf_game_update(float dt) {
             vec3 cam_dir1 = game.celebration.cam_dir1;
 
             float t = game.celebration.t;
-            float length = CFG_NUM(game_cfg, "celebration_length");
+            float length = game.params.celebration_length;
             float a = sinf(0.5f * MF_PI * t / length);
 
             graphics->cam_pos = vec3_add(cam_pos0, vec3_scale(vec3_sub(cam_pos1, cam_pos0), a));
@@ -824,7 +474,7 @@ void golf_game_update(float dt) {
                 float camera_zone_angle = _golf_game_get_camera_zone_angle(game.ball.draw_pos);
                 float delta_angle = camera_zone_angle - game.cam.angle;
                 delta_angle = atan2f(sinf(delta_angle), cosf(delta_angle));
-                game.cam.angle += delta_angle * CFG_NUM(game_cfg, "cam_auto_rotate_speed");
+                game.cam.angle += delta_angle * game.params.cam_auto_rotate_speed;
             }
 
             vec3 cam_delta = vec3_rotate_y(V3(2.6f, 1.5f, 0), game.cam.angle);
@@ -843,6 +493,9 @@ void golf_game_update(float dt) {
 
 void golf_game_start_main_menu(void) {
     game.state = GOLF_GAME_STATE_MAIN_MENU;
+    game.replay.is_recording = false;
+    game.replay.is_playing = false;
+    game.replay.is_replay_attempt = false;
 
     vec3 hole_pos = V3(0, 0, 0);;
     vec3 begin_animation_pos = V3(0, 0, 0);
@@ -878,7 +531,7 @@ void golf_game_start_main_menu(void) {
 void golf_game_start_level(void) {
     game.state = GOLF_GAME_STATE_BEGIN_CAMERA_ANIMATION;
 
-    vec3 ball_start_pos = V3(0, 0, 0);
+    vec3 ball_start_pos = golf_sim_get_ball_start_pos(golf->level);
     vec3 hole_pos = V3(0, 0, 0);
     vec3 begin_animation_pos = V3(0, 0, 0);
 
@@ -891,77 +544,39 @@ void golf_game_start_level(void) {
             case GEO_ENTITY:
             case GROUP_ENTITY:
             case WATER_ENTITY:
+            case BALL_START_ENTITY:
                 break;
             case HOLE_ENTITY:
                 hole_pos = entity->hole.transform.position;
                 break;
-            case BALL_START_ENTITY:
-                ball_start_pos = entity->ball_start.transform.position;
-                ball_start_pos.y += game.ball.radius;
-                break;
             case BEGIN_ANIMATION_ENTITY:
                 begin_animation_pos = entity->begin_animation.transform.position;
                 break;
         }
     }
 
-    // Create the BVH for entities that are not moving
-    {
-        golf_bvh_t *bvh = &game.physics.static_bvh;
-        bvh->node_infos.length = 0;
-        for (int i = 0; i < golf->level->entities.length; i++) {
-            golf_entity_t *entity = &golf->level->entities.data[i];
-
-            switch (entity->type) {
-                case MODEL_ENTITY:
-                case WATER_ENTITY:
-                case GEO_ENTITY: {
-                    bool ignore_physics = entity->type == MODEL_ENTITY && entity->model.ignore_physics;
-                    if (!ignore_physics) {
-                        golf_movement_t *movement = golf_entity_get_movement(entity);
-                        if (!movement || movement->type == GOLF_MOVEMENT_NONE) {
-                            vec_push(&bvh->node_infos, golf_bvh_node_info(bvh, i, golf->level, entity, game.t));
-                        }
-                    }
-                    break;
-                }
-                case BEGIN_ANIMATION_ENTITY:
-                case CAMERA_ZONE_ENTITY:
-                case BALL_START_ENTITY:
-                case HOLE_ENTITY:
-                case GROUP_ENTITY:
-                    break;
-            }
-        }
-        golf_bvh_construct(bvh, bvh->node_infos);
-    }
-
     game.t = 0;
+    golf_sim_start_level(&game.physics.sim, golf->level);
 
     game.stroke_count = 0;
     game.ball_start_pos = ball_start_pos;
     game.hole_pos = hole_pos;
 
-    game.ball.pos = ball_start_pos;
-    game.ball.draw_pos = ball_start_pos;
-    game.ball.vel = V3(0, 0, 0);
-    game.ball.rot_vec = V3(0, 0, 0);
-    game.ball.orientation = QUAT(0, 0, 0, 1);
-    game.ball.radius = 0.12f;
-    game.ball.time_going_slow = 0;
-    game.ball.time_since_water_ripple = 0;
-    game.ball.rot_vel = 0;
-    game.ball.is_moving = false;
-    game.ball.is_out_of_bounds = false;
-    game.ball.is_in_hole = false;
-    game.ball.time_out_of_bounds = -1;
+    golf_sim_ball_init(&game.ball, ball_start_pos);
+    game.ball_effects.time_since_water_ripple = 0;
+
+    // Playing a replay restarts the level, it shouldn't overwrite the recording
+    game.replay.is_recording = !game.replay.is_playing;
+    game.replay.is_replay_attempt = game.replay.is_playing;
+    if (game.replay.is_recording) {
+        golf_replay_reset(&game.replay.recording, golf->level_loading_path, golf_sim_get_params_hash(&game.physics.sim));
+        golf_replay_add_ball(&game.replay.recording, &game.ball);
+    }
 
     game.cam.auto_rotate = true;
     game.cam.angle = _golf_game_get_camera_zone_angle(ball_start_pos);
     game.cam.angle_velocity = 0;
 
-    game.physics.time_behind = 0;
-
     game.aim_line.power = 0;
     game.aim_line.aim_delta = V2(0, 0);
     game.aim_line.offset = V2(0, 0);
@@ -989,46 +604,24 @@ void golf_game_stop_aiming(void) {
 }
 
 void golf_game_hit_ball(vec2 aim_delta) {
+    if (game.replay.is_playing) {
+        return;
+    }
+
     game.state = GOLF_GAME_STATE_WATCHING_BALL;
     game.stroke_count++;
 
     vec3 aim_direction = V3(aim_delta.x, 0, aim_delta.y);
     aim_direction = vec3_normalize(vec3_rotate_y(aim_direction, game.cam.angle - 0.5f * MF_PI));
 
-    float green_power = CFG_NUM(game_cfg, "aim_green_power");
-    float yellow_power = CFG_NUM(game_cfg, "aim_yellow_power");
-    float red_power = CFG_NUM(game_cfg, "aim_red_power");
-    float green_speed = CFG_NUM(game_cfg, "aim_green_speed");
-    float yellow_speed = CFG_NUM(game_cfg, "aim_yellow_speed");
-    float red_speed = CFG_NUM(game_cfg, "aim_red_speed");
-    float dark_red_speed = CFG_NUM(game_cfg, "aim_dark_red_speed");
-    float start_speed = 0;
-    float p = game.aim_line.power;
-    if (p < green_power) {
-        float a = p / green_power;
-        start_speed = green_speed + (yellow_speed - green_speed) * a;
-    }
-    else if (p < yellow_power) {
-        float a = (p - green_power) / (yellow_power - green_power);
-        start_speed = yellow_speed + (red_speed - yellow_speed) * a;
-    }
-    else if (p < red_power) {
-        float a = (p - yellow_power) / (red_power - yellow_power);
-        start_speed = red_speed + (dark_red_speed - red_speed) * a;
-    }
-    else {
-        start_speed = dark_red_speed;
-    }
-
     game.cam.auto_rotate = true;
 
-    game.ball.vel = vec3_scale(aim_direction, start_speed);
-    game.ball.is_moving = true;
-    game.ball.start_pos = game.ball.pos;
+    golf_sim_hit_ball(&game.physics.sim, &game.ball, aim_direction, game.aim_line.power);
+    if (game.replay.is_recording) {
+        golf_replay_add_hit(&game.replay.recording, aim_delta, aim_direction, game.aim_line.power);
+    }
     game.cam.start_angle = game.cam.angle;
 
-    game.physics.collision_history.length = 0;
-
     golf_audio_start_sound("hit_ball", "data/audio/impactPlank_medium_000.ogg", 1, false, true);
 }
 
@@ -1040,3 +633,36 @@ void golf_game_pause(void) {
 void golf_game_resume(void) {
     game.state = game.state_before_pause;
 }
+
+bool golf_game_save_replay(const char *path) {
+    if (game.replay.recording.level_path[0] == 0) {
+        golf_log_warning("No replay has been recorded yet");
+        return false;
+    }
+
+    bool saved = golf_replay_save(&game.replay.recording, &game.ball, path);
+    if (saved) {
+        golf_log_note("Saved replay %s with %d frames", path, game.replay.recording.frame_dts.length);
+    }
+    return saved;
+}
+
+bool golf_game_play_replay(const char *path) {
+    if (!golf_replay_load(&game.replay.playback, path)) {
+        return false;
+    }
+
+    golf_replay_t *replay = &game.replay.playback;
+    if (golf->state != GOLF_STATE_IN_GAME || strcmp(replay->level_path, golf->level_loading_path) != 0) {
+        golf_log_warning("Replay %s is for level %s, load that level to play it", path, replay->level_path);
+        return false;
+    }
+    if (replay->params_hash != golf_sim_get_params_hash(&game.physics.sim)) {
+        golf_log_warning("Replay %s was recorded with a different physics config", path);
+    }
+
+    game.replay.is_playing = true;
+    golf_game_start_level();
+    golf_replay_player_init(&game.replay.player, replay);
+    return true;
+}
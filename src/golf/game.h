@@ -3,19 +3,12 @@
 
 #include "common/bvh.h"
 #include "common/level.h"
+#include "golf/replay.h"
+#include "golf/sim.h"
 
-#define MAX_NUM_CONTACTS 8
 #define MAX_AIM_LINE_POINTS 5
 #define MAX_NUM_WATER_RIPPLES 64
 
-typedef struct golf_collision_data {
-    bool is_highlighted;
-    vec3 ball_pos;
-    int num_contacts;
-    golf_ball_contact_t contacts[MAX_NUM_CONTACTS]; 
-} golf_collision_data_t;
-typedef vec_t(golf_collision_data_t) vec_golf_collision_data_t;
-
 typedef enum golf_game_state {
     GOLF_GAME_STATE_MAIN_MENU,
     GOLF_GAME_STATE_BEGIN_CAMERA_ANIMATION,
@@ -27,21 +20,29 @@ typedef enum golf_game_state {
     GOLF_GAME_STATE_PAUSED,
 } golf_game_state_t;
 
+// Config values read every frame, bound from game.cfg when it loads or reloads
+typedef struct golf_game_params {
+    int cfg_version;
+    float aim_line_min_length, aim_line_max_length;
+    float begin_camera_animation_length0, begin_camera_animation_length1;
+    float cam_auto_rotate_speed, celebration_length;
+    float water_ripple_frequency, water_ripple_time_length;
+} golf_game_params_t;
+
 typedef struct golf_game {
     golf_game_state_t state, state_before_pause;
+    golf_game_params_t params;
 
     bool debug_inputs;
 
     int stroke_count;
     vec3 ball_start_pos, hole_pos;
 
+    golf_sim_ball_t ball;
+
     struct {
-        vec3 start_pos, pos, vel, draw_pos, rot_vec;
-        quat orientation;
-        float time_since_water_ripple, time_going_slow, time_out_of_bounds, radius, rot_vel,
-              time_out_of_water, time_since_impact_sound;
-        bool is_moving, is_in_hole, is_in_water, is_out_of_bounds;
-    } ball;
+        float time_since_water_ripple, time_out_of_water, time_since_impact_sound;
+    } ball_effects;
 
     struct {
         bool auto_rotate;
@@ -49,12 +50,20 @@ typedef struct golf_game {
     } cam;
 
     struct {
-        golf_bvh_t static_bvh, dynamic_bvh;
-        float time_behind;
+        golf_sim_t sim;
         bool debug_draw_collisions;
-        vec_golf_collision_data_t collision_history; 
     } physics;
 
+    // Every attempt at a level is recorded so it can be saved from the debug
+    // console, playing a replay feeds its frames to the sim instead of the real dt.
+    // is_replay_attempt stays set after the replay finishes until the level restarts,
+    // nothing that happens in that attempt counts towards the player's progress.
+    struct {
+        bool is_recording, is_playing, is_replay_attempt;
+        golf_replay_t recording, playback;
+        golf_replay_player_t player;
+    } replay;
+
     struct {
         float power;
         vec2 aim_delta;
@@ -91,5 +100,7 @@ void golf_game_start_aiming(void);
 void golf_game_hit_ball(vec2 aim_delta);
 void golf_game_pause(void);
 void golf_game_resume(void);
+bool golf_game_save_replay(const char *path);
+bool golf_game_play_replay(const char *path);
 
 #endif
@@ -0,0 +1,322 @@
+#include "golf/replay.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/alloc.h"
+#include "common/log.h"
+
+// File layout, all values little endian:
+//   "GRPL", u32 version, u32 params hash, u32 level path length, level path,
+//   u32 num frames, f32 dt per frame, u32 num events, events, end ball
+// Floats are stored as their raw bits so playback sees exactly what was recorded.
+#define REPLAY_MAGIC "GRPL"
+#define REPLAY_VERSION 1
+
+typedef struct _replay_reader {
+    const char *data;
+    int data_len, pos;
+    bool is_valid;
+} _replay_reader_t;
+
+static void _write_bytes(vec_char_t *buf, const void *bytes, int len) {
+    vec_pusharr(buf, (const char*)bytes, len);
+}
+
+static void _write_u32(vec_char_t *buf, uint32_t val) {
+    char bytes[4];
+    bytes[0] = (char)(val & 0xFF);
+    bytes[1] = (char)((val >> 8) & 0xFF);
+    bytes[2] = (char)((val >> 16) & 0xFF);
+    bytes[3] = (char)((val >> 24) & 0xFF);
+    _write_bytes(buf, bytes, 4);
+}
+
+static void _write_f32(vec_char_t *buf, float val) {
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    _write_u32(buf, bits);
+}
+
+static void _write_vec3(vec_char_t *buf, vec3 v) {
+    _write_f32(buf, v.x);
+    _write_f32(buf, v.y);
+    _write_f32(buf, v.z);
+}
+
+static void _write_ball(vec_char_t *buf, golf_sim_ball_t *ball) {
+    _write_vec3(buf, ball->start_pos);
+    _write_vec3(buf, ball->pos);
+    _write_vec3(buf, ball->vel);
+    _write_vec3(buf, ball->draw_pos);
+    _write_vec3(buf, ball->rot_vec);
+    _write_f32(buf, ball->orientation.x);
+    _write_f32(buf, ball->orientation.y);
+    _write_f32(buf, ball->orientation.z);
+    _write_f32(buf, ball->orientation.w);
+    _write_f32(buf, ball->radius);
+    _write_f32(buf, ball->rot_vel);
+    _write_f32(buf, ball->time_going_slow);
+    _write_f32(buf, ball->time_out_of_bounds);
+    uint32_t flags = (ball->is_moving ? 1 : 0) | (ball->is_in_hole ? 2 : 0) |
+        (ball->is_in_water ? 4 : 0) | (ball->is_out_of_bounds ? 8 : 0);
+    _write_u32(buf, flags);
+}
+
+static uint32_t _read_u32(_replay_reader_t *reader) {
+    if (!reader->is_valid || reader->pos + 4 > reader->data_len) {
+        reader->is_valid = false;
+        return 0;
+    }
+
+    const unsigned char *bytes = (const unsigned char*)reader->data + reader->pos;
+    reader->pos += 4;
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static float _read_f32(_replay_reader_t *reader) {
+    uint32_t bits = _read_u32(reader);
+    float val;
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+static vec3 _read_vec3(_replay_reader_t *reader) {
+    vec3 v;
+    v.x = _read_f32(reader);
+    v.y = _read_f32(reader);
+    v.z = _read_f32(reader);
+    return v;
+}
+
+static void _read_ball(_replay_reader_t *reader, golf_sim_ball_t *ball) {
+    ball->start_pos = _read_vec3(reader);
+    ball->pos = _read_vec3(reader);
+    ball->vel = _read_vec3(reader);
+    ball->draw_pos = _read_vec3(reader);
+    ball->rot_vec = _read_vec3(reader);
+    ball->orientation.x = _read_f32(reader);
+    ball->orientation.y = _read_f32(reader);
+    ball->orientation.z = _read_f32(reader);
+    ball->orientation.w = _read_f32(reader);
+    ball->radius = _read_f32(reader);
+    ball->rot_vel = _read_f32(reader);
+    ball->time_going_slow = _read_f32(reader);
+    ball->time_out_of_bounds = _read_f32(reader);
+    uint32_t flags = _read_u32(reader);
+    ball->is_moving = flags & 1;
+    ball->is_in_hole = flags & 2;
+    ball->is_in_water = flags & 4;
+    ball->is_out_of_bounds = flags & 8;
+}
+
+void golf_replay_init(golf_replay_t *replay) {
+    memset(replay, 0, sizeof(golf_replay_t));
+    vec_init(&replay->frame_dts, "replay");
+    vec_init(&replay->events, "replay");
+}
+
+void golf_replay_deinit(golf_replay_t *replay) {
+    vec_deinit(&replay->frame_dts);
+    vec_deinit(&replay->events);
+}
+
+void golf_replay_reset(golf_replay_t *replay, const char *level_path, uint32_t params_hash) {
+    snprintf(replay->level_path, GOLF_FILE_MAX_PATH, "%s", level_path);
+    replay->params_hash = params_hash;
+    replay->frame_dts.length = 0;
+    replay->events.length = 0;
+}
+
+void golf_replay_add_frame(golf_replay_t *replay, float dt) {
+    vec_push(&replay->frame_dts, dt);
+}
+
+void golf_replay_add_ball(golf_replay_t *replay, golf_sim_ball_t *ball) {
+    golf_replay_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.frame = replay->frame_dts.length;
+    event.type = GOLF_REPLAY_EVENT_BALL;
+    event.ball = *ball;
+    vec_push(&replay->events, event);
+}
+
+void golf_replay_add_hit(golf_replay_t *replay, vec2 aim_delta, vec3 direction, float power) {
+    golf_replay_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.frame = replay->frame_dts.length;
+    event.type = GOLF_REPLAY_EVENT_HIT;
+    event.hit.aim_delta = aim_delta;
+    event.hit.direction = direction;
+    event.hit.power = power;
+    vec_push(&replay->events, event);
+}
+
+bool golf_replay_save(golf_replay_t *replay, golf_sim_ball_t *end_ball, const char *path) {
+    vec_char_t buf;
+    vec_init(&buf, "replay");
+
+    _write_bytes(&buf, REPLAY_MAGIC, 4);
+    _write_u32(&buf, REPLAY_VERSION);
+    _write_u32(&buf, replay->params_hash);
+    uint32_t level_path_len = (uint32_t)strlen(replay->level_path);
+    _write_u32(&buf, level_path_len);
+    _write_bytes(&buf, replay->level_path, (int)level_path_len);
+
+    _write_u32(&buf, (uint32_t)replay->frame_dts.length);
+    for (int i = 0; i < replay->frame_dts.length; i++) {
+        _write_f32(&buf, replay->frame_dts.data[i]);
+    }
+
+    _write_u32(&buf, (uint32_t)replay->events.length);
+    for (int i = 0; i < replay->events.length; i++) {
+        golf_replay_event_t *event = &replay->events.data[i];
+        _write_u32(&buf, (uint32_t)event->frame);
+        _write_u32(&buf, (uint32_t)event->type);
+        switch (event->type) {
+            case GOLF_REPLAY_EVENT_BALL:
+                _write_ball(&buf, &event->ball);
+                break;
+            case GOLF_REPLAY_EVENT_HIT:
+                _write_f32(&buf, event->hit.aim_delta.x);
+                _write_f32(&buf, event->hit.aim_delta.y);
+                _write_vec3(&buf, event->hit.direction);
+                _write_f32(&buf, event->hit.power);
+                break;
+        }
+    }
+
+    replay->end_ball = *end_ball;
+    _write_ball(&buf, &replay->end_ball);
+
+    bool saved = false;
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        saved = fwrite(buf.data, buf.length, 1, f) == 1;
+        fclose(f);
+    }
+    if (!saved) {
+        golf_log_warning("Unable to save replay %s", path);
+    }
+
+    vec_deinit(&buf);
+    return saved;
+}
+
+bool golf_replay_load(golf_replay_t *replay, const char *path) {
+    char *data;
+    int data_len;
+    if (!golf_file_load_data(path, &data, &data_len)) {
+        golf_log_warning("Unable to open replay %s", path);
+        return false;
+    }
+
+    _replay_reader_t reader;
+    reader.data = data;
+    reader.data_len = data_len;
+    reader.pos = 0;
+    reader.is_valid = data_len >= 4 && memcmp(data, REPLAY_MAGIC, 4) == 0;
+    reader.pos = 4;
+
+    uint32_t version = _read_u32(&reader);
+    if (reader.is_valid && version != REPLAY_VERSION) {
+        golf_log_warning("Replay %s has version %u, expected %u", path, version, REPLAY_VERSION);
+        reader.is_valid = false;
+    }
+
+    replay->params_hash = _read_u32(&reader);
+    uint32_t level_path_len = _read_u32(&reader);
+    if (level_path_len >= GOLF_FILE_MAX_PATH || reader.pos + (int)level_path_len > data_len) {
+        reader.is_valid = false;
+    }
+    if (reader.is_valid) {
+        memcpy(replay->level_path, data + reader.pos, level_path_len);
+        replay->level_path[level_path_len] = 0;
+        reader.pos += level_path_len;
+    }
+
+    replay->frame_dts.length = 0;
+    uint32_t num_frames = _read_u32(&reader);
+    for (uint32_t i = 0; i < num_frames && reader.is_valid; i++) {
+        vec_push(&replay->frame_dts, _read_f32(&reader));
+    }
+
+    replay->events.length = 0;
+    uint32_t num_events = _read_u32(&reader);
+    for (uint32_t i = 0; i < num_events && reader.is_valid; i++) {
+        golf_replay_event_t event;
+        memset(&event, 0, sizeof(event));
+        event.frame = (int)_read_u32(&reader);
+        event.type = (golf_replay_event_type_t)_read_u32(&reader);
+        switch (event.type) {
+            case GOLF_REPLAY_EVENT_BALL:
+                _read_ball(&reader, &event.ball);
+                break;
+            case GOLF_REPLAY_EVENT_HIT:
+                event.hit.aim_delta.x = _read_f32(&reader);
+                event.hit.aim_delta.y = _read_f32(&reader);
+                event.hit.direction = _read_vec3(&reader);
+                event.hit.power = _read_f32(&reader);
+                break;
+            default:
+                reader.is_valid = false;
+                break;
+        }
+        vec_push(&replay->events, event);
+    }
+
+    _read_ball(&reader, &replay->end_ball);
+
+    golf_free(data);
+    if (!reader.is_valid) {
+        golf_log_warning("Replay %s is invalid", path);
+    }
+    return reader.is_valid;
+}
+
+void golf_replay_player_init(golf_replay_player_t *player, golf_replay_t *replay) {
+    player->replay = replay;
+    player->frame = 0;
+    player->event = 0;
+}
+
+bool golf_replay_player_is_done(golf_replay_player_t *player) {
+    return player->frame >= player->replay->frame_dts.length &&
+        player->event >= player->replay->events.length;
+}
+
+bool golf_replay_player_next_frame(golf_replay_player_t *player, golf_sim_t *sim, golf_sim_ball_t *ball, float *dt, bool *hit_ball) {
+    golf_replay_t *replay = player->replay;
+    if (hit_ball) {
+        *hit_ball = false;
+    }
+
+    while (player->event < replay->events.length && replay->events.data[player->event].frame <= player->frame) {
+        golf_replay_event_t *event = &replay->events.data[player->event++];
+        switch (event->type) {
+            case GOLF_REPLAY_EVENT_BALL:
+                *ball = event->ball;
+                break;
+            case GOLF_REPLAY_EVENT_HIT:
+                golf_sim_hit_ball(sim, ball, event->hit.direction, event->hit.power);
+                if (hit_ball) {
+                    *hit_ball = true;
+                }
+                break;
+        }
+    }
+
+    if (player->frame >= replay->frame_dts.length) {
+        return false;
+    }
+
+    *dt = replay->frame_dts.data[player->frame++];
+    return true;
+}
+
+void golf_replay_player_fast_forward(golf_replay_player_t *player, golf_sim_t *sim, golf_sim_ball_t *ball) {
+    float dt;
+    while (golf_replay_player_next_frame(player, sim, ball, &dt, NULL)) {
+        golf_sim_update(sim, ball, dt);
+    }
+}
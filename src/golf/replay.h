@@ -0,0 +1,66 @@
+#ifndef _GOLF_REPLAY_H
+#define _GOLF_REPLAY_H
+
+#include "common/file.h"
+#include "golf/sim.h"
+
+// A replay is everything that feeds the physics during one attempt at a level:
+// the dt of every sim update and whatever the game did to the ball between
+// updates. Playing it back through golf_sim_update gives the same trajectory
+// bit for bit, as long as the level, config and sim code haven't changed.
+
+typedef enum golf_replay_event_type {
+    // The game placed or stopped the ball itself (level start, out of bounds, in hole)
+    GOLF_REPLAY_EVENT_BALL,
+    GOLF_REPLAY_EVENT_HIT,
+} golf_replay_event_type_t;
+
+typedef struct golf_replay_event {
+    // Applied before this sim update
+    int frame;
+    golf_replay_event_type_t type;
+    union {
+        golf_sim_ball_t ball;
+        struct {
+            vec2 aim_delta;
+            vec3 direction;
+            float power;
+        } hit;
+    };
+} golf_replay_event_t;
+typedef vec_t(golf_replay_event_t) vec_golf_replay_event_t;
+
+typedef struct golf_replay {
+    char level_path[GOLF_FILE_MAX_PATH];
+    uint32_t params_hash;
+    vec_float_t frame_dts;
+    vec_golf_replay_event_t events;
+
+    // State of the ball when the replay was saved, used to check playback
+    golf_sim_ball_t end_ball;
+} golf_replay_t;
+
+typedef struct golf_replay_player {
+    golf_replay_t *replay;
+    int frame, event;
+} golf_replay_player_t;
+
+void golf_replay_init(golf_replay_t *replay);
+void golf_replay_deinit(golf_replay_t *replay);
+void golf_replay_reset(golf_replay_t *replay, const char *level_path, uint32_t params_hash);
+void golf_replay_add_frame(golf_replay_t *replay, float dt);
+void golf_replay_add_ball(golf_replay_t *replay, golf_sim_ball_t *ball);
+void golf_replay_add_hit(golf_replay_t *replay, vec2 aim_delta, vec3 direction, float power);
+bool golf_replay_save(golf_replay_t *replay, golf_sim_ball_t *end_ball, const char *path);
+bool golf_replay_load(golf_replay_t *replay, const char *path);
+
+void golf_replay_player_init(golf_replay_player_t *player, golf_replay_t *replay);
+bool golf_replay_player_is_done(golf_replay_player_t *player);
+// Applies the events due before the next update and returns its dt, or applies
+// whatever is left and returns false when the replay is finished. hit_ball is
+// set when one of the events was a hit.
+bool golf_replay_player_next_frame(golf_replay_player_t *player, golf_sim_t *sim, golf_sim_ball_t *ball, float *dt, bool *hit_ball);
+// Plays the rest of the replay as fast as possible
+void golf_replay_player_fast_forward(golf_replay_player_t *player, golf_sim_t *sim, golf_sim_ball_t *ball);
+
+#endif
@@ -0,0 +1,653 @@
+#include "golf/sim.h"
+
+#include <assert.h>
+#include <float.h>
+
+static const golf_config_binding_t _sim_param_bindings[] = {
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, hole_force, "physics_hole_force"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, hole_force_distance, "physics_hole_force_distance"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, in_hole_radius, "physics_in_hole_radius"),
+    GOLF_CONFIG_BIND_VEC3(golf_sim_params_t, in_hole_delta, "physics_in_hole_delta"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, water_speed, "physics_water_speed"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, water_max_speed, "physics_water_max_speed"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, ball_rot_scale, "physics_ball_rot_scale"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, kill_y, "physics_kill_y"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, aim_green_power, "aim_green_power"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, aim_yellow_power, "aim_yellow_power"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, aim_red_power, "aim_red_power"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, aim_green_speed, "aim_green_speed"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, aim_yellow_speed, "aim_yellow_speed"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, aim_red_speed, "aim_red_speed"),
+    GOLF_CONFIG_BIND_NUM(golf_sim_params_t, aim_dark_red_speed, "aim_dark_red_speed"),
+};
+
+static void _golf_sim_update_params(golf_sim_t *sim) {
+    if (sim->params.cfg_version == sim->cfg->version) {
+        return;
+    }
+
+    golf_config_bind(sim->cfg, _sim_param_bindings, (int)(sizeof(_sim_param_bindings) / sizeof(_sim_param_bindings[0])), &sim->params);
+    sim->params.cfg_version = sim->cfg->version;
+}
+
+uint32_t golf_sim_get_params_hash(golf_sim_t *sim) {
+    _golf_sim_update_params(sim);
+
+    // FNV-1a over the bound values, the version only says when they were bound
+    golf_sim_params_t params = sim->params;
+    params.cfg_version = 0;
+    const unsigned char *bytes = (const unsigned char*)&params;
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < (int)sizeof(params); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int _ball_contact_cmp(const void *a, const void *b) {
+    const golf_ball_contact_t *bc0 = (golf_ball_contact_t*)a;
+    const golf_ball_contact_t *bc1 = (golf_ball_contact_t*)b;
+
+    if (bc1->distance > bc0->distance) {
+        return -1;
+    }
+    else if (bc1->distance < bc0->distance) {
+        return 1;
+    }
+    else if (bc1->vel_scale > bc0->vel_scale) {
+        return 1;
+    }
+    else if (bc1->vel_scale < bc0->vel_scale) {
+        return -1;
+    }
+    else if (bc1->restitution > bc0->restitution) {
+        return -1;
+    }
+    else if (bc1->restitution < bc0->restitution) {
+        return 1;
+    }
+    else {
+        return 0;
+    }
+}
+
+static void _golf_sim_tick(golf_sim_t *sim, golf_sim_ball_t *ball, float dt) {
+    float EPS = 0.001f;
+    float CCD_SKIN = 0.01f;
+
+    vec3 bp = ball->pos;
+    float br = ball->radius;
+    vec3 bv = ball->vel;
+    float bs = vec3_length(bv);
+    vec3 bp0 = bp;
+    vec3 bv0 = bv;
+
+    float dist_to_hole = FLT_MAX;
+    vec3 dir_to_hole = V3(0, 0, 0);
+    vec3 hole_pos = V3(0, 0, 0);
+    golf_entity_t *close_hole = NULL;
+    for (int i = 0; i < sim->level->entities.length; i++) {
+        golf_entity_t *entity = &sim->level->entities.data[i];
+        if (entity->type == HOLE_ENTITY) {
+            vec3 hp = entity->hole.transform.position;
+            vec3 hs = entity->hole.transform.scale;
+            float dist = vec3_distance(hp, bp);
+            if (dist <= hs.x) {
+                close_hole = entity;
+            }
+            if (dist < dist_to_hole) {
+                dist_to_hole = dist;
+                dir_to_hole = vec3_normalize(vec3_sub(hp, bp));
+                hole_pos = hp;
+            }
+        }
+    }
+
+    // Move the entities in the BVH to where they are now
+    golf_tlas_refit(&sim->bvh, sim->t);
+
+    int num_contacts = 0;
+    golf_ball_contact_t contacts[MAX_NUM_CONTACTS];
+    if (close_hole) {
+        golf_model_t *model = golf_entity_get_model(close_hole);
+        golf_transform_t transform = golf_entity_get_world_transform(sim->level, close_hole);
+        mat4 model_mat = golf_transform_get_model_mat(transform);
+        for (int i = 0; i < model->positions.length; i += 3) {
+            vec3 a = vec3_apply_mat4(model->positions.data[i + 0], 1, model_mat);
+            vec3 b = vec3_apply_mat4(model->positions.data[i + 1], 1, model_mat);
+            vec3 c = vec3_apply_mat4(model->positions.data[i + 2], 1, model_mat);
+            triangle_contact_type_t type;
+            vec3 cp = closest_point_point_triangle(bp, a, b, c, &type);
+            float dist = vec3_distance(bp, cp);
+            if (dist < br) {
+                float restitution, friction, vel_scale;
+                if (type == TRIANGLE_CONTACT_AB || type == TRIANGLE_CONTACT_AC || type == TRIANGLE_CONTACT_BC) {
+                    restitution = 0.4f;
+                    if (bs > 2) {
+                        friction = 1;
+                        vel_scale = 0.95f;
+                    }
+                    else {
+                        friction = 0;
+                        vel_scale = 1;
+                    }
+                }
+                else {
+                    restitution = 0.5f;
+                    friction = 0.5f;
+                    vel_scale = 1;
+                }
+                if (num_contacts < MAX_NUM_CONTACTS) {
+                    vec3 vel = V3(0, 0, 0);
+                    golf_ball_contact_t contact = golf_ball_contact(a, b, c, vel, bp, br, cp, dist, restitution, friction, vel_scale, type, false, V3(0, 0, 0), false);
+                    contacts[num_contacts] = contact;
+                    num_contacts = num_contacts + 1;
+                }
+            }
+        }
+    }
+    else {
+        golf_tlas_ball_test(&sim->bvh, bp, br, bv, contacts, &num_contacts, MAX_NUM_CONTACTS);
+    }
+    qsort(contacts, num_contacts, sizeof(golf_ball_contact_t), _ball_contact_cmp);
+
+    // Apply a force to pull the ball towards the hole
+    if (dist_to_hole < sim->params.hole_force_distance && num_contacts > 0) {
+        float hole_force = sim->params.hole_force;
+        bv = vec3_add(bv, vec3_scale(dir_to_hole, hole_force));
+    }
+
+    // Filter out the contacts
+    {
+        int num_processed_vertices = 0;
+        vec3 processed_vertices[9 * MAX_NUM_CONTACTS];
+
+        // All face contacts are used
+        for (int i = 0; i < num_contacts; i++) {
+            golf_ball_contact_t *contact = &contacts[i];
+            if (contact->is_ignored || contact->type != TRIANGLE_CONTACT_FACE) {
+                continue;
+            }
+
+            processed_vertices[num_processed_vertices++] = contact->triangle_a;
+            processed_vertices[num_processed_vertices++] = contact->triangle_b;
+            processed_vertices[num_processed_vertices++] = contact->triangle_c;
+        }
+
+        // Remove unecessary edge contacts
+        for (int i = 0; i < num_contacts; i++) {
+            golf_ball_contact_t *contact = &contacts[i];
+            if (contact->is_ignored || 
+                    (contact->type != TRIANGLE_CONTACT_AB && 
+                     contact->type != TRIANGLE_CONTACT_AC &&
+                     contact->type != TRIANGLE_CONTACT_BC)) {
+                continue;
+            }
+
+            vec3 e0 = V3(0, 0, 0);
+            vec3 e1 = V3(0, 0, 0);
+            if (contact->type == TRIANGLE_CONTACT_AB) {
+                e0 = contact->triangle_a;
+                e1 = contact->triangle_b;
+            }
+            else if (contact->type == TRIANGLE_CONTACT_AC) {
+                e0 = contact->triangle_a;
+                e1 = contact->triangle_c;
+            }
+            else if (contact->type == TRIANGLE_CONTACT_BC) {
+                e0 = contact->triangle_b;
+                e1 = contact->triangle_c;
+            }
+
+            for (int j = 0; j < num_processed_vertices; j += 3) {
+                vec3 a = processed_vertices[j + 0];
+                vec3 b = processed_vertices[j + 1];
+                vec3 c = processed_vertices[j + 2];
+                if (vec3_line_segments_on_same_line(a, b, e0, e1, EPS) ||
+                        vec3_line_segments_on_same_line(a, c, e0, e1, EPS) ||
+                        vec3_line_segments_on_same_line(b, c, e0, e1, EPS)) {
+                    contact->is_ignored = true;
+                    break;
+                }
+            }
+
+            processed_vertices[num_processed_vertices++] = contact->triangle_a;
+            processed_vertices[num_processed_vertices++] = contact->triangle_b;
+            processed_vertices[num_processed_vertices++] = contact->triangle_c;
+        }
+
+        // Remove uncessary point contacts
+        for (int i = 0; i < num_contacts; i++) {
+            golf_ball_contact_t *contact = &contacts[i];
+            if (contact->is_ignored ||
+                    (contact->type != TRIANGLE_CONTACT_A && 
+                     contact->type != TRIANGLE_CONTACT_B &&
+                     contact->type != TRIANGLE_CONTACT_C)) {
+                continue;
+            }
+
+            vec3 p = V3(0, 0, 0);
+            if (contact->type == TRIANGLE_CONTACT_A) {
+                p = contact->triangle_a;
+            }
+            else if (contact->type == TRIANGLE_CONTACT_B) {
+                p = contact->triangle_b;
+            }
+            else if (contact->type == TRIANGLE_CONTACT_C) {
+                p = contact->triangle_c;
+            }
+
+            for (int j = 0; j < num_processed_vertices; j++) {
+                vec3 a = processed_vertices[j + 0];
+                vec3 b = processed_vertices[j + 1];
+                vec3 c = processed_vertices[j + 2];
+                if (vec3_point_on_line_segment(p, a, b, EPS) ||
+                        vec3_point_on_line_segment(p, a, c, EPS) ||
+                        vec3_point_on_line_segment(p, b, c, EPS)) {
+                    contact->is_ignored = true;
+                    break;
+                }
+            }
+
+            processed_vertices[num_processed_vertices++] = contact->triangle_a;
+            processed_vertices[num_processed_vertices++] = contact->triangle_b;
+            processed_vertices[num_processed_vertices++] = contact->triangle_c;
+        }
+    }
+
+    for (int i = 0; i < num_contacts; i++) {
+        golf_ball_contact_t *contact = &contacts[i];
+        if (contact->is_ignored) {
+            continue;
+        }
+        if (contact->is_water) {
+            continue;
+        }
+
+        vec3 n = contact->normal;
+        vec3 vr = vec3_sub(bv, contact->velocity);
+        contact->cull_dot = vec3_dot(n, vec3_normalize(vr));
+        if (contact->cull_dot > EPS) {
+            contact->is_ignored = true;
+            continue;
+        }
+
+        float e = contact->restitution;
+        float v_scale = contact->vel_scale;
+        float imp = -(1 + e) * vec3_dot(vr, n);
+
+        contact->impulse_mag = imp; 
+        contact->impulse = vec3_scale(n, imp);
+        contact->v0 = bv0;
+
+        bv = vec3_add(bv, contact->impulse);
+        bv = vec3_scale(bv, v_scale);
+
+        ball->rot_vel = vec3_length(bv) / (MF_PI * ball->radius);
+        ball->rot_vec = vec3_normalize(vec3_cross(n, bv));
+
+        vec3 t = vec3_sub(bv, vec3_scale(n, vec3_dot(bv, n)));
+        if (vec3_length(t) > EPS) {
+            t = vec3_normalize(t);
+
+            float jt = -vec3_dot(vr, t);
+            if (fabsf(jt) > EPS) {
+                float friction = contact->friction;
+                if (jt > imp * friction) {
+                    jt = imp * friction;
+                }
+                else if (jt < -imp * friction) {
+                    jt = -imp * friction;
+                }
+
+                bv = vec3_add(bv, vec3_scale(t, jt));
+            }
+        }
+
+        contact->v1 = bv;
+
+        if (contact->impulse_mag > 1 && contact->cull_dot < -0.15f) {
+            sim->had_impact = true;
+        }
+    }
+
+    // Moving with the average of the velocities at the end of each base step lands
+    // the ball exactly where the same number of base ticks would in the air
+    float gravity = -9.8f;
+    vec3 delta = vec3_scale(vec3_add(bv, V3(0, gravity * (dt + GOLF_SIM_BASE_DT) * 0.5f, 0)), dt);
+    bv = vec3_add(bv, V3(0, gravity * dt, 0));
+
+    // Sweep the ball along its path so fast balls can't pass through thin geometry.
+    // It stops slightly inside the first face it hits, which becomes a contact next tick.
+    float toi = 1.0f;
+    if (!close_hole && vec3_length(delta) > CCD_SKIN) {
+        golf_tlas_ball_sweep(&sim->bvh, bp, br, delta, CCD_SKIN, &toi);
+    }
+    bp = vec3_add(bp, vec3_scale(delta, toi));
+
+    for (int i = 0; i < num_contacts; i++) {
+        golf_ball_contact_t *contact = &contacts[i];
+        if (contact->is_ignored) {
+            continue;
+        }
+        if (contact->is_water) {
+            continue;
+        }
+
+        float pen = fmaxf(contact->penetration, 0);
+        vec3 correction = vec3_scale(contact->normal, pen * 0.5f);
+        bp = vec3_add(bp, correction);
+    }
+
+    ball->is_in_water = false;
+    for (int i = 0; i < num_contacts; i++) {
+        golf_ball_contact_t *contact = &contacts[i];
+        if (contact->is_ignored) {
+            continue;
+        }
+        if (!contact->is_water) {
+            continue;
+        }
+
+        vec3 water_dir = contact->water_dir;
+        vec3 water_vel = vec3_scale(water_dir, sim->params.water_max_speed);
+        bv = vec3_add(bv, vec3_scale(vec3_sub(water_vel, bv), sim->params.water_speed * dt));
+        ball->is_in_water = true;
+    }
+
+    sim->had_contacts = num_contacts > 0;
+    if (sim->record_collisions && ball->is_moving && num_contacts > 0) {
+        golf_collision_data_t collision;
+        collision.num_contacts = num_contacts;
+        for (int i = 0; i < num_contacts; i++) {
+            collision.contacts[i] = contacts[i];
+        }
+        collision.ball_pos = bp0;
+        collision.is_highlighted = false;
+        vec_push(&sim->collision_history, collision);
+    }
+
+    if (vec3_length(bv) < 0.1f) {
+        ball->time_going_slow += dt;
+    }
+    else {
+        ball->time_going_slow = 0.0f;
+    }
+
+    if (!ball->is_moving && vec3_length(bv) > 0.1f) {
+        ball->is_moving = true;
+    }
+    if (ball->is_moving) {
+        ball->pos = bp;
+        ball->vel = bv;
+        ball->rot_vel = ball->rot_vel - dt * ball->rot_vel * sim->params.ball_rot_scale;
+        ball->orientation = quat_multiply(
+                quat_create_from_axis_angle(ball->rot_vec, ball->rot_vel * dt),
+                ball->orientation);
+        if (ball->time_going_slow > 0.5f) {
+            ball->is_moving = false;
+        }
+    }
+
+    {
+        // Check to see if the ball ended up in the hole
+        vec3 p = vec3_add(hole_pos, sim->params.in_hole_delta);
+        if (vec3_distance(p, bp) < sim->params.in_hole_radius) {
+            ball->is_in_hole = true;
+        }
+
+        // Check to see if the ball ended up out of bounds
+        for (int i = 0; i < num_contacts; i++) {
+            golf_ball_contact_t *contact = &contacts[i];
+            if (contact->is_out_of_bounds) {
+                ball->time_out_of_bounds = sim->t;
+                ball->is_out_of_bounds = true;
+            }
+        }
+    }
+
+    if (ball->pos.y < sim->params.kill_y) {
+        ball->time_out_of_bounds = sim->t;
+        ball->is_out_of_bounds = true;
+    }
+}
+
+// Picks how many base steps the next tick covers. This only depends on the state
+// of the ball and the level, so the ticks are the same however the frames fall.
+static int _golf_sim_num_base_steps(golf_sim_t *sim, golf_sim_ball_t *ball) {
+    if (!ball->is_moving || sim->had_contacts) {
+        return 1;
+    }
+
+    vec3 bp = ball->pos;
+    vec3 bv = ball->vel;
+    float bs = vec3_length(bv);
+    for (int n = GOLF_SIM_MAX_BASE_STEPS; n > 1; n /= 2) {
+        // Everything the ball could reach during the tick, plus a base step of margin
+        float dt = (n + 1) * GOLF_SIM_BASE_DT;
+        float reach = ball->radius + bs * dt + 0.5f * 9.8f * dt * dt;
+
+        bool is_clear = true;
+        for (int i = 0; i < sim->level->entities.length; i++) {
+            golf_entity_t *entity = &sim->level->entities.data[i];
+            if (entity->type == HOLE_ENTITY) {
+                vec3 hp = entity->hole.transform.position;
+                vec3 hs = entity->hole.transform.scale;
+                if (vec3_distance(hp, bp) <= hs.x + reach) {
+                    is_clear = false;
+                    break;
+                }
+            }
+        }
+
+        // The ball test only sees moving entities where they are now, they could
+        // travel into the ball during the tick
+        if (is_clear && golf_tlas_moving_near(&sim->bvh, bp, reach, sim->t, sim->t + dt, n + 1)) {
+            is_clear = false;
+        }
+
+        int num_contacts = 0;
+        golf_ball_contact_t contacts[MAX_NUM_CONTACTS];
+        if (is_clear && !golf_tlas_ball_test(&sim->bvh, bp, reach, bv, contacts, &num_contacts, MAX_NUM_CONTACTS)) {
+            return n;
+        }
+    }
+    return 1;
+}
+
+void golf_sim_init(golf_sim_t *sim, golf_config_t *cfg) {
+    memset(sim, 0, sizeof(golf_sim_t));
+    sim->cfg = cfg;
+    sim->tick_dt = GOLF_SIM_BASE_DT;
+    _golf_sim_update_params(sim);
+    golf_tlas_init(&sim->bvh);
+    vec_init(&sim->collision_history, "physics");
+}
+
+void golf_sim_deinit(golf_sim_t *sim) {
+    golf_tlas_deinit(&sim->bvh);
+    vec_deinit(&sim->collision_history);
+}
+
+void golf_sim_start_level(golf_sim_t *sim, golf_level_t *level) {
+    sim->level = level;
+    sim->t = 0;
+    sim->time_behind = 0;
+    sim->tick_dt = GOLF_SIM_BASE_DT;
+    sim->had_contacts = false;
+    sim->had_impact = false;
+    sim->collision_history.length = 0;
+
+    // Create the BVH, entities that move only get refit after this
+    golf_tlas_t *bvh = &sim->bvh;
+    golf_tlas_clear(bvh);
+    for (int i = 0; i < level->entities.length; i++) {
+        golf_entity_t *entity = &level->entities.data[i];
+
+        switch (entity->type) {
+            case MODEL_ENTITY:
+            case WATER_ENTITY:
+            case GEO_ENTITY: {
+                golf_movement_t *movement = golf_entity_get_movement(entity);
+                bool is_moving = movement && movement->type != GOLF_MOVEMENT_NONE;
+                bool ignore_physics = entity->type == MODEL_ENTITY && entity->model.ignore_physics;
+                if (is_moving || !ignore_physics) {
+                    golf_tlas_add_entity(bvh, i, level, entity);
+                }
+                break;
+            }
+            case BEGIN_ANIMATION_ENTITY:
+            case CAMERA_ZONE_ENTITY:
+            case BALL_START_ENTITY:
+            case HOLE_ENTITY:
+            case GROUP_ENTITY:
+                break;
+        }
+    }
+    golf_tlas_construct(bvh, sim->t);
+}
+
+void golf_sim_reset(golf_sim_t *sim) {
+    sim->t = 0;
+    sim->time_behind = 0;
+    sim->tick_dt = GOLF_SIM_BASE_DT;
+    sim->had_contacts = false;
+    sim->had_impact = false;
+    sim->collision_history.length = 0;
+    golf_tlas_refit(&sim->bvh, sim->t);
+}
+
+vec3 golf_sim_get_ball_start_pos(golf_level_t *level) {
+    vec3 ball_start_pos = V3(0, 0, 0);
+    for (int i = 0; i < level->entities.length; i++) {
+        golf_entity_t *entity = &level->entities.data[i];
+        if (entity->type == BALL_START_ENTITY) {
+            ball_start_pos = entity->ball_start.transform.position;
+            ball_start_pos.y += GOLF_SIM_BALL_RADIUS;
+        }
+    }
+    return ball_start_pos;
+}
+
+void golf_sim_ball_init(golf_sim_ball_t *ball, vec3 pos) {
+    ball->start_pos = pos;
+    ball->pos = pos;
+    ball->draw_pos = pos;
+    ball->vel = V3(0, 0, 0);
+    ball->rot_vec = V3(0, 0, 0);
+    ball->orientation = QUAT(0, 0, 0, 1);
+    ball->radius = GOLF_SIM_BALL_RADIUS;
+    ball->rot_vel = 0;
+    ball->time_going_slow = 0;
+    ball->time_out_of_bounds = -1;
+    ball->is_moving = false;
+    ball->is_in_hole = false;
+    ball->is_in_water = false;
+    ball->is_out_of_bounds = false;
+}
+
+float golf_sim_get_hit_speed(golf_sim_t *sim, float power) {
+    _golf_sim_update_params(sim);
+    float green_power = sim->params.aim_green_power;
+    float yellow_power = sim->params.aim_yellow_power;
+    float red_power = sim->params.aim_red_power;
+    float green_speed = sim->params.aim_green_speed;
+    float yellow_speed = sim->params.aim_yellow_speed;
+    float red_speed = sim->params.aim_red_speed;
+    float dark_red_speed = sim->params.aim_dark_red_speed;
+    float start_speed = 0;
+    float p = power;
+    if (p < green_power) {
+        float a = p / green_power;
+        start_speed = green_speed + (yellow_speed - green_speed) * a;
+    }
+    else if (p < yellow_power) {
+        float a = (p - green_power) / (yellow_power - green_power);
+        start_speed = yellow_speed + (red_speed - yellow_speed) * a;
+    }
+    else if (p < red_power) {
+        float a = (p - yellow_power) / (red_power - yellow_power);
+        start_speed = red_speed + (dark_red_speed - red_speed) * a;
+    }
+    else {
+        start_speed = dark_red_speed;
+    }
+    return start_speed;
+}
+
+void golf_sim_hit_ball(golf_sim_t *sim, golf_sim_ball_t *ball, vec3 direction, float power) {
+    ball->vel = vec3_scale(direction, golf_sim_get_hit_speed(sim, power));
+    ball->is_moving = true;
+    ball->start_pos = ball->pos;
+    sim->collision_history.length = 0;
+}
+
+void golf_sim_update(golf_sim_t *sim, golf_sim_ball_t *ball, float dt) {
+    _golf_sim_update_params(sim);
+    sim->t += dt;
+    sim->time_behind += dt;
+
+    vec3 bp_prev = ball->pos;
+    int num_ticks = 0;
+    while (sim->time_behind >= 0 && num_ticks < 5) {
+        bp_prev = ball->pos;
+        sim->tick_dt = _golf_sim_num_base_steps(sim, ball) * GOLF_SIM_BASE_DT;
+        _golf_sim_tick(sim, ball, sim->tick_dt);
+        sim->time_behind -= sim->tick_dt;
+        sim->num_ticks++;
+        num_ticks++;
+    }
+    while (sim->time_behind >= 0) {
+        sim->time_behind -= GOLF_SIM_BASE_DT;
+    }
+
+    float alpha = (float)(-sim->time_behind / sim->tick_dt);
+    ball->draw_pos = vec3_add(vec3_scale(ball->pos, 1.0f - alpha), vec3_scale(bp_prev, alpha));
+}
+
+golf_sim_shot_t golf_sim_run_shot(golf_sim_t *sim, golf_sim_ball_t *ball, vec3 direction, float power, float max_time) {
+    golf_sim_shot_t shot;
+    shot.result = GOLF_SIM_SHOT_TIMED_OUT;
+    shot.went_in_water = false;
+    shot.time = 0;
+
+    golf_sim_hit_ball(sim, ball, direction, power);
+    while (shot.time < max_time) {
+        golf_sim_update(sim, ball, GOLF_SIM_FRAME_DT);
+        shot.time += GOLF_SIM_FRAME_DT;
+        if (ball->is_in_water) {
+            shot.went_in_water = true;
+        }
+
+        if (ball->is_in_hole) {
+            shot.result = GOLF_SIM_SHOT_IN_HOLE;
+            break;
+        }
+        if (ball->is_out_of_bounds) {
+            shot.result = GOLF_SIM_SHOT_OUT_OF_BOUNDS;
+            break;
+        }
+        if (!ball->is_moving) {
+            shot.result = GOLF_SIM_SHOT_STOPPED;
+            break;
+        }
+    }
+
+    shot.end_pos = ball->pos;
+    return shot;
+}
+
+const char *golf_sim_shot_result_string(golf_sim_shot_result_t result) {
+    switch (result) {
+        case GOLF_SIM_SHOT_STOPPED:
+            return "stopped";
+        case GOLF_SIM_SHOT_IN_HOLE:
+            return "in_hole";
+        case GOLF_SIM_SHOT_OUT_OF_BOUNDS:
+            return "out_of_bounds";
+        case GOLF_SIM_SHOT_TIMED_OUT:
+            return "timed_out";
+    }
+    return "unknown";
+}
@@ -0,0 +1,94 @@
+#ifndef _GOLF_SIM_H
+#define _GOLF_SIM_H
+
+#include "common/bvh.h"
+#include "common/data.h"
+#include "common/level.h"
+
+#define MAX_NUM_CONTACTS 8
+
+// Physics ticks are a multiple of the base step, the longer ones are only used
+// while the ball is in the air away from everything
+#define GOLF_SIM_BASE_DT (1.0f / 120.0f)
+#define GOLF_SIM_MAX_BASE_STEPS 4
+
+// Frame length used when simulating shots without the game
+#define GOLF_SIM_FRAME_DT (1.0f / 60.0f)
+
+#define GOLF_SIM_BALL_RADIUS 0.12f
+
+typedef struct golf_collision_data {
+    bool is_highlighted;
+    vec3 ball_pos;
+    int num_contacts;
+    golf_ball_contact_t contacts[MAX_NUM_CONTACTS];
+} golf_collision_data_t;
+typedef vec_t(golf_collision_data_t) vec_golf_collision_data_t;
+
+// Physics values from the game config, bound when the sim starts and again
+// whenever the config is reloaded
+typedef struct golf_sim_params {
+    int cfg_version;
+    float hole_force, hole_force_distance, in_hole_radius;
+    vec3 in_hole_delta;
+    float water_speed, water_max_speed;
+    float ball_rot_scale, kill_y;
+    float aim_green_power, aim_yellow_power, aim_red_power;
+    float aim_green_speed, aim_yellow_speed, aim_red_speed, aim_dark_red_speed;
+} golf_sim_params_t;
+
+typedef struct golf_sim_ball {
+    vec3 start_pos, pos, vel, draw_pos, rot_vec;
+    quat orientation;
+    float radius, rot_vel, time_going_slow, time_out_of_bounds;
+    bool is_moving, is_in_hole, is_in_water, is_out_of_bounds;
+} golf_sim_ball_t;
+
+typedef struct golf_sim {
+    golf_level_t *level;
+    golf_config_t *cfg;
+    golf_sim_params_t params;
+    golf_tlas_t bvh;
+    float t, time_behind, tick_dt;
+    bool had_contacts;
+
+    // Set when the ball hits something hard enough to be heard, the game clears it
+    bool had_impact;
+
+    bool record_collisions;
+    vec_golf_collision_data_t collision_history;
+
+    // Physics ticks run since init, never reset, for measuring throughput
+    int64_t num_ticks;
+} golf_sim_t;
+
+typedef enum golf_sim_shot_result {
+    GOLF_SIM_SHOT_STOPPED,
+    GOLF_SIM_SHOT_IN_HOLE,
+    GOLF_SIM_SHOT_OUT_OF_BOUNDS,
+    GOLF_SIM_SHOT_TIMED_OUT,
+} golf_sim_shot_result_t;
+
+typedef struct golf_sim_shot {
+    golf_sim_shot_result_t result;
+    vec3 end_pos;
+    float time;
+    bool went_in_water;
+} golf_sim_shot_t;
+
+void golf_sim_init(golf_sim_t *sim, golf_config_t *cfg);
+void golf_sim_deinit(golf_sim_t *sim);
+void golf_sim_start_level(golf_sim_t *sim, golf_level_t *level);
+// Puts the level back to t = 0 without rebuilding the BVH
+void golf_sim_reset(golf_sim_t *sim);
+vec3 golf_sim_get_ball_start_pos(golf_level_t *level);
+void golf_sim_ball_init(golf_sim_ball_t *ball, vec3 pos);
+// Identifies the physics config, so replays can tell when it has changed
+uint32_t golf_sim_get_params_hash(golf_sim_t *sim);
+float golf_sim_get_hit_speed(golf_sim_t *sim, float power);
+void golf_sim_hit_ball(golf_sim_t *sim, golf_sim_ball_t *ball, vec3 direction, float power);
+void golf_sim_update(golf_sim_t *sim, golf_sim_ball_t *ball, float dt);
+golf_sim_shot_t golf_sim_run_shot(golf_sim_t *sim, golf_sim_ball_t *ball, vec3 direction, float power, float max_time);
+const char *golf_sim_shot_result_string(golf_sim_shot_result_t result);
+
+#endif
@@ -0,0 +1,304 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The tools don't link the sokol library, so they build sokol_time themselves
+#define SOKOL_TIME_IMPL
+#include "sokol/sokol_time.h"
+#include "common/alloc.h"
+#include "common/common.h"
+#include "common/data.h"
+#include "common/log.h"
+#include "golf/replay.h"
+#include "golf/sim.h"
+#include "golf/sim_sweep.h"
+
+// Runs shots through the physics without a window, graphics or audio.
+//
+//   golf_sim [-n num_shots] [-power power] [-max_time seconds] level_path...
+//
+// fires a fan of shots spread evenly around the ball start at the same power.
+//
+//   golf_sim -sweep [-angles n] [-powers n] [-random n] [-seed n] [-strokes n] [-threads n] [level_path...]
+//
+// sweeps the aim space of each level across a thread pool, every level in
+// data/levels when none are given.
+//
+//   golf_sim -replay replay_path...
+//
+// plays replays saved from the game as fast as possible and checks that the
+// ball ends up exactly where it did when they were recorded.
+
+typedef struct _options {
+    int num_shots;
+    float power;
+    float max_time;
+    bool sweep, replay;
+    golf_sim_sweep_desc_t sweep_desc;
+} _options_t;
+
+static void _print_usage(void) {
+    printf("usage: golf_sim [-n num_shots] [-power power] [-max_time seconds] level_path...\n");
+    printf("       golf_sim -sweep [-angles n] [-powers n] [-random n] [-seed n] [-strokes n] [-threads n] [level_path...]\n");
+    printf("       golf_sim -replay replay_path...\n");
+}
+
+static void _run_fan(golf_sim_t *sim, const char *level_path, golf_level_t *level, _options_t *options) {
+    golf_sim_start_level(sim, level);
+    vec3 ball_start_pos = golf_sim_get_ball_start_pos(level);
+
+    int result_counts[GOLF_SIM_SHOT_TIMED_OUT + 1] = { 0 };
+    int num_in_water = 0;
+    uint64_t start_time = stm_now();
+    printf("%s\n", level_path);
+    for (int j = 0; j < options->num_shots; j++) {
+        float angle = 2 * MF_PI * j / options->num_shots;
+        vec3 direction = V3(cosf(angle), 0, sinf(angle));
+
+        // Every shot starts with the level at t = 0 so moving entities line up
+        golf_sim_reset(sim);
+        golf_sim_ball_t ball;
+        golf_sim_ball_init(&ball, ball_start_pos);
+        golf_sim_shot_t shot = golf_sim_run_shot(sim, &ball, direction, options->power, options->max_time);
+
+        result_counts[shot.result]++;
+        if (shot.went_in_water) {
+            num_in_water++;
+        }
+        printf("    angle %6.1f: %-13s time %5.2f end <%0.2f, %0.2f, %0.2f>%s\n",
+                angle * 180 / MF_PI, golf_sim_shot_result_string(shot.result), shot.time,
+                shot.end_pos.x, shot.end_pos.y, shot.end_pos.z,
+                shot.went_in_water ? " water" : "");
+    }
+    double elapsed = stm_sec(stm_since(start_time));
+    printf("    %d shots in %0.3fs: %d in hole, %d stopped, %d out of bounds, %d timed out, %d in water\n",
+            options->num_shots, elapsed,
+            result_counts[GOLF_SIM_SHOT_IN_HOLE], result_counts[GOLF_SIM_SHOT_STOPPED],
+            result_counts[GOLF_SIM_SHOT_OUT_OF_BOUNDS], result_counts[GOLF_SIM_SHOT_TIMED_OUT],
+            num_in_water);
+}
+
+static void _run_sweep(golf_config_t *cfg, const char *level_path, golf_level_t *level, _options_t *options) {
+    golf_sim_sweep_desc_t *desc = &options->sweep_desc;
+    golf_sim_sweep_result_t result;
+    golf_sim_sweep_run(level, cfg, desc, &result);
+
+    int num_first_shots = result.first_shots.length;
+    float to_percent = num_first_shots > 0 ? 100.0f / num_first_shots : 0;
+    printf("%s\n", level_path);
+    if (result.min_strokes > 0) {
+        printf("    min strokes found: %d\n", result.min_strokes);
+    }
+    else {
+        printf("    min strokes found: none within %d\n", desc->max_strokes);
+    }
+    printf("    first stroke: %0.1f%% in hole, %0.1f%% out of bounds, %0.1f%% in water, %0.1f%% timed out\n",
+            result.num_in_hole * to_percent, result.num_out_of_bounds * to_percent,
+            result.num_in_water * to_percent, result.num_timed_out * to_percent);
+
+    if (result.num_in_hole > 0) {
+        printf("    hole in one:\n");
+        if (desc->num_random_shots > 0) {
+            for (int i = 0; i < num_first_shots; i++) {
+                golf_sim_sweep_shot_t *shot = &result.first_shots.data[i];
+                if (shot->shot.result == GOLF_SIM_SHOT_IN_HOLE) {
+                    printf("        power %0.2f, angle %0.1f\n", shot->power, shot->angle * 180 / MF_PI);
+                }
+            }
+        }
+        else {
+            // The grid is laid out a row of angles per power, print each run of angles that sink
+            for (int i = 0; i < desc->num_powers; i++) {
+                golf_sim_sweep_shot_t *row = &result.first_shots.data[i * desc->num_angles];
+                int run_start = -1;
+                for (int j = 0; j <= desc->num_angles; j++) {
+                    bool in_hole = j < desc->num_angles && row[j].shot.result == GOLF_SIM_SHOT_IN_HOLE;
+                    if (in_hole && run_start < 0) {
+                        run_start = j;
+                    }
+                    else if (!in_hole && run_start >= 0) {
+                        printf("        power %0.2f, angle %0.1f to %0.1f\n", row[run_start].power,
+                                row[run_start].angle * 180 / MF_PI, row[j - 1].angle * 180 / MF_PI);
+                        run_start = -1;
+                    }
+                }
+            }
+        }
+    }
+    printf("    %d shots in %0.3fs on %d threads\n", result.num_shots_simulated, result.elapsed_time, desc->num_threads);
+
+    golf_sim_sweep_result_deinit(&result);
+}
+
+static bool _run_replay(golf_config_t *cfg, const char *replay_path) {
+    golf_replay_t replay;
+    golf_replay_init(&replay);
+    if (!golf_replay_load(&replay, replay_path)) {
+        golf_replay_deinit(&replay);
+        return false;
+    }
+
+    golf_data_load(replay.level_path, false);
+    if (golf_data_get_load_state(replay.level_path) != GOLF_DATA_LOADED) {
+        golf_log_warning("Unable to load level %s", replay.level_path);
+        golf_replay_deinit(&replay);
+        return false;
+    }
+    golf_level_t *level = golf_data_get_level(replay.level_path);
+
+    golf_sim_t sim;
+    golf_sim_init(&sim, cfg);
+    golf_sim_start_level(&sim, level);
+    if (replay.params_hash != golf_sim_get_params_hash(&sim)) {
+        golf_log_warning("Replay %s was recorded with a different physics config", replay_path);
+    }
+
+    golf_sim_ball_t ball;
+    golf_sim_ball_init(&ball, golf_sim_get_ball_start_pos(level));
+
+    uint64_t start_time = stm_now();
+    golf_replay_player_t player;
+    golf_replay_player_init(&player, &replay);
+    golf_replay_player_fast_forward(&player, &sim, &ball);
+    double elapsed = stm_sec(stm_since(start_time));
+
+    // Compare the bits, any difference at all means the physics changed
+    golf_sim_ball_t *end_ball = &replay.end_ball;
+    bool matches = memcmp(&ball.pos, &end_ball->pos, sizeof(vec3)) == 0 &&
+        memcmp(&ball.vel, &end_ball->vel, sizeof(vec3)) == 0 &&
+        ball.is_in_hole == end_ball->is_in_hole &&
+        ball.is_out_of_bounds == end_ball->is_out_of_bounds;
+
+    printf("%s: %s, %d frames in %0.3fs\n", replay_path, matches ? "match" : "MISMATCH",
+            replay.frame_dts.length, elapsed);
+    if (!matches) {
+        printf("    recorded <%f, %f, %f> played <%f, %f, %f>\n",
+                end_ball->pos.x, end_ball->pos.y, end_ball->pos.z, ball.pos.x, ball.pos.y, ball.pos.z);
+    }
+
+    golf_sim_deinit(&sim);
+    golf_replay_deinit(&replay);
+    return matches;
+}
+
+int main(int argc, char *argv[]) {
+    _options_t options;
+    options.num_shots = 16;
+    options.power = 0.5f;
+    options.max_time = 30;
+    options.sweep = false;
+    options.replay = false;
+
+    golf_alloc_init();
+    golf_log_init();
+    stm_setup();
+
+    options.sweep_desc = golf_sim_sweep_desc_default();
+
+    int first_level_arg = argc;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_val = i + 1 < argc;
+        if (strcmp(arg, "-sweep") == 0) {
+            options.sweep = true;
+        }
+        else if (strcmp(arg, "-replay") == 0) {
+            options.replay = true;
+        }
+        else if (strcmp(arg, "-n") == 0 && has_val) {
+            options.num_shots = atoi(argv[++i]);
+        }
+        else if (strcmp(arg, "-power") == 0 && has_val) {
+            options.power = (float)atof(argv[++i]);
+        }
+        else if (strcmp(arg, "-max_time") == 0 && has_val) {
+            options.max_time = (float)atof(argv[++i]);
+            options.sweep_desc.max_shot_time = options.max_time;
+        }
+        else if (strcmp(arg, "-angles") == 0 && has_val) {
+            options.sweep_desc.num_angles = atoi(argv[++i]);
+        }
+        else if (strcmp(arg, "-powers") == 0 && has_val) {
+            options.sweep_desc.num_powers = atoi(argv[++i]);
+        }
+        else if (strcmp(arg, "-random") == 0 && has_val) {
+            options.sweep_desc.num_random_shots = atoi(argv[++i]);
+        }
+        else if (strcmp(arg, "-seed") == 0 && has_val) {
+            options.sweep_desc.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(arg, "-strokes") == 0 && has_val) {
+            options.sweep_desc.max_strokes = atoi(argv[++i]);
+        }
+        else if (strcmp(arg, "-threads") == 0 && has_val) {
+            options.sweep_desc.num_threads = atoi(argv[++i]);
+        }
+        else if (arg[0] == '-') {
+            _print_usage();
+            return 1;
+        }
+        else {
+            first_level_arg = i;
+            break;
+        }
+    }
+    if ((!options.sweep && first_level_arg == argc) || (options.sweep && options.replay) || options.num_shots <= 0 ||
+            options.sweep_desc.num_angles <= 0 || options.sweep_desc.num_powers <= 0) {
+        _print_usage();
+        return 1;
+    }
+
+    golf_data_set_headless(true);
+    golf_data_init();
+
+    golf_data_load("data/config/game.cfg", false);
+    golf_config_t *cfg = golf_data_get_config("data/config/game.cfg");
+
+    if (options.replay) {
+        bool all_match = true;
+        for (int i = first_level_arg; i < argc; i++) {
+            if (!_run_replay(cfg, argv[i])) {
+                all_match = false;
+            }
+        }
+        return all_match ? 0 : 1;
+    }
+
+    vec_golf_file_t level_files;
+    vec_init(&level_files, "sim");
+    if (first_level_arg == argc) {
+        golf_data_get_all_matching(GOLF_DATA_LEVEL, "data/levels/", &level_files);
+    }
+    else {
+        for (int i = first_level_arg; i < argc; i++) {
+            vec_push(&level_files, golf_file(argv[i]));
+        }
+    }
+
+    golf_sim_t sim;
+    golf_sim_init(&sim, cfg);
+
+    bool all_loaded = true;
+    for (int i = 0; i < level_files.length; i++) {
+        const char *level_path = level_files.data[i].path;
+        golf_data_load(level_path, false);
+        if (golf_data_get_load_state(level_path) != GOLF_DATA_LOADED) {
+            golf_log_warning("Unable to load level %s", level_path);
+            all_loaded = false;
+            continue;
+        }
+        golf_level_t *level = golf_data_get_level(level_path);
+
+        if (options.sweep) {
+            _run_sweep(cfg, level_path, level, &options);
+        }
+        else {
+            _run_fan(&sim, level_path, level, &options);
+        }
+    }
+
+    golf_sim_deinit(&sim);
+    vec_deinit(&level_files);
+    return all_loaded ? 0 : 1;
+}
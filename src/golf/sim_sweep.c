@@ -0,0 +1,273 @@
+#include "golf/sim_sweep.h"
+
+#include <float.h>
+
+#include "sokol/sokol_time.h"
+#include "common/alloc.h"
+#include "common/common.h"
+#include "common/thread.h"
+
+// Shots are handed out to the workers in chunks to keep the lock cold
+#define SWEEP_CHUNK_SIZE 16
+
+typedef struct _sweep_job {
+    golf_level_t *level;
+    float max_shot_time;
+    golf_sim_sweep_shot_t *shots;
+    int num_shots;
+
+    golf_mutex_t lock;
+    int next_shot;
+} _sweep_job_t;
+
+typedef struct _sweep_followup {
+    vec3 pos;
+    float hole_dist;
+    bool is_picked;
+} _sweep_followup_t;
+typedef vec_t(_sweep_followup_t) _vec_sweep_followup_t;
+
+typedef struct _sweep_worker {
+    _sweep_job_t *job;
+    golf_sim_t sim;
+} _sweep_worker_t;
+
+static golf_thread_result_t _sweep_worker_fn(void *user_data) {
+    _sweep_worker_t *worker = (_sweep_worker_t*)user_data;
+    _sweep_job_t *job = worker->job;
+
+    // Each worker owns its BVH, it only has to be built for the first stroke
+    if (worker->sim.level != job->level) {
+        golf_sim_start_level(&worker->sim, job->level);
+    }
+
+    while (true) {
+        golf_mutex_lock(&job->lock);
+        int first = job->next_shot;
+        job->next_shot += SWEEP_CHUNK_SIZE;
+        golf_mutex_unlock(&job->lock);
+        if (first >= job->num_shots) {
+            break;
+        }
+
+        int last = first + SWEEP_CHUNK_SIZE;
+        if (last > job->num_shots) {
+            last = job->num_shots;
+        }
+        for (int i = first; i < last; i++) {
+            golf_sim_sweep_shot_t *shot = &job->shots[i];
+            vec3 direction = V3(cosf(shot->angle), 0, sinf(shot->angle));
+
+            // Every stroke starts with the level at t = 0 so the results don't depend
+            // on which worker ran the shot or what it ran before
+            golf_sim_reset(&worker->sim);
+            golf_sim_ball_t ball;
+            golf_sim_ball_init(&ball, shot->start_pos);
+            shot->shot = golf_sim_run_shot(&worker->sim, &ball, direction, shot->power, job->max_shot_time);
+        }
+    }
+
+    return GOLF_THREAD_RESULT_SUCCESS;
+}
+
+static void _sweep_run_shots(_sweep_job_t *job, _sweep_worker_t *workers, int num_workers) {
+    job->next_shot = 0;
+
+    golf_thread_t *threads = golf_alloc(sizeof(golf_thread_t) * num_workers);
+    for (int i = 0; i < num_workers; i++) {
+        workers[i].job = job;
+        threads[i] = golf_thread_create(_sweep_worker_fn, &workers[i], "_sweep_worker_fn");
+    }
+    for (int i = 0; i < num_workers; i++) {
+        golf_thread_join(threads[i]);
+        golf_thread_destroy(threads[i]);
+    }
+    golf_free(threads);
+}
+
+static uint32_t _sweep_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void _sweep_push_shots(golf_sim_sweep_desc_t *desc, vec3 start_pos, uint32_t *random_state, vec_golf_sim_sweep_shot_t *shots) {
+    golf_sim_sweep_shot_t shot;
+    memset(&shot, 0, sizeof(shot));
+    shot.start_pos = start_pos;
+
+    if (desc->num_random_shots > 0) {
+        for (int i = 0; i < desc->num_random_shots; i++) {
+            float a = (float)(_sweep_random(random_state) >> 8) / (float)(1 << 24);
+            float p = (float)(_sweep_random(random_state) >> 8) / (float)(1 << 24);
+            shot.angle = 2 * MF_PI * a;
+            shot.power = desc->min_power + (desc->max_power - desc->min_power) * p;
+            vec_push(shots, shot);
+        }
+    }
+    else {
+        for (int i = 0; i < desc->num_powers; i++) {
+            float p = desc->num_powers > 1 ? (float)i / (desc->num_powers - 1) : 1.0f;
+            shot.power = desc->min_power + (desc->max_power - desc->min_power) * p;
+            for (int j = 0; j < desc->num_angles; j++) {
+                shot.angle = 2 * MF_PI * j / desc->num_angles;
+                vec_push(shots, shot);
+            }
+        }
+    }
+}
+
+static int _sweep_followup_cmp(const void *a, const void *b) {
+    float da = ((const _sweep_followup_t*)a)->hole_dist;
+    float db = ((const _sweep_followup_t*)b)->hole_dist;
+    if (da < db) {
+        return -1;
+    }
+    else if (da > db) {
+        return 1;
+    }
+    else {
+        return 0;
+    }
+}
+
+golf_sim_sweep_desc_t golf_sim_sweep_desc_default(void) {
+    golf_sim_sweep_desc_t desc;
+    desc.num_angles = 48;
+    desc.num_powers = 6;
+    desc.min_power = 0.1f;
+    desc.max_power = 1.0f;
+    desc.num_random_shots = 0;
+    desc.seed = 1;
+    desc.num_followups = 4;
+    desc.max_strokes = 3;
+    desc.max_shot_time = 20;
+    desc.num_threads = golf_thread_get_num_cores();
+    return desc;
+}
+
+void golf_sim_sweep_run(golf_level_t *level, golf_config_t *cfg, golf_sim_sweep_desc_t *desc, golf_sim_sweep_result_t *result) {
+    uint64_t start_time = stm_now();
+
+    memset(result, 0, sizeof(golf_sim_sweep_result_t));
+    vec_init(&result->first_shots, "sim");
+
+    vec3 hole_pos = V3(0, 0, 0);
+    for (int i = 0; i < level->entities.length; i++) {
+        golf_entity_t *entity = &level->entities.data[i];
+        if (entity->type == HOLE_ENTITY) {
+            hole_pos = entity->hole.transform.position;
+        }
+    }
+
+    int num_workers = desc->num_threads > 0 ? desc->num_threads : 1;
+    _sweep_worker_t *workers = golf_alloc(sizeof(_sweep_worker_t) * num_workers);
+    for (int i = 0; i < num_workers; i++) {
+        golf_sim_init(&workers[i].sim, cfg);
+    }
+
+    _sweep_job_t job;
+    job.level = level;
+    job.max_shot_time = desc->max_shot_time;
+    golf_mutex_init(&job.lock);
+
+    uint32_t random_state = desc->seed ? desc->seed : 1;
+    vec_golf_sim_sweep_shot_t shots;
+    vec_init(&shots, "sim");
+    _vec_sweep_followup_t followups;
+    vec_init(&followups, "sim");
+
+    _sweep_push_shots(desc, golf_sim_get_ball_start_pos(level), &random_state, &shots);
+    for (int stroke = 1; stroke <= desc->max_strokes && shots.length > 0; stroke++) {
+        job.shots = shots.data;
+        job.num_shots = shots.length;
+        _sweep_run_shots(&job, workers, num_workers);
+        result->num_shots_simulated += shots.length;
+
+        if (stroke == 1) {
+            vec_pusharr(&result->first_shots, shots.data, shots.length);
+            for (int i = 0; i < shots.length; i++) {
+                golf_sim_shot_t *shot = &shots.data[i].shot;
+                switch (shot->result) {
+                    case GOLF_SIM_SHOT_STOPPED:
+                        result->num_stopped++;
+                        break;
+                    case GOLF_SIM_SHOT_IN_HOLE:
+                        result->num_in_hole++;
+                        break;
+                    case GOLF_SIM_SHOT_OUT_OF_BOUNDS:
+                        result->num_out_of_bounds++;
+                        break;
+                    case GOLF_SIM_SHOT_TIMED_OUT:
+                        result->num_timed_out++;
+                        break;
+                }
+                if (shot->went_in_water) {
+                    result->num_in_water++;
+                }
+            }
+        }
+
+        bool reached_hole = false;
+        for (int i = 0; i < shots.length; i++) {
+            if (shots.data[i].shot.result == GOLF_SIM_SHOT_IN_HOLE) {
+                reached_hole = true;
+                break;
+            }
+        }
+        if (reached_hole) {
+            result->min_strokes = stroke;
+            break;
+        }
+
+        // Carry the stopped balls closest to the hole into the next stroke, skipping
+        // ones that ended up next to a ball that is already being followed up
+        followups.length = 0;
+        for (int i = 0; i < shots.length; i++) {
+            golf_sim_shot_t *shot = &shots.data[i].shot;
+            if (shot->result == GOLF_SIM_SHOT_STOPPED) {
+                _sweep_followup_t followup;
+                followup.pos = shot->end_pos;
+                followup.hole_dist = vec3_distance(shot->end_pos, hole_pos);
+                followup.is_picked = false;
+                vec_push(&followups, followup);
+            }
+        }
+        qsort(followups.data, followups.length, sizeof(_sweep_followup_t), _sweep_followup_cmp);
+
+        shots.length = 0;
+        int num_picked = 0;
+        for (int i = 0; i < followups.length && num_picked < desc->num_followups; i++) {
+            _sweep_followup_t *followup = &followups.data[i];
+            bool is_near_picked = false;
+            for (int j = 0; j < i; j++) {
+                if (followups.data[j].is_picked && vec3_distance(followups.data[j].pos, followup->pos) < 0.5f) {
+                    is_near_picked = true;
+                    break;
+                }
+            }
+            if (!is_near_picked) {
+                followup->is_picked = true;
+                _sweep_push_shots(desc, followup->pos, &random_state, &shots);
+                num_picked++;
+            }
+        }
+    }
+
+    vec_deinit(&followups);
+    vec_deinit(&shots);
+    golf_mutex_deinit(&job.lock);
+    for (int i = 0; i < num_workers; i++) {
+        golf_sim_deinit(&workers[i].sim);
+    }
+    golf_free(workers);
+
+    result->elapsed_time = stm_sec(stm_since(start_time));
+}
+
+void golf_sim_sweep_result_deinit(golf_sim_sweep_result_t *result) {
+    vec_deinit(&result->first_shots);
+}
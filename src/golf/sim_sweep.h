@@ -0,0 +1,48 @@
+#ifndef _GOLF_SIM_SWEEP_H
+#define _GOLF_SIM_SWEEP_H
+
+#include "golf/sim.h"
+
+// Fires shots over the aim space of a level across a pool of threads, each
+// with its own golf_sim_t. Shots after the first stroke start from the most
+// promising places the ball stopped, so min_strokes is an upper bound found
+// by the search rather than a proven minimum.
+
+typedef struct golf_sim_sweep_desc {
+    // Grid of angles around the ball and powers between min_power and max_power.
+    // When num_random_shots is set the shots are sampled uniformly instead.
+    int num_angles, num_powers;
+    float min_power, max_power;
+    int num_random_shots;
+    uint32_t seed;
+
+    // Number of stopped positions carried into the next stroke
+    int num_followups;
+    int max_strokes;
+    float max_shot_time;
+    int num_threads;
+} golf_sim_sweep_desc_t;
+
+typedef struct golf_sim_sweep_shot {
+    vec3 start_pos;
+    float angle, power;
+    golf_sim_shot_t shot;
+} golf_sim_sweep_shot_t;
+typedef vec_t(golf_sim_sweep_shot_t) vec_golf_sim_sweep_shot_t;
+
+typedef struct golf_sim_sweep_result {
+    // Shots from the ball start, in grid order (powers outer, angles inner)
+    vec_golf_sim_sweep_shot_t first_shots;
+    int num_in_hole, num_stopped, num_out_of_bounds, num_timed_out, num_in_water;
+
+    // 0 if the hole was not reached within max_strokes
+    int min_strokes;
+    int num_shots_simulated;
+    double elapsed_time;
+} golf_sim_sweep_result_t;
+
+golf_sim_sweep_desc_t golf_sim_sweep_desc_default(void);
+void golf_sim_sweep_run(golf_level_t *level, golf_config_t *cfg, golf_sim_sweep_desc_t *desc, golf_sim_sweep_result_t *result);
+void golf_sim_sweep_result_deinit(golf_sim_sweep_result_t *result);
+
+#endif
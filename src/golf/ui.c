@@ -84,6 +84,35 @@ static void _golf_ui_draw_fade(float alpha) {
     vec_push(&ui.draw_entities, _golf_ui_draw_entity(texture->sg_image, pos, size, angle, uv0, uv1, is_font, overlay_color, alpha));
 }
 
+static const golf_config_binding_t _ui_param_bindings[] = {
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_min_length, "aim_min_length"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_max_length, "aim_max_length"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_green_power, "aim_green_power"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_yellow_power, "aim_yellow_power"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_red_power, "aim_red_power"),
+    GOLF_CONFIG_BIND_VEC4(golf_ui_params_t, aim_green_color, "aim_green_color"),
+    GOLF_CONFIG_BIND_VEC4(golf_ui_params_t, aim_yellow_color, "aim_yellow_color"),
+    GOLF_CONFIG_BIND_VEC4(golf_ui_params_t, aim_red_color, "aim_red_color"),
+    GOLF_CONFIG_BIND_VEC4(golf_ui_params_t, aim_dark_red_color, "aim_dark_red_color"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_rotate_min_angle, "aim_rotate_min_angle"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_rotate_max_angle, "aim_rotate_max_angle"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_rotate_speed, "aim_rotate_speed"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, aim_circle_min_scale, "aim_circle_min_scale"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, ui_scroll_scale, "ui_scroll_scale"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, game_fade_in_length, "game_fade_in_length"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, game_time_to_show_level_num, "game_time_to_show_level_num"),
+    GOLF_CONFIG_BIND_NUM(golf_ui_params_t, out_of_bounds_blink_time, "out_of_bounds_blink_time"),
+};
+
+static void _golf_ui_update_params(void) {
+    if (ui.params.cfg_version == game_cfg->version) {
+        return;
+    }
+
+    golf_config_bind(game_cfg, _ui_param_bindings, (int)(sizeof(_ui_param_bindings) / sizeof(_ui_param_bindings[0])), &ui.params);
+    ui.params.cfg_version = game_cfg->version;
+}
+
 golf_ui_t *golf_ui_get(void) {
     return &ui;
 }
@@ -103,6 +132,7 @@ void golf_ui_init(void) {
     game = golf_game_get();
     game_cfg = golf_data_get_config("data/config/game.cfg");
     golf = golf_get();
+    _golf_ui_update_params();
 }
 
 static bool _golf_ui_layout_get_entity(golf_ui_layout_t *layout, const char *name, golf_ui_layout_entity_t *entity) {
@@ -548,8 +578,8 @@ static void _golf_ui_aim_circle_name(golf_ui_layout_t *layout, const char *name,
         float vert_scale = 1.777f * (reference_width / graphics->viewport_size.y);
         aimer_length = aimer_length * vert_scale;
 
-        float min_length = golf_config_get_num(game_cfg, "aim_min_length");
-        float max_length = golf_config_get_num(game_cfg, "aim_max_length");
+        float min_length = ui.params.aim_min_length;
+        float max_length = ui.params.aim_max_length;
         if (aimer_length > max_length) {
             aimer_size.y = max_length / vert_scale; 
             aimer_pos = vec2_add(pos, vec2_scale(delta, 0.5f * aimer_size.y));
@@ -558,17 +588,17 @@ static void _golf_ui_aim_circle_name(golf_ui_layout_t *layout, const char *name,
 
         vec4 wanted_color = V4(0, 0, 0, 1);
         float power = (aimer_size.y * vert_scale - min_length) / (max_length - min_length);
-        if (power < golf_config_get_num(game_cfg, "aim_green_power")) {
-            wanted_color = golf_config_get_vec4(game_cfg, "aim_green_color");
+        if (power < ui.params.aim_green_power) {
+            wanted_color = ui.params.aim_green_color;
         }
-        else if (power < golf_config_get_num(game_cfg, "aim_yellow_power")) {
-            wanted_color = golf_config_get_vec4(game_cfg, "aim_yellow_color");
+        else if (power < ui.params.aim_yellow_power) {
+            wanted_color = ui.params.aim_yellow_color;
         }
-        else if (power < golf_config_get_num(game_cfg, "aim_red_power")) {
-            wanted_color = golf_config_get_vec4(game_cfg, "aim_red_color");
+        else if (power < ui.params.aim_red_power) {
+            wanted_color = ui.params.aim_red_color;
         }
         else {
-            wanted_color = golf_config_get_vec4(game_cfg, "aim_dark_red_color");
+            wanted_color = ui.params.aim_dark_red_color;
         }
         vec4 color = ui.aim_circle.aimer_color;
         color = vec4_add(color, vec4_scale(vec4_sub(wanted_color, color), 0.05f));
@@ -584,9 +614,9 @@ static void _golf_ui_aim_circle_name(golf_ui_layout_t *layout, const char *name,
         }
 
         if (game->aim_line.power > 0) {
-            float min_angle = golf_config_get_num(game_cfg, "aim_rotate_min_angle");
-            float max_angle = golf_config_get_num(game_cfg, "aim_rotate_max_angle");
-            float rotate_speed = golf_config_get_num(game_cfg, "aim_rotate_speed");
+            float min_angle = ui.params.aim_rotate_min_angle;
+            float max_angle = ui.params.aim_rotate_max_angle;
+            float rotate_speed = ui.params.aim_rotate_speed;
             if (aimer_angle > min_angle) {
                 float a = 1.0f - (max_angle - aimer_angle) / (max_angle - min_angle);
                 if (a > 1) a = 1;
@@ -606,7 +636,7 @@ static void _golf_ui_aim_circle_name(golf_ui_layout_t *layout, const char *name,
         float a = entity->aim_circle.t / entity->aim_circle.total_time;
         float theta = 2.0f * MF_PI * i / num_squares + 2.0f * MF_PI * a;
 
-        float min_scale = CFG_NUM(game_cfg, "aim_circle_min_scale");
+        float min_scale = ui.params.aim_circle_min_scale;
         float s = min_scale + (1 - min_scale) * circle_scale;
         vec2 p = V2(pos.x + s * size.x * cosf(theta), pos.y + s * size.y * sinf(theta));
 
@@ -670,7 +700,7 @@ static int _golf_ui_level_select_scroll_box_name(golf_ui_layout_t *layout, const
 
     if (!inputs->is_touch) {
         float down_delta = entity->level_select_scroll_box.down_delta;
-        down_delta += CFG_NUM(game_cfg, "ui_scroll_scale") * inputs->mouse_scroll_delta.y;
+        down_delta += ui.params.ui_scroll_scale * inputs->mouse_scroll_delta.y;
         if (down_delta >= 0) down_delta = 0;
         if (down_delta <= -total_height) down_delta = -total_height;
         entity->level_select_scroll_box.down_delta = down_delta;
@@ -1011,7 +1041,7 @@ static void _golf_ui_main_menu(float dt) {
         }
     }
 
-    float fade_in_length = CFG_NUM(game_cfg, "game_fade_in_length");
+    float fade_in_length = ui.params.game_fade_in_length;
     if (golf->main_menu.t < fade_in_length) {
         float alpha = 1 - (golf->main_menu.t / fade_in_length);
         _golf_ui_draw_fade(alpha);
@@ -1077,7 +1107,7 @@ static void _golf_ui_in_game_waiting_for_aim(float dt) {
     bool start_aiming;
     _golf_ui_aim_circle_name(layout, "aim_circle", false, dt, NULL, &start_aiming);
     if (start_aiming) {
-        ui.aim_circle.aimer_color = golf_config_get_vec4(game_cfg, "aim_green_color");
+        ui.aim_circle.aimer_color = ui.params.aim_green_color;
         golf_game_start_aiming();
     }
     else {
@@ -1172,39 +1202,43 @@ static void _golf_ui_in_game(float dt) {
         }
     }
 
-    float temp_val;
-    if (!golf_storage_get_num("seen_tutorial_0", &temp_val)) {
-        if (game->state == GOLF_GAME_STATE_WAITING_FOR_AIM) {
-            _golf_ui_tutorial_name(layout, "tutorial", 0, dt);
-        }
-        else if (game->state == GOLF_GAME_STATE_AIMING) {
-            if (game->aim_line.power > 0) {
-                _golf_ui_tutorial_name(layout, "tutorial", 1, dt);
-            }
-            else {
+    // Replays don't show the tutorial or mark it as seen
+    if (!game->replay.is_replay_attempt) {
+        float temp_val;
+        if (!golf_storage_get_num("seen_tutorial_0", &temp_val)) {
+            if (game->state == GOLF_GAME_STATE_WAITING_FOR_AIM) {
                 _golf_ui_tutorial_name(layout, "tutorial", 0, dt);
             }
+            else if (game->state == GOLF_GAME_STATE_AIMING) {
+                if (game->aim_line.power > 0) {
+                    _golf_ui_tutorial_name(layout, "tutorial", 1, dt);
+                }
+                else {
+                    _golf_ui_tutorial_name(layout, "tutorial", 0, dt);
+                }
+            }
+            else if (game->state == GOLF_GAME_STATE_WATCHING_BALL) {
+                ui.tutorial.just_saw_tutorial_0 = true;
+                golf_storage_set_num("seen_tutorial_0", 1);
+                golf_storage_save();
+            }
         }
-        else if (game->state == GOLF_GAME_STATE_WATCHING_BALL) {
-            ui.tutorial.just_saw_tutorial_0 = true;
-            golf_storage_set_num("seen_tutorial_0", 1);
-            golf_storage_save();
-        }
-    }
-    else if (!golf_storage_get_num("seen_tutorial_1", &temp_val)) {
-        if (game->state == GOLF_GAME_STATE_WAITING_FOR_AIM) {
-            ui.tutorial.just_saw_tutorial_0 = false;
-            _golf_ui_tutorial_name(layout, "tutorial", 2, dt);
-        }
-        else if (!ui.tutorial.just_saw_tutorial_0 && game->state == GOLF_GAME_STATE_WATCHING_BALL) {
-            golf_storage_set_num("seen_tutorial_1", 1);
-            golf_storage_save();
+        else if (!golf_storage_get_num("seen_tutorial_1", &temp_val)) {
+            if (game->state == GOLF_GAME_STATE_WAITING_FOR_AIM) {
+                ui.tutorial.just_saw_tutorial_0 = false;
+                _golf_ui_tutorial_name(layout, "tutorial", 2, dt);
+            }
+            else if (!ui.tutorial.just_saw_tutorial_0 && game->state == GOLF_GAME_STATE_WATCHING_BALL) {
+                golf_storage_set_num("seen_tutorial_1", 1);
+                golf_storage_save();
+            }
         }
     }
 
     {
-        float blink_time = CFG_NUM(game_cfg, "out_of_bounds_blink_time");
-        float time_since_out_of_bounds = game->t - game->ball.time_out_of_bounds;
+        float blink_time = ui.params.out_of_bounds_blink_time;
+        // time_out_of_bounds is stamped with the sim clock, which runs on recorded dts during replays
+        float time_since_out_of_bounds = game->physics.sim.t - game->ball.time_out_of_bounds;
         if (time_since_out_of_bounds < blink_time) {
             float alpha = 1 - time_since_out_of_bounds / blink_time;
             golf_texture_t *texture = golf_data_get_texture("data/textures/colors/black.png");
@@ -1241,8 +1275,8 @@ static void _golf_ui_in_game(float dt) {
             break;
     }
 
-    float fade_in_length = CFG_NUM(game_cfg, "game_fade_in_length");
-    float time_to_show_level_num = CFG_NUM(game_cfg, "game_time_to_show_level_num");
+    float fade_in_length = ui.params.game_fade_in_length;
+    float time_to_show_level_num = ui.params.game_time_to_show_level_num;
 
     if (golf->in_game.t < time_to_show_level_num + fade_in_length) {
         golf_ui_layout_entity_t *entity;
@@ -1265,6 +1299,7 @@ static void _golf_ui_in_game(float dt) {
 
 void golf_ui_update(float dt) {
     ui.draw_entities.length = 0;
+    _golf_ui_update_params();
 
 #if GOLF_PLATFORM_WINDOWS || GOLF_PLATFORM_LINUX
     {
@@ -1294,7 +1329,7 @@ void golf_ui_update(float dt) {
     }
 
     if (ui.fade_out.active) {
-        float fade_out_length = CFG_NUM(game_cfg, "game_fade_in_length");
+        float fade_out_length = ui.params.game_fade_in_length;
         float alpha = (ui.fade_out.t / fade_out_length);
         _golf_ui_draw_fade(alpha);
 
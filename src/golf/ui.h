@@ -21,7 +21,20 @@ typedef struct golf_ui_draw_entity {
 } golf_ui_draw_entity_t;
 typedef vec_t(golf_ui_draw_entity_t) vec_golf_ui_draw_entity_t;
 
+// Config values read every frame, bound from game.cfg when it loads or reloads
+typedef struct golf_ui_params {
+    int cfg_version;
+    float aim_min_length, aim_max_length;
+    float aim_green_power, aim_yellow_power, aim_red_power;
+    vec4 aim_green_color, aim_yellow_color, aim_red_color, aim_dark_red_color;
+    float aim_rotate_min_angle, aim_rotate_max_angle, aim_rotate_speed;
+    float aim_circle_min_scale, ui_scroll_scale;
+    float game_fade_in_length, game_time_to_show_level_num, out_of_bounds_blink_time;
+} golf_ui_params_t;
+
 typedef struct golf_ui {
+    golf_ui_params_t params;
+
     union {
         struct {
             bool is_level_select_open;
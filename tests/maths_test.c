@@ -0,0 +1,142 @@
+#include <float.h>
+#include <stdint.h>
+
+#include "common/maths.h"
+
+// Checks the batched triangle tests in common/maths.c against the scalar
+// functions they have to match, on fixed inputs. Built with GOLF_ENABLE_AVX this
+// covers the 8 wide kernels, otherwise the 4 wide ones.
+
+#define MAX_TRIANGLES 37
+
+static uint32_t _rng_state = 12345;
+
+static float _rng_float(float min, float max) {
+    _rng_state = _rng_state * 1664525u + 1013904223u;
+    return min + (max - min) * ((_rng_state >> 8) / 16777216.0f);
+}
+
+static vec3 _rng_vec3(float min, float max) {
+    return V3(_rng_float(min, max), _rng_float(min, max), _rng_float(min, max));
+}
+
+static bool _same_float(float a, float b) {
+    return a == b || (isnan(a) && isnan(b));
+}
+
+typedef struct _triangles {
+    int num_triangles;
+    vec3 points[3 * MAX_TRIANGLES];
+    float comps[9][MAX_TRIANGLES];
+} _triangles_t;
+
+static triangle_soa_t _triangles_soa(_triangles_t *triangles) {
+    for (int i = 0; i < triangles->num_triangles; i++) {
+        for (int j = 0; j < 3; j++) {
+            vec3 p = triangles->points[3 * i + j];
+            triangles->comps[3 * j + 0][i] = p.x;
+            triangles->comps[3 * j + 1][i] = p.y;
+            triangles->comps[3 * j + 2][i] = p.z;
+        }
+    }
+
+    triangle_soa_t soa = {
+        triangles->comps[0], triangles->comps[1], triangles->comps[2],
+        triangles->comps[3], triangles->comps[4], triangles->comps[5],
+        triangles->comps[6], triangles->comps[7], triangles->comps[8],
+    };
+    return soa;
+}
+
+// Random triangles around the origin, with some degenerate ones and some that
+// share vertices so that the edge and vertex regions get hit
+static void _make_triangles(_triangles_t *triangles, int num_triangles) {
+    triangles->num_triangles = num_triangles;
+    for (int i = 0; i < num_triangles; i++) {
+        vec3 *p = &triangles->points[3 * i];
+        p[0] = _rng_vec3(-2, 2);
+        p[1] = _rng_vec3(-2, 2);
+        p[2] = _rng_vec3(-2, 2);
+        if (i % 7 == 3) {
+            p[2] = p[1];
+        }
+        if (i % 11 == 5) {
+            p[1] = vec3_add(p[0], vec3_scale(vec3_sub(p[2], p[0]), 0.5f));
+        }
+    }
+}
+
+static int _test_ray(_triangles_t *triangles, vec3 ro, vec3 rd) {
+    triangle_soa_t soa = _triangles_soa(triangles);
+
+    float ts[MAX_TRIANGLES];
+    ray_intersect_triangles_all(ro, rd, triangles->points, 3 * triangles->num_triangles, mat4_identity(), ts);
+    float expected_t = FLT_MAX;
+    int expected_idx = -1;
+    for (int i = 0; i < triangles->num_triangles; i++) {
+        if (ts[i] < expected_t) {
+            expected_t = ts[i];
+            expected_idx = i;
+        }
+    }
+
+    float t = 0;
+    int idx = -1;
+    bool hit = ray_intersect_triangles_soa(ro, rd, soa, triangles->num_triangles, &t, &idx);
+    if (hit != (expected_idx >= 0) || (hit && (!_same_float(t, expected_t) || idx != expected_idx))) {
+        printf("ray_intersect_triangles_soa: %d triangles, got %d %f %d, expected %d %f %d\n",
+                triangles->num_triangles, hit, t, idx, expected_idx >= 0, expected_t, expected_idx);
+        return 1;
+    }
+    return 0;
+}
+
+static int _test_closest_point(_triangles_t *triangles, vec3 p) {
+    triangle_soa_t soa = _triangles_soa(triangles);
+
+    vec3 cps[MAX_TRIANGLES];
+    triangle_contact_type_t types[MAX_TRIANGLES];
+    closest_point_point_triangles_soa(p, soa, triangles->num_triangles, cps, types);
+
+    int num_failed = 0;
+    for (int i = 0; i < triangles->num_triangles; i++) {
+        vec3 *points = &triangles->points[3 * i];
+        triangle_contact_type_t expected_type;
+        vec3 expected_cp = closest_point_point_triangle(p, points[0], points[1], points[2], &expected_type);
+        if (types[i] != expected_type || !_same_float(cps[i].x, expected_cp.x) ||
+                !_same_float(cps[i].y, expected_cp.y) || !_same_float(cps[i].z, expected_cp.z)) {
+            printf("closest_point_point_triangles_soa: triangle %d of %d, got %d (%f, %f, %f), expected %d (%f, %f, %f)\n",
+                    i, triangles->num_triangles, (int)types[i], cps[i].x, cps[i].y, cps[i].z,
+                    (int)expected_type, expected_cp.x, expected_cp.y, expected_cp.z);
+            num_failed++;
+        }
+    }
+    return num_failed;
+}
+
+int main(void) {
+    int num_failed = 0;
+    static _triangles_t triangles;
+
+    // Every count up to a few full batches, so the partially filled batches get tested too
+    for (int num_triangles = 1; num_triangles <= MAX_TRIANGLES; num_triangles++) {
+        for (int i = 0; i < 16; i++) {
+            _make_triangles(&triangles, num_triangles);
+
+            vec3 ro = _rng_vec3(-4, 4);
+            vec3 rd = vec3_sub(_rng_vec3(-1, 1), ro);
+            num_failed += _test_ray(&triangles, ro, rd);
+            // Straight at a vertex of the first triangle
+            num_failed += _test_ray(&triangles, ro, vec3_sub(triangles.points[0], ro));
+
+            num_failed += _test_closest_point(&triangles, _rng_vec3(-3, 3));
+            num_failed += _test_closest_point(&triangles, triangles.points[1]);
+        }
+    }
+
+    if (num_failed > 0) {
+        printf("%d batched triangle tests didn't match the scalar versions\n", num_failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "miniz/miniz.h"
+#include "common/pack.h"
+
+// Builds the data pack that mobile and web builds embed in place of the loose data directory.
+//
+//   golf_pack data_dir pack_path [header_path]
+//
+// Paths are stored as found, so running it on "data" gives entries like "data/levels/1.level".
+// When header_path is given the pack is also written out as a C array for data.c to include.
+
+typedef struct _file {
+    char *path;
+    char *data;
+    uint32_t size;
+    char *stored_data;
+    uint32_t stored_size;
+    uint32_t flags;
+    uint32_t path_offset, data_offset;
+} _file_t;
+
+typedef struct _files {
+    _file_t *data;
+    int length, capacity;
+} _files_t;
+
+static void _add_file(_files_t *files, const char *path) {
+    if (files->length == files->capacity) {
+        files->capacity = files->capacity ? 2 * files->capacity : 256;
+        files->data = realloc(files->data, sizeof(_file_t) * files->capacity);
+    }
+    _file_t *file = &files->data[files->length++];
+    memset(file, 0, sizeof(_file_t));
+    file->path = malloc(strlen(path) + 1);
+    strcpy(file->path, path);
+}
+
+static void _recurse_dir(_files_t *files, const char *dir) {
+    char path[1024];
+#if defined(_WIN32)
+    WIN32_FIND_DATAA find_data;
+    snprintf(path, sizeof(path), "%s/*", dir);
+    HANDLE find = FindFirstFileA(path, &find_data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        const char *name = find_data.cFileName;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            _recurse_dir(files, path);
+        }
+        else {
+            _add_file(files, path);
+        }
+    } while (FindNextFileA(find, &find_data));
+    FindClose(find);
+#else
+    DIR *d = opendir(dir);
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d))) {
+        const char *name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            _recurse_dir(files, path);
+        }
+        else if (S_ISREG(st.st_mode)) {
+            _add_file(files, path);
+        }
+    }
+    closedir(d);
+#endif
+}
+
+static int _compare_files(const void *a, const void *b) {
+    return strcmp(((const _file_t*)a)->path, ((const _file_t*)b)->path);
+}
+
+static bool _load_file(_file_t *file) {
+    FILE *f = fopen(file->path, "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < 0 || size > INT32_MAX - 1) {
+        fclose(f);
+        return false;
+    }
+    file->size = (uint32_t)size;
+    file->data = malloc(file->size + 1);
+    bool ok = fread(file->data, 1, file->size, f) == file->size;
+    fclose(f);
+    return ok;
+}
+
+// Only keep the compressed version if it's worth inflating at load time
+static void _compress_file(_file_t *file) {
+    file->stored_data = file->data;
+    file->stored_size = file->size;
+    file->flags = 0;
+    if (file->size == 0) {
+        return;
+    }
+
+    size_t compressed_size = 0;
+    void *compressed = tdefl_compress_mem_to_heap(file->data, file->size, &compressed_size, TDEFL_DEFAULT_MAX_PROBES);
+    if (compressed && compressed_size <= file->size - file->size / 8) {
+        file->stored_data = compressed;
+        file->stored_size = (uint32_t)compressed_size;
+        file->flags = GOLF_PACK_ENTRY_COMPRESSED;
+    }
+    else {
+        mz_free(compressed);
+    }
+}
+
+// Same as golf_pack_hash_path
+static uint32_t _hash_path(const char *path) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char*)path; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t _align(uint32_t offset) {
+    return (offset + GOLF_PACK_ALIGNMENT - 1) & ~(uint32_t)(GOLF_PACK_ALIGNMENT - 1);
+}
+
+static bool _write_header_file(const char *header_path, const unsigned char *pack, uint32_t pack_len) {
+    FILE *f = fopen(header_path, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "// Generated by tools/golf_pack, don't edit\n");
+    fprintf(f, "#if defined(_MSC_VER)\n");
+    fprintf(f, "__declspec(align(%d))\n", GOLF_PACK_ALIGNMENT);
+    fprintf(f, "#else\n");
+    fprintf(f, "__attribute__((aligned(%d)))\n", GOLF_PACK_ALIGNMENT);
+    fprintf(f, "#endif\n");
+    fprintf(f, "static const unsigned char golf_data_pack[%u] = {", pack_len);
+    for (uint32_t i = 0; i < pack_len; i++) {
+        if (i % 32 == 0) {
+            fprintf(f, "\n");
+        }
+        fprintf(f, "%u,", pack[i]);
+    }
+    fprintf(f, "\n};\n");
+    return fclose(f) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        printf("usage: golf_pack data_dir pack_path [header_path]\n");
+        return 1;
+    }
+    const char *data_dir = argv[1];
+    const char *pack_path = argv[2];
+    const char *header_path = argc == 4 ? argv[3] : NULL;
+
+    _files_t files;
+    memset(&files, 0, sizeof(files));
+    _recurse_dir(&files, data_dir);
+    if (files.length == 0) {
+        printf("No files found in %s\n", data_dir);
+        return 1;
+    }
+    qsort(files.data, files.length, sizeof(_file_t), _compare_files);
+
+    uint32_t num_entries = (uint32_t)files.length;
+    uint32_t num_slots = 1;
+    while (num_slots < 2 * num_entries) {
+        num_slots *= 2;
+    }
+
+    golf_pack_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GOLF_PACK_MAGIC, 4);
+    header.version = GOLF_PACK_VERSION;
+    header.num_entries = num_entries;
+    header.num_slots = num_slots;
+    header.entries_offset = sizeof(golf_pack_header_t);
+    header.slots_offset = header.entries_offset + num_entries * sizeof(golf_pack_entry_t);
+    header.paths_offset = header.slots_offset + num_slots * sizeof(uint32_t);
+
+    uint32_t offset = header.paths_offset;
+    for (int i = 0; i < files.length; i++) {
+        _file_t *file = &files.data[i];
+        file->path_offset = offset;
+        offset += (uint32_t)strlen(file->path) + 1;
+    }
+
+    int num_compressed = 0;
+    uint64_t total_size = 0;
+    for (int i = 0; i < files.length; i++) {
+        _file_t *file = &files.data[i];
+        if (!_load_file(file)) {
+            printf("Unable to read %s\n", file->path);
+            return 1;
+        }
+        _compress_file(file);
+
+        offset = _align(offset);
+        file->data_offset = offset;
+        offset += file->stored_size;
+        if (!(file->flags & GOLF_PACK_ENTRY_COMPRESSED)) {
+            offset++;
+        }
+        if (offset > INT32_MAX) {
+            printf("Pack is too large\n");
+            return 1;
+        }
+
+        if (file->flags & GOLF_PACK_ENTRY_COMPRESSED) {
+            num_compressed++;
+        }
+        total_size += file->size;
+    }
+    header.data_len = offset;
+
+    unsigned char *pack = calloc(header.data_len, 1);
+    memcpy(pack, &header, sizeof(header));
+
+    golf_pack_entry_t *entries = (golf_pack_entry_t*)(pack + header.entries_offset);
+    uint32_t *slots = (uint32_t*)(pack + header.slots_offset);
+    for (uint32_t i = 0; i < num_slots; i++) {
+        slots[i] = GOLF_PACK_EMPTY_SLOT;
+    }
+    for (int i = 0; i < files.length; i++) {
+        _file_t *file = &files.data[i];
+        golf_pack_entry_t *entry = &entries[i];
+        entry->path_hash = _hash_path(file->path);
+        entry->path_offset = file->path_offset;
+        entry->data_offset = file->data_offset;
+        entry->stored_size = file->stored_size;
+        entry->size = file->size;
+        entry->flags = file->flags;
+
+        uint32_t slot = entry->path_hash & (num_slots - 1);
+        while (slots[slot] != GOLF_PACK_EMPTY_SLOT) {
+            slot = (slot + 1) & (num_slots - 1);
+        }
+        slots[slot] = (uint32_t)i;
+
+        strcpy((char*)pack + file->path_offset, file->path);
+        memcpy(pack + file->data_offset, file->stored_data, file->stored_size);
+    }
+
+    FILE *f = fopen(pack_path, "wb");
+    if (!f || fwrite(pack, 1, header.data_len, f) != header.data_len || fclose(f) != 0) {
+        printf("Unable to write %s\n", pack_path);
+        return 1;
+    }
+    if (header_path && !_write_header_file(header_path, pack, header.data_len)) {
+        printf("Unable to write %s\n", header_path);
+        return 1;
+    }
+
+    printf("Packed %d files (%d compressed), %llu bytes into %u\n", files.length, num_compressed,
+            (unsigned long long)total_size, header.data_len);
+    return 0;
+}